@@ -5,44 +5,35 @@
 #include "doctest.h"
 
 #ifdef _DEBUG
-#define _CRTDBG_MAP_ALLOC
-#include <crtdbg.h>
-#include <stdlib.h>
 #include <iostream>
+#include <thread>
 #endif
 
 // Forward declare the interactive runner
 int runInteractive();
+int runCommandLine(int argc, char** argv);
+// portable leak check around the test run (see ALLOCATION TRACKING)
+void beginLeakCheck();
+bool endLeakCheck();
 
 int main(int argc, char** argv) {
 #ifdef _DEBUG
-    _CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF);
-    _CrtMemState before{}, after{}, diff{};
-    _CrtMemCheckpoint(&before);
+    beginLeakCheck();
 
+    // the tests get their own thread: once it is joined, everything
+    // thread-local they touched (doctest's message stream too) is gone
     int result = 0;
-    {
+    std::thread tests([&] {
         doctest::Context context(argc, argv);
         result = context.run();
-    }
-
-    _CrtMemCheckpoint(&after);
-    _CrtMemCheckpoint(&before);
-    if (_CrtMemDifference(&diff, &before, &after)) {
-        std::cerr << "\nREAL leak(s) detected in YOUR code during test run:\n";
-        _CrtMemDumpStatistics(&diff);
-        // Optional detail:
-        // _CrtMemDumpAllObjectsSince(&before);
-    }
-    else {
-        std::cerr << "No memory leaks detected in YOUR code during test run.\n";
-    }
+    });
+    tests.join();
 
+    if (endLeakCheck() && result == 0) result = 1;
     return result;
 #else
-    // Release build: run the menu program
-    (void)argc; (void)argv;
-    return runInteractive();
+    // Release build: run the menu program (or a mode picked on the command line)
+    return runCommandLine(argc, argv);
 #endif
 }
 // ==========================
@@ -52,1599 +43,9834 @@ int main(int argc, char** argv) {
 #include <string>
 #include <iomanip>
 #include <fstream>
+#ifdef _WIN32
+#define NOMINMAX
 #include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 #include <stdexcept>
 #include <sstream>
 #include <vector>
+#include <unordered_map>
+#include <string_view>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <chrono>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <charconv>
+#include <new>
+#include <deque>
+#include <optional>
+#include <condition_variable>
 #include <cassert> //assert added by Chris Noonan for the week 11 assignment
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <csignal>
+#endif
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define TRACKER_HAS_COROUTINES 1
+#endif
+#endif
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#define TRACKER_HAS_IO_URING 1
+#endif
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRACKER_HAS_SSE2 1
+#include <emmintrin.h>
+#endif
 using namespace std;
 // ==========================
-// CONSTANTS 
+// ALLOCATION TRACKING
+// the global operator new is replaced. Every build counts allocations
+// per thread (the benchmarks report them per operation). With
+// TRACKER_TRACK_ALLOCATIONS, on by default in _DEBUG, each block also
+// carries a size header, so frees, live bytes and peaks are known: per
+// thread for AllocationScope, process-wide for the per-test report
+// and the leak check in main
 // ==========================
-const int ADVANCED_HOURS = 160;
-const int INTERMEDIATE_HOURS = 21;
-const int FREQUENT_CLIMBER_DAYS = 80;
-const int NEW_CLIMBER_DAYS = 10;
-const double DEDICATED_SESSION_HOURS = 2.0;
+#if defined(_DEBUG) && !defined(TRACKER_TRACK_ALLOCATIONS)
+#define TRACKER_TRACK_ALLOCATIONS 1
+#endif
 
-// ==========================
-// ENUM 
-// ==========================
-enum ClimbDifficulty { EASY = 1, MODERATE, HARD, EXTREME };
+struct AllocationCount {
+    unsigned long long allocations;
+    unsigned long long bytes;
+    unsigned long long deallocations;
+    unsigned long long freedBytes;   // stays 0 without TRACKER_TRACK_ALLOCATIONS
+};
 
-// ==========================
-// ENUM HELPER
-// ==========================
-string difficultyToString(ClimbDifficulty d) {
-    switch (d) {
-    case EASY: return "Easy";
-    case MODERATE: return "Moderate";
-    case HARD: return "Hard";
-    case EXTREME: return "Extreme";
-    default: return "Unknown";
-    }
-}
+thread_local AllocationCount threadAllocations = { 0, 0, 0, 0 };
 
-// ==========================
-// COLOR FUNCTION
-// ==========================
-void setColor(int color) {
-    SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), color);
+inline AllocationCount allocationsSoFar() {
+    return threadAllocations;
 }
 
-// ==========================
-// CUSTOM EXCEPTION (NEW)
-// ==========================
-class IndexOutOfRange : public std::runtime_error {
-public:
-    explicit IndexOutOfRange(const std::string& msg)
-        : std::runtime_error(msg) {}
+#ifdef TRACKER_TRACK_ALLOCATIONS
+const size_t ALLOCATION_HEADER = alignof(max_align_t);   // keeps the block aligned
+
+struct AllocationTotals {
+    unsigned long long allocations;
+    unsigned long long bytes;
+    long long liveBlocks;
+    long long liveBytes;
+    long long peakBytes;   // highest liveBytes since the last resetAllocationPeak
 };
 
-//New code for week 11 assignment, added by Chris Noonan
+atomic<unsigned long long> totalAllocations{ 0 };
+atomic<unsigned long long> totalBytes{ 0 };
+atomic<long long> liveBlocks{ 0 };
+atomic<long long> liveBytes{ 0 };
+atomic<long long> peakLiveBytes{ 0 };
+thread_local long long threadPeakBytes = 0;   // highest bytes - freedBytes on this thread
 
-template <class Type>
-class arrayStack {
-private:
-    int maxStackSize;
-    int stackTop;
-    Type* list;
+inline long long threadNetBytes() {
+    return static_cast<long long>(threadAllocations.bytes - threadAllocations.freedBytes);
+}
 
-public:
+inline AllocationTotals allocationTotals() {
+    return AllocationTotals{ totalAllocations.load(memory_order_relaxed), totalBytes.load(memory_order_relaxed),
+        liveBlocks.load(memory_order_relaxed), liveBytes.load(memory_order_relaxed),
+        peakLiveBytes.load(memory_order_relaxed) };
+}
 
-    arrayStack(int stackSize = 100)  //default size 100
-    {
-        if (stackSize <= 0) {
-            cout << "Size of stack must be positive; defaulting to size 100..." << endl;
+inline void resetAllocationPeak() {
+    peakLiveBytes.store(liveBytes.load(memory_order_relaxed), memory_order_relaxed);
+}
+#endif
 
-            maxStackSize = 100;
-        }
-        else
-            maxStackSize = stackSize;
-        
-        stackTop = 0;
-        list = new Type[maxStackSize];
+// kept out of line: once inlined GCC pairs the free() below with the
+// builtin operator new and warns about a mismatch
+#if defined(_MSC_VER)
+#define TRACKER_NOINLINE __declspec(noinline)
+#else
+#define TRACKER_NOINLINE __attribute__((noinline))
+#endif
+
+TRACKER_NOINLINE void* operator new(size_t size) {
+    threadAllocations.allocations++;
+    threadAllocations.bytes += size;
+#ifdef TRACKER_TRACK_ALLOCATIONS
+    char* base = static_cast<char*>(malloc(size + ALLOCATION_HEADER));
+    if (base == nullptr) throw bad_alloc();
+    *reinterpret_cast<size_t*>(base) = size;
+
+    if (threadNetBytes() > threadPeakBytes) threadPeakBytes = threadNetBytes();
+    totalAllocations.fetch_add(1, memory_order_relaxed);
+    totalBytes.fetch_add(size, memory_order_relaxed);
+    liveBlocks.fetch_add(1, memory_order_relaxed);
+    long long live = liveBytes.fetch_add(static_cast<long long>(size), memory_order_relaxed) + static_cast<long long>(size);
+    long long peak = peakLiveBytes.load(memory_order_relaxed);
+    while (live > peak && !peakLiveBytes.compare_exchange_weak(peak, live, memory_order_relaxed)) {
     }
-    void initializeStack() 
-    {
-        stackTop = 0;
+    return base + ALLOCATION_HEADER;
+#else
+    void* p = malloc(size > 0 ? size : 1);
+    if (p == nullptr) throw bad_alloc();
+    return p;
+#endif
+}
+
+TRACKER_NOINLINE void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+TRACKER_NOINLINE void operator delete(void* p) noexcept {
+    if (p == nullptr) return;
+    threadAllocations.deallocations++;
+#ifdef TRACKER_TRACK_ALLOCATIONS
+    char* base = static_cast<char*>(p) - ALLOCATION_HEADER;
+    size_t size = *reinterpret_cast<size_t*>(base);
+    threadAllocations.freedBytes += size;
+    liveBlocks.fetch_sub(1, memory_order_relaxed);
+    liveBytes.fetch_sub(static_cast<long long>(size), memory_order_relaxed);
+    free(base);
+#else
+    free(p);
+#endif
+}
+
+TRACKER_NOINLINE void operator delete[](void* p) noexcept { operator delete(p); }
+TRACKER_NOINLINE void operator delete(void* p, size_t) noexcept { operator delete(p); }
+TRACKER_NOINLINE void operator delete[](void* p, size_t) noexcept { operator delete(p); }
+
+// what the calling thread allocated while the scope is alive, e.g.
+//     AllocationScope scope;
+//     tracker.addSession(...);
+//     CHECK(scope.allocations() <= 4);
+class AllocationScope {
+private:
+    AllocationCount start;
+#ifdef TRACKER_TRACK_ALLOCATIONS
+    long long startNet;
+    long long outerPeak;
+#endif
+
+public:
+    AllocationScope() : start(allocationsSoFar()) {
+#ifdef TRACKER_TRACK_ALLOCATIONS
+        startNet = threadNetBytes();
+        outerPeak = threadPeakBytes;
+        threadPeakBytes = startNet;
+#endif
     }
 
-    bool isEmptyStack() 
-    {
-        return (stackTop == 0);
+#ifdef TRACKER_TRACK_ALLOCATIONS
+    ~AllocationScope() {
+        if (outerPeak > threadPeakBytes) threadPeakBytes = outerPeak;
     }
+#endif
 
-    bool isFullStack() 
-    {
-        return (stackTop == maxStackSize);
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+
+    unsigned long long allocations() const { return threadAllocations.allocations - start.allocations; }
+    unsigned long long bytes() const { return threadAllocations.bytes - start.bytes; }
+    unsigned long long deallocations() const { return threadAllocations.deallocations - start.deallocations; }
+
+#ifdef TRACKER_TRACK_ALLOCATIONS
+    // bytes allocated here and not yet freed
+    long long netBytes() const { return threadNetBytes() - startNet; }
+    // most bytes held at once since the scope began
+    long long peakBytes() const { return threadPeakBytes - startNet; }
+#endif
+};
+
+#ifdef TRACKER_TRACK_ALLOCATIONS
+static long long leakCheckBlocks = 0;
+static long long leakCheckBytes = 0;
+
+void beginLeakCheck() {
+    leakCheckBlocks = liveBlocks.load();
+    leakCheckBytes = liveBytes.load();
+}
+
+bool endLeakCheck() {
+    long long blocks = liveBlocks.load() - leakCheckBlocks;
+    long long bytes = liveBytes.load() - leakCheckBytes;
+    if (blocks > 0) {
+        cerr << "\nREAL leak(s) detected in YOUR code during test run: "
+            << blocks << " block(s), " << bytes << " bytes still allocated.\n";
+        return true;
     }
+    cerr << "No memory leaks detected in YOUR code during test run.\n";
+    return false;
+}
+#endif
+// ==========================
+// TRACING
+// scoped spans exported as Chrome trace events ("X" complete events,
+// open in ui.perfetto.dev or chrome://tracing). Each thread writes its
+// own ring of TRACE_RING_SPANS spans with relaxed stores and no locks,
+// overwriting its oldest. Rings outlive their threads and pass to new
+// ones, so spans from finished workers still export. Recording is off until
+// enableTracing(), or TRACKER_TRACE=<file>, which also writes the trace
+// at exit. TRACKER_NO_TRACE compiles TRACE_SPAN out.
+// ==========================
+const int TRACE_RING_SPANS = 1 << 14;
 
-    void push(const Type& newItem) 
-    {
-        if (!isFullStack()) {
-            list[stackTop] = newItem;
+#define TRACKER_CONCAT_INNER(a, b) a##b
+#define TRACKER_CONCAT(a, b) TRACKER_CONCAT_INNER(a, b)
 
-            stackTop++;
+struct TraceSpan {
+    const char* name;      // a string literal; never freed
+    uint32_t thread;
+    uint64_t startNs;      // since traceOrigin()
+    uint64_t durationNs;
+};
+
+inline chrono::steady_clock::time_point traceOrigin() {
+    static const chrono::steady_clock::time_point origin = chrono::steady_clock::now();
+    return origin;
+}
+
+inline uint64_t traceNs(chrono::steady_clock::time_point t) {
+    return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(t - traceOrigin()).count());
+}
+
+#ifndef TRACKER_NO_TRACE
+inline atomic<bool>& tracingFlag() {
+    static atomic<bool> on{ false };
+    return on;
+}
+
+inline bool tracingEnabled() { return tracingFlag().load(memory_order_relaxed); }
+
+class TraceRegistry {
+public:
+    struct Ring {
+        struct Slot {
+            atomic<const char*> name;
+            atomic<uint32_t> thread;
+            atomic<uint64_t> startNs;
+            atomic<uint64_t> durationNs;
+        };
+
+        Slot slots[TRACE_RING_SPANS];
+        atomic<uint64_t> head;     // spans ever written, only by the owner
+        uint64_t floor;            // spans before this are not exported; registry lock
+        uint32_t thread;           // id of the current owner
+        bool inUse;                // guarded by the registry lock
+        Ring* next;
+
+        void record(const char* name, uint64_t startNs, uint64_t durationNs) {
+            uint64_t h = head.load(memory_order_relaxed);
+            Slot& s = slots[h & (TRACE_RING_SPANS - 1)];
+            s.name.store(name, memory_order_relaxed);
+            s.thread.store(thread, memory_order_relaxed);
+            s.startNs.store(startNs, memory_order_relaxed);
+            s.durationNs.store(durationNs, memory_order_relaxed);
+            head.store(h + 1, memory_order_release);
         }
-        else
-            cout << "Cannot push to full stack" << endl;
+
+        // spans the writer cannot have overwritten while they were copied
+        void copyTo(vector<TraceSpan>& out) const {
+            uint64_t end = head.load(memory_order_acquire);
+            uint64_t begin = max(floor, end > TRACE_RING_SPANS ? end - TRACE_RING_SPANS : 0);
+            size_t first = out.size();
+            for (uint64_t i = begin; i < end; i++) {
+                const Slot& s = slots[i & (TRACE_RING_SPANS - 1)];
+                out.push_back(TraceSpan{ s.name.load(memory_order_relaxed), s.thread.load(memory_order_relaxed),
+                    s.startNs.load(memory_order_relaxed), s.durationNs.load(memory_order_relaxed) });
+            }
+            atomic_thread_fence(memory_order_acquire);
+            uint64_t now = head.load(memory_order_relaxed);
+            uint64_t safe = now >= TRACE_RING_SPANS ? now - TRACE_RING_SPANS + 1 : 0;
+            if (safe > begin)
+                out.erase(out.begin() + first, out.begin() + first + static_cast<size_t>(min(safe, end) - begin));
+        }
+    };
+
+private:
+    mutex lock;
+    Ring* rings = nullptr;
+    uint32_t nextThread = 1;
+
+public:
+    static TraceRegistry& instance() {
+        static TraceRegistry registry;
+        return registry;
     }
 
-    Type top() const 
-    {
-        assert(stackTop != 0);
+    // rings come from calloc like the stats blocks and are never freed;
+    // a finished thread's ring is handed to the next thread that traces,
+    // which appends after the spans already there
+    Ring* attach() {
+        lock_guard<mutex> guard(lock);
+        Ring* ring = rings;
+        while (ring != nullptr && ring->inUse) ring = ring->next;
+        if (ring == nullptr) {
+            ring = new (calloc(1, sizeof(Ring))) Ring;
+            ring->next = rings;
+            rings = ring;
+        }
+        ring->inUse = true;
+        ring->thread = nextThread++;
+        return ring;
+    }
 
-        return list[stackTop - 1];
+    void detach(Ring* ring) {
+        lock_guard<mutex> guard(lock);
+        ring->inUse = false;
     }
 
-    void pop()
-    {
-        if (!isEmptyStack())
-            stackTop--;
-        else
-            cout << "Cannot pop from empty stack" << endl;
+    vector<TraceSpan> collect() {
+        vector<TraceSpan> spans;
+        lock_guard<mutex> guard(lock);
+        for (const Ring* ring = rings; ring != nullptr; ring = ring->next) ring->copyTo(spans);
+        return spans;
     }
 
-    ~arrayStack() 
-    {
-        delete[] list;
+    // forgets what has been recorded so far
+    void clear() {
+        lock_guard<mutex> guard(lock);
+        for (Ring* ring = rings; ring != nullptr; ring = ring->next)
+            ring->floor = ring->head.load(memory_order_acquire);
     }
 };
 
-template <class Type>
-class arrayQueue {
+class ThreadTraceRing {
 private:
-    int maxQueueSize;
-    int count;
-    int queueFront;
-    int queueRear;
-    Type* list;
+    TraceRegistry& registry;
+    TraceRegistry::Ring* ring;
 
 public:
+    ThreadTraceRing() : registry(TraceRegistry::instance()), ring(registry.attach()) {}
+    ~ThreadTraceRing() { registry.detach(ring); }
 
-    arrayQueue(int queueSize = 100) //default size 100
-    {
-        if (queueSize <= 0) {
-            cout << "Size of queue must be positive; defaulting to size 100..." << endl;
+    void record(const char* name, uint64_t startNs, uint64_t durationNs) { ring->record(name, startNs, durationNs); }
+};
 
-            maxQueueSize = 100;
-        }
-        else
-            maxQueueSize = queueSize;
-        queueFront = 0;
-        queueRear = maxQueueSize - 1;
-        count = 0;
-        list = new Type[maxQueueSize];
-    }
+inline void recordSpan(const char* name, uint64_t startNs, uint64_t durationNs) {
+    thread_local ThreadTraceRing ring;
+    ring.record(name, startNs, durationNs);
+}
 
-    void initializeQueue()
-    {
-        queueFront = 0;
-        queueRear = maxQueueSize - 1;
-        count = 0;
-    }
+class TraceScope {
+private:
+    const char* name;
+    chrono::steady_clock::time_point start;
 
-    bool isEmptyQueue() const
-    {
-        return(count == 0);
+public:
+    explicit TraceScope(const char* n) : name(tracingEnabled() ? n : nullptr) {
+        if (name != nullptr) start = chrono::steady_clock::now();
     }
-
-    bool isFullQueue() const
-    {
-        return(count == maxQueueSize);
+    ~TraceScope() {
+        if (name == nullptr) return;
+        chrono::steady_clock::time_point end = chrono::steady_clock::now();
+        recordSpan(name, traceNs(start), traceNs(end) - traceNs(start));
     }
+};
 
-    Type front() const
-    {
-        assert(!isEmptyQueue());
-        return list[queueFront];
-    }
+// one span for the rest of the enclosing scope; name must be a literal
+#define TRACE_SPAN(name) TraceScope TRACKER_CONCAT(traceScope, __LINE__)(name)
 
-    Type back() const 
-    {
-        assert(!isEmptyQueue());
-        return list[queueRear];
-    }
+inline void enableTracing(bool on) {
+    traceOrigin();
+    tracingFlag().store(on, memory_order_relaxed);
+}
 
-    void addQueue(const Type& queueElement)
-    {
-        if (!isFullQueue()) {
-            queueRear = (queueRear + 1) % maxQueueSize;
+inline vector<TraceSpan> collectTrace() { return TraceRegistry::instance().collect(); }
+inline void clearTrace() { TraceRegistry::instance().clear(); }
+#else
+#define TRACE_SPAN(name) ((void)0)
 
-            count++;
-            list[queueRear] = queueElement;
-        }
-        else
-            cout << "Cannot add to a full queue." << endl;
-    }
+inline bool tracingEnabled() { return false; }
+inline void enableTracing(bool) {}
+inline vector<TraceSpan> collectTrace() { return vector<TraceSpan>(); }
+inline void clearTrace() {}
+#endif
 
-    void deleteQueue()
-    {
-        if (!isEmptyQueue()) {
-            count--;
-            queueFront = (queueFront + 1) % maxQueueSize;
-        }
-        else
-            cout << "Cannot remove from an empty queue." << endl;
+// {"traceEvents":[...]} with timestamps in microseconds
+inline string chromeTraceJson(vector<TraceSpan> spans) {
+    sort(spans.begin(), spans.end(), [](const TraceSpan& a, const TraceSpan& b) { return a.startNs < b.startNs; });
+    string json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    char event[256];
+    for (size_t i = 0; i < spans.size(); i++) {
+        const TraceSpan& s = spans[i];
+        snprintf(event, sizeof(event),
+            "%s\n{\"name\":\"%s\",\"cat\":\"tracker\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+            i > 0 ? "," : "", s.name, s.thread, s.startNs / 1000.0, s.durationNs / 1000.0);
+        json += event;
     }
+    json += "\n]}\n";
+    return json;
+}
 
-    ~arrayQueue()
-    {
-        delete[] list;
+// returns the number of spans written, or -1 when the file cannot be written
+inline long long writeChromeTrace(const string& path) {
+    vector<TraceSpan> spans = collectTrace();
+    ofstream out(path, ios::binary);
+    out << chromeTraceJson(spans);
+    return out ? static_cast<long long>(spans.size()) : -1;
+}
+
+#ifndef TRACKER_NO_TRACE
+// TRACKER_TRACE=<file>: trace the whole run and write it at exit
+class TraceAtExit {
+private:
+    string path;
+
+public:
+    TraceAtExit() {
+        TraceRegistry::instance();   // constructed first, destroyed after the export
+        const char* env = getenv("TRACKER_TRACE");
+        if (env == nullptr || *env == '\0') return;
+        path = env;
+        enableTracing(true);
+    }
+    ~TraceAtExit() {
+        if (path.empty()) return;
+        long long spans = writeChromeTrace(path);
+        if (spans < 0) fprintf(stderr, "Cannot write trace to %s\n", path.c_str());
     }
 };
 
+static TraceAtExit traceAtExit;
+#endif
 
 // ==========================
-// BASE CLASS 
+// OPERATION STATISTICS
+// counters and latency histograms for the hot paths. Each thread
+// records into its own block (one writer, relaxed stores, no locks);
+// a snapshot sums the live blocks plus what exited threads left behind.
+// Buckets are log-linear like HdrHistogram, 8 per power of two, so a
+// percentile is within 12.5%. TRACKER_NO_STATS compiles TRACK_OP out.
 // ==========================
-class Activity {
-protected:
-    string name;
-    int duration;
-    ClimbDifficulty difficulty;
+enum class TrackedOp : uint8_t { ADD, REMOVE, SEARCH, REPORT, SAVE, LOAD };
+
+const int TRACKED_OP_COUNT = 6;
+const char* const TRACKED_OP_NAMES[TRACKED_OP_COUNT] = { "add", "remove", "search", "report", "save", "load" };
+
+const int LATENCY_SUB_BITS = 3;
+const int LATENCY_SUB_BUCKETS = 1 << LATENCY_SUB_BITS;
+const int LATENCY_BUCKETS = 42 * LATENCY_SUB_BUCKETS;   // up to 2^44 ns, about 5 hours
+
+class LatencyHistogram {
+private:
+    uint64_t counts[LATENCY_BUCKETS];
+    uint64_t total;
+    uint64_t sumNs;
+    uint64_t maxNs;
+
+    // x must be non-zero
+    static int highestBit(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - __builtin_clzll(x);
+#else
+        int n = 0;
+        while (x >>= 1) n++;
+        return n;
+#endif
+    }
 
 public:
-    Activity()
-        : name(""), duration(0), difficulty(EASY) {
+    LatencyHistogram() { clear(); }
+
+    void clear() {
+        memset(counts, 0, sizeof(counts));
+        total = sumNs = maxNs = 0;
     }
 
-    Activity(string n, int d, ClimbDifficulty diff)
-        : name(n), duration(d), difficulty(diff) {
+    // values below 8 get a bucket each; above that the top 3 bits after
+    // the leading one pick one of 8 buckets in the value's power of two
+    static int bucketOf(uint64_t ns) {
+        if (ns < LATENCY_SUB_BUCKETS) return static_cast<int>(ns);
+        int top = highestBit(ns);
+        int index = (top - LATENCY_SUB_BITS + 1) * LATENCY_SUB_BUCKETS
+            + static_cast<int>((ns >> (top - LATENCY_SUB_BITS)) & (LATENCY_SUB_BUCKETS - 1));
+        return index < LATENCY_BUCKETS ? index : LATENCY_BUCKETS - 1;
     }
 
-    // NEW REQUIRED virtual destructor
-    virtual ~Activity() {}
+    // largest value that lands in bucket
+    static uint64_t bucketHigh(int bucket) {
+        if (bucket < LATENCY_SUB_BUCKETS) return static_cast<uint64_t>(bucket);
+        int shift = bucket / LATENCY_SUB_BUCKETS - 1;
+        uint64_t low = static_cast<uint64_t>(LATENCY_SUB_BUCKETS + bucket % LATENCY_SUB_BUCKETS) << shift;
+        return low + (1ULL << shift) - 1;
+    }
 
-    // ===== SETTERS =====
-    void setName(const string& n) { name = n; }
-    void setDuration(int d) { duration = d; }
-    void setDifficulty(ClimbDifficulty diff) { difficulty = diff; }
-
-    // ===== GETTERS =====
-    string getName() const { return name; }
-    int getDuration() const { return duration; }
-    ClimbDifficulty getDifficulty() const { return difficulty; }
-
-    // NEW PURE VIRTUAL FUNCTION
-    virtual string getType() const = 0;
+    void record(uint64_t ns) { add(bucketOf(ns), 1, ns, ns); }
 
-    // keep print virtual
-    virtual void print() const {
-        cout << "Name: " << name << endl;
-        cout << "Duration: " << duration << " minutes" << endl;
-        cout << "Difficulty: " << difficultyToString(difficulty) << endl;
+    void add(int bucket, uint64_t count, uint64_t ns, uint64_t maxSeen) {
+        counts[bucket] += count;
+        total += count;
+        sumNs += ns;
+        if (maxSeen > maxNs) maxNs = maxSeen;
     }
-    // ===== STREAM SUPPORT (for operator<< polymorphism) ===== NEW
-    virtual void toStream(ostream& os) const {
-        os << name << " | "
-            << duration << " mins | "
-            << difficultyToString(difficulty);
+
+    uint64_t getCount() const { return total; }
+    uint64_t getTotalNs() const { return sumNs; }
+    uint64_t getMaxNs() const { return maxNs; }
+    uint64_t bucketCount(int bucket) const { return counts[bucket]; }
+    double meanNs() const { return total > 0 ? static_cast<double>(sumNs) / total : 0.0; }
+
+    // fraction in [0, 1]; 0 when empty
+    uint64_t percentileNs(double fraction) const {
+        if (total == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(ceil(fraction * static_cast<double>(total)));
+        if (rank == 0) rank = 1;
+        uint64_t seen = 0;
+        for (int b = 0; b < LATENCY_BUCKETS; b++) {
+            seen += counts[b];
+            if (seen >= rank) return min(bucketHigh(b), maxNs);
+        }
+        return maxNs;
     }
-    virtual Activity* clone() const = 0;
 };
 
+struct OpStatsSnapshot {
+    bool enabled;
+    LatencyHistogram ops[TRACKED_OP_COUNT];
 
+    const LatencyHistogram& operator[](TrackedOp op) const { return ops[static_cast<int>(op)]; }
+};
 
-// ==========================
-// COMPOSITION CLASS 
-// ==========================
-class Location {
-private:
-    string place;
-    bool indoor;
-
+#ifndef TRACKER_NO_STATS
+class OpStatsRegistry {
 public:
-    Location() : place(""), indoor(true) {}
-    Location(string p, bool i) : place(p), indoor(i) {}
-
-    string getPlace() const { return place; }
-    bool isIndoor() const { return indoor; }
-
-    void setPlace(string p) { place = p; }
-    void setIndoor(bool i) { indoor = i; }
+    // written only by its own thread
+    struct Block {
+        atomic<uint64_t> buckets[TRACKED_OP_COUNT][LATENCY_BUCKETS];
+        atomic<uint64_t> sumNs[TRACKED_OP_COUNT];
+        atomic<uint64_t> maxNs[TRACKED_OP_COUNT];
+        Block* prev;   // live list, guarded by the registry lock
+        Block* next;
+
+        void record(int op, uint64_t ns) {
+            atomic<uint64_t>& slot = buckets[op][LatencyHistogram::bucketOf(ns)];
+            slot.store(slot.load(memory_order_relaxed) + 1, memory_order_relaxed);
+            sumNs[op].store(sumNs[op].load(memory_order_relaxed) + ns, memory_order_relaxed);
+            if (ns > maxNs[op].load(memory_order_relaxed)) maxNs[op].store(ns, memory_order_relaxed);
+        }
 
-    // Helper method 
-    string formattedLocation() const {
-        return place + (indoor ? " (Indoor)" : " (Outdoor)");
-    }
-};
+        void addTo(LatencyHistogram* out) const {
+            for (int op = 0; op < TRACKED_OP_COUNT; op++) {
+                uint64_t sum = sumNs[op].load(memory_order_relaxed);
+                uint64_t most = maxNs[op].load(memory_order_relaxed);
+                for (int b = 0; b < LATENCY_BUCKETS; b++) {
+                    uint64_t n = buckets[op][b].load(memory_order_relaxed);
+                    if (n > 0) {
+                        out[op].add(b, n, sum, most);
+                        sum = 0;
+                    }
+                }
+            }
+        }
+    };
 
-// ==========================
-// DERIVED CLASS #1 
-// ==========================
-class ClimbSession : public Activity {
 private:
-    double hours;
-    Location location;
+    mutex lock;
+    Block* live = nullptr;
+    LatencyHistogram retired[TRACKED_OP_COUNT];
 
 public:
-    ClimbSession(string n, int d, ClimbDifficulty diff,
-        double h, Location loc)
-        : Activity(n, d, diff), hours(h), location(loc) {
-    }
-    // ===== OPERATOR== (identity comparison) =====
-    bool operator==(const ClimbSession& other) const {
-        return name == other.name &&
-            hours == other.hours &&
-            location.getPlace() == other.location.getPlace() &&
-            location.isIndoor() == other.location.isIndoor();
+    static OpStatsRegistry& instance() {
+        static OpStatsRegistry registry;
+        return registry;
     }
 
-    // ===== STREAM OVERRIDE ===== 
-    void toStream(ostream& os) const override {
-        os << "[Climb] "
-            << name << " | "
-            << hours << " hrs | "
-            << location.formattedLocation();
-    }
-    //  PURE VIRTUAL IMPLEMENTATION
-    string getType() const override {
-        return "Climb Session";
+    // blocks come from calloc and are linked in place, so the registry
+    // never shows up in allocation counts or leak checks
+    Block* attach() {
+        Block* block = new (calloc(1, sizeof(Block))) Block;
+        lock_guard<mutex> guard(lock);
+        block->prev = nullptr;
+        block->next = live;
+        if (live != nullptr) live->prev = block;
+        live = block;
+        return block;
     }
 
-    void setHours(double h) { hours = h; }
-    void setLocation(const Location& loc) { location = loc; }
-
-    double getHours() const { return hours; }
-    Location getLocation() const { return location; }
-
-    void print() const override {
-        Activity::print();
-        cout << "Hours Climbed: " << hours << endl;
-        cout << "Location: " << location.formattedLocation() << endl;
+    void detach(Block* block) {
+        {
+            lock_guard<mutex> guard(lock);
+            block->addTo(retired);
+            if (block->prev != nullptr) block->prev->next = block->next;
+            else live = block->next;
+            if (block->next != nullptr) block->next->prev = block->prev;
+        }
+        block->~Block();
+        free(block);
     }
-    Activity* clone() const override {
-        return new ClimbSession(*this);
+
+    void snapshot(OpStatsSnapshot& out) {
+        lock_guard<mutex> guard(lock);
+        for (int op = 0; op < TRACKED_OP_COUNT; op++) out.ops[op] = retired[op];
+        for (const Block* block = live; block != nullptr; block = block->next) block->addTo(out.ops);
     }
 };
 
+class ThreadOpStats {
+private:
+    OpStatsRegistry& registry;   // constructed first, so it outlives every thread's block
+    OpStatsRegistry::Block* block;
+
+public:
+    ThreadOpStats() : registry(OpStatsRegistry::instance()), block(registry.attach()) {}
+    ~ThreadOpStats() { registry.detach(block); }
 
+    void record(TrackedOp op, uint64_t ns) { block->record(static_cast<int>(op), ns); }
+};
 
+inline void recordOp(TrackedOp op, uint64_t ns) {
+    thread_local ThreadOpStats stats;
+    stats.record(op, ns);
+}
 
-// ==========================
-// DERIVED CLASS #2 
-// ==========================
-class TrainingSession : public Activity {
+class OpTimer {
 private:
-    int reps;
+    TrackedOp op;
+    chrono::steady_clock::time_point start;
 
 public:
-    TrainingSession(string n, int d, ClimbDifficulty diff, int r)
-        : Activity(n, d, diff), reps(r) {
+    explicit OpTimer(TrackedOp o) : op(o), start(chrono::steady_clock::now()) {}
+    ~OpTimer() {
+        chrono::steady_clock::time_point end = chrono::steady_clock::now();
+        uint64_t ns = static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(end - start).count());
+        recordOp(op, ns);
+#ifndef TRACKER_NO_TRACE
+        if (tracingEnabled()) recordSpan(TRACKED_OP_NAMES[static_cast<int>(op)], traceNs(start), ns);
+#endif
     }
+};
 
-    //  PURE VIRTUAL IMPLEMENTATION
-    string getType() const override {
-        return "Training Session";
-    }
-    // ===== STREAM OVERRIDE ===== 
-    void toStream(ostream& os) const override {
-        os << "[Training] "
-            << name << " | "
-            << reps << " reps";
+// times the rest of the enclosing scope
+#define TRACK_OP(op) OpTimer TRACKER_CONCAT(opTimer, __LINE__)(op)
+
+inline OpStatsSnapshot snapshotOpStats() {
+    OpStatsSnapshot out;
+    out.enabled = true;
+    OpStatsRegistry::instance().snapshot(out);
+    return out;
+}
+#else
+#define TRACK_OP(op) TRACE_SPAN(TRACKED_OP_NAMES[static_cast<int>(op)])
+
+inline OpStatsSnapshot snapshotOpStats() {
+    OpStatsSnapshot out;
+    out.enabled = false;
+    return out;
+}
+#endif
+
+// one line, for the "stats" command and the menu's JSON dump
+inline string opStatsJson(const OpStatsSnapshot& stats) {
+    string json = stats.enabled ? "{\"enabled\":true,\"ops\":{" : "{\"enabled\":false,\"ops\":{";
+    char field[256];
+    for (int op = 0; op < TRACKED_OP_COUNT; op++) {
+        const LatencyHistogram& h = stats.ops[op];
+        snprintf(field, sizeof(field),
+            "%s\"%s\":{\"count\":%llu,\"total_ns\":%llu,\"mean_ns\":%.1f,\"p50_ns\":%llu,"
+            "\"p90_ns\":%llu,\"p99_ns\":%llu,\"max_ns\":%llu}",
+            op > 0 ? "," : "", TRACKED_OP_NAMES[op],
+            static_cast<unsigned long long>(h.getCount()), static_cast<unsigned long long>(h.getTotalNs()),
+            h.meanNs(), static_cast<unsigned long long>(h.percentileNs(0.5)),
+            static_cast<unsigned long long>(h.percentileNs(0.9)), static_cast<unsigned long long>(h.percentileNs(0.99)),
+            static_cast<unsigned long long>(h.getMaxNs()));
+        json += field;
     }
-    void setReps(int r) { reps = r; }
-    int getReps() const { return reps; }
+    json += "}}";
+    return json;
+}
 
-    void print() const override {
-        Activity::print();
-        cout << "Reps: " << reps << endl;
+inline void printOpStats(ostream& out, const OpStatsSnapshot& stats) {
+    if (!stats.enabled) {
+        out << "Statistics were compiled out (TRACKER_NO_STATS).\n";
+        return;
     }
-    Activity* clone() const override {
-        return new TrainingSession(*this);
+    out << left << setw(10) << "operation" << right << setw(10) << "count" << setw(12) << "mean us"
+        << setw(12) << "p50 us" << setw(12) << "p99 us" << setw(12) << "max us" << '\n';
+    for (int op = 0; op < TRACKED_OP_COUNT; op++) {
+        const LatencyHistogram& h = stats.ops[op];
+        out << left << setw(10) << TRACKED_OP_NAMES[op] << right << setw(10) << h.getCount()
+            << fixed << setprecision(2) << setw(12) << h.meanNs() / 1000.0
+            << setw(12) << h.percentileNs(0.5) / 1000.0 << setw(12) << h.percentileNs(0.99) / 1000.0
+            << setw(12) << h.getMaxNs() / 1000.0 << '\n';
     }
-};
-
-// ===== GLOBAL STREAM OPERATOR =====
-ostream& operator<<(ostream& os, const Activity& a) {
-    a.toStream(os);   // polymorphic call
-    return os;
 }
 // ==========================
-// BANNER
+// CONSTANTS 
 // ==========================
-void displayBanner() {
-    setColor(11);
-    cout << "=========================================\n";
-    cout << "        CLIMBING ACTIVITY TRACKER         \n";
-    cout << "=========================================\n";
-    setColor(7);
-}
+const int ADVANCED_HOURS = 160;
+const int INTERMEDIATE_HOURS = 21;
+const int FREQUENT_CLIMBER_DAYS = 80;
+const int NEW_CLIMBER_DAYS = 10;
+const double DEDICATED_SESSION_HOURS = 2.0;
+const long long SECONDS_PER_DAY = 86400;
+const double LOAD_PER_REP = 1.0;          // one rep counts like a minute of effort
+const double MIN_SESSION_HOURS = 0.1;     // accepted range for a climb's hours
+const double MAX_SESSION_HOURS = 24.0;
+const int MIN_REPS = 1;
+const int MAX_REPS = 100;
+const long long MAX_TIMESTAMP = 253402300799LL;   // 9999-12-31 23:59:59 UTC
 
 // ==========================
-// INPUT VALIDATION
+// ENUM 
 // ==========================
-int getValidatedInt(const string& prompt, int min, int max) {
-    int value;
-    do {
-        cout << prompt;
-        cin >> value;
-        if (cin.fail() || value < min || value > max) {
-            cin.clear();
-            cin.ignore(1000, '\n');
-            cout << "Invalid input. Please enter a number between "
-                << min << " and " << max << ".\n";
-        }
-    } while (value < min || value > max);
-    return value;
-}
+enum ClimbDifficulty { EASY = 1, MODERATE, HARD, EXTREME };
 
-double getValidatedDouble(const string& prompt, double min, double max) {
-    double value;
-    do {
-        cout << prompt;
-        cin >> value;
-        if (cin.fail() || value < min || value > max) {
-            cin.clear();
-            cin.ignore(1000, '\n');
-            cout << "Invalid input. Please enter a value between "
-                << min << " and " << max << ".\n";
-        }
-    } while (value < min || value > max);
-    return value;
+// ==========================
+// ENUM HELPER
+// ==========================
+string difficultyToString(ClimbDifficulty d) {
+    switch (d) {
+    case EASY: return "Easy";
+    case MODERATE: return "Moderate";
+    case HARD: return "Hard";
+    case EXTREME: return "Extreme";
+    default: return "Unknown";
+    }
 }
 
+// indexed by ClimbDifficulty, for rendering without building strings
+const string_view DIFFICULTY_LABELS[] = { "Unknown", "Easy", "Moderate", "Hard", "Extreme" };
+
 // ==========================
-// YES / NO VALIDATION
+// GRADES
+// every system maps onto one ordinal scale (approximate equivalences
+// from the usual conversion charts); a blank label has no equivalent
 // ==========================
-bool getYesNo(const string& prompt) {
-    char choice;
-    do {
-        cout << prompt << " (y/n): ";
-        cin >> choice;
+enum GradeSystem : uint8_t { V_SCALE, YDS, FRENCH };
 
-        if (choice == 'Y') choice = 'y';
-        if (choice == 'N') choice = 'n';
+const int GRADE_COUNT = 30;
 
-    } while (choice != 'y' && choice != 'n');
+struct GradeLabels {
+    const char* vScale;
+    const char* yds;
+    const char* french;
+};
 
-    return choice == 'y';
+const GradeLabels GRADE_TABLE[GRADE_COUNT] = {
+    { "",    "5.4",   "3"   }, { "",    "5.5",   "4a"  }, { "",    "5.6",   "4b"  },
+    { "",    "5.7",   "4c"  }, { "VB",  "5.8",   "5a"  }, { "",    "5.9",   "5b"  },
+    { "",    "5.10a", "5c"  }, { "V0",  "5.10b", "6a"  }, { "",    "5.10c", "6a+" },
+    { "V1",  "5.10d", "6b"  }, { "",    "5.11a", "6b+" }, { "V2",  "5.11b", "6c"  },
+    { "",    "5.11c", "6c+" }, { "V3",  "5.11d", "7a"  }, { "V4",  "5.12a", "7a+" },
+    { "V5",  "5.12b", "7b"  }, { "V6",  "5.12c", "7b+" }, { "V7",  "5.12d", "7c"  },
+    { "V8",  "5.13a", "7c+" }, { "V9",  "5.13b", "8a"  }, { "V10", "5.13c", "8a+" },
+    { "V11", "5.13d", "8b"  }, { "V12", "5.14a", "8b+" }, { "V13", "5.14b", "8c"  },
+    { "V14", "5.14c", "8c+" }, { "V15", "5.14d", "9a"  }, { "V16", "5.15a", "9a+" },
+    { "V17", "5.15b", "9b"  }, { "",    "5.15c", "9b+" }, { "",    "5.15d", "9c"  }
+};
+
+inline const char* gradeLabelAt(int ordinal, GradeSystem system) {
+    const GradeLabels& row = GRADE_TABLE[ordinal];
+    return system == V_SCALE ? row.vScale : (system == YDS ? row.yds : row.french);
 }
 
-// ==========================
-// DIFFICULTY PROMPT
-// ==========================
-ClimbDifficulty promptDifficulty() {
-    cout << "Select Difficulty:\n";
-    cout << "1. Easy\n";
-    cout << "2. Moderate\n";
-    cout << "3. Hard\n";
-    cout << "4. Extreme\n";
-    int choice = getValidatedInt("Choice: ", 1, 4);
-    return static_cast<ClimbDifficulty>(choice);
+// label for an ordinal in any system: nearest equivalent at or below, else above
+inline string_view gradeLabel(int ordinal, GradeSystem system) {
+    if (ordinal < 0 || ordinal >= GRADE_COUNT) return "?";
+    for (int o = ordinal; o >= 0; o--)
+        if (*gradeLabelAt(o, system) != '\0') return gradeLabelAt(o, system);
+    for (int o = ordinal + 1; o < GRADE_COUNT; o++)
+        if (*gradeLabelAt(o, system) != '\0') return gradeLabelAt(o, system);
+    return "?";
 }
 
 // ==========================
-// EXPERIENCE LEVEL
+// GRADE (one byte)
+// top two bits: system the grade was recorded in, low six: ordinal
 // ==========================
-string determineExperienceLevel(int totalHours) {
-    if (totalHours >= ADVANCED_HOURS)
-        return "Advanced";
-    if (totalHours >= INTERMEDIATE_HOURS)
-        return "Intermediate";
-    return "Beginner";
-}
+class Grade {
+private:
+    uint8_t code;
+
+    static const uint8_t NONE = 0xFF;
+
+public:
+    Grade() : code(NONE) {}
+    // an ordinal off the scale or an unknown system gives an invalid grade
+    Grade(int ordinal, GradeSystem system)
+        : code((ordinal < 0 || ordinal >= GRADE_COUNT || system > FRENCH)
+            ? NONE : static_cast<uint8_t>((system << 6) | ordinal)) {
+    }
+
+    bool isValid() const { return code != NONE; }
+    int ordinal() const { return code & 0x3F; }
+    GradeSystem system() const { return static_cast<GradeSystem>(code >> 6); }
+    uint8_t encoded() const { return code; }
+
+    static Grade fromEncoded(uint8_t code) {
+        return code == NONE ? Grade() : Grade(code & 0x3F, static_cast<GradeSystem>(code >> 6));
+    }
+
+    // V5 / 5.11a / 6b+ ; the system is detected from the text
+    static Grade parse(string_view text) {
+        GradeSystem system = FRENCH;
+        if (!text.empty() && (text[0] == 'V' || text[0] == 'v'))
+            system = V_SCALE;
+        else if (text.size() > 2 && text[0] == '5' && text[1] == '.')
+            system = YDS;
+
+        for (int o = 0; o < GRADE_COUNT; o++) {
+            string_view label = gradeLabelAt(o, system);
+            if (label.empty() || label.size() != text.size()) continue;
+
+            bool same = true;
+            for (size_t i = 0; i < label.size() && same; i++)
+                same = tolower(static_cast<unsigned char>(label[i])) == tolower(static_cast<unsigned char>(text[i]));
+            if (same) return Grade(o, system);
+        }
+        return Grade();
+    }
+
+    string toString() const {
+        return isValid() ? string(gradeLabel(ordinal(), system())) : "Ungraded";
+    }
+};
 
 // ==========================
-// CLIMBING FREQUENCY
+// MEMORY FOOTPRINT
+// live bytes of a structure by what they hold: payload is the objects
+// themselves (vtable pointer and padding included), strings the used
+// part of string buffers too long to stay inline, nodes the links of
+// node-based containers, auxiliary the index columns, bitmaps, sort
+// orders and ring slots kept beside the data, and slack the capacity
+// reserved but unused. These are requested sizes; allocator headers
+// and rounding come on top.
 // ==========================
-string determineClimberType(int climbingDays) {
-    if (climbingDays >= FREQUENT_CLIMBER_DAYS)
-        return "Frequent Climber";
-    if (climbingDays >= NEW_CLIMBER_DAYS)
-        return "Regular Climber";
-    return "New Climber";
+struct MemoryFootprint {
+    size_t payload = 0;
+    size_t strings = 0;
+    size_t nodes = 0;
+    size_t auxiliary = 0;
+    size_t slack = 0;
+
+    size_t total() const { return payload + strings + nodes + auxiliary + slack; }
+
+    MemoryFootprint& operator+=(const MemoryFootprint& other) {
+        payload += other.payload;
+        strings += other.strings;
+        nodes += other.nodes;
+        auxiliary += other.auxiliary;
+        slack += other.slack;
+        return *this;
+    }
+};
+
+inline void addStringFootprint(MemoryFootprint& f, const string& s) {
+    static const size_t inlineCapacity = string().capacity();
+    if (s.capacity() <= inlineCapacity) return;
+    f.strings += s.size() + 1;
+    f.slack += s.capacity() - s.size();
 }
 
-// ==========================
-// PERFORMANCE RATING
-// ==========================
-string performanceRating(double hoursPerSession) {
-    if (hoursPerSession >= DEDICATED_SESSION_HOURS)
-        return "Highly Dedicated";
-    if (hoursPerSession >= 1.0)
-        return "Moderately Dedicated";
-    return "Casual";
+// elements go to `used`; their own heap memory is not followed
+template <typename T>
+inline void addVectorFootprint(MemoryFootprint& f, const vector<T>& v, size_t MemoryFootprint::* used) {
+    f.*used += v.size() * sizeof(T);
+    f.slack += (v.capacity() - v.size()) * sizeof(T);
+}
+
+inline void printFootprint(ostream& out, const MemoryFootprint& f, int items) {
+    double perItem = items > 0 ? static_cast<double>(f.total()) / items : 0.0;
+    out << left << setw(12) << "payload" << right << setw(14) << f.payload << '\n'
+        << left << setw(12) << "strings" << right << setw(14) << f.strings << '\n'
+        << left << setw(12) << "nodes" << right << setw(14) << f.nodes << '\n'
+        << left << setw(12) << "auxiliary" << right << setw(14) << f.auxiliary << '\n'
+        << left << setw(12) << "slack" << right << setw(14) << f.slack << '\n'
+        << left << setw(12) << "total" << right << setw(14) << f.total()
+        << " bytes (" << fixed << setprecision(1) << perItem << " per activity)\n";
 }
 
 // ==========================
-// FILE SAVE (UNCHANGED)
+// GRADE RECENCY
+// the latest send day per ordinal: enough to answer "hardest grade
+// since" without the full pyramid, small enough to copy into snapshots
 // ==========================
-void saveReport(const string& filename, const string& report) {
-    ofstream outFile(filename);
-    if (outFile) {
-        outFile << report;
-        outFile.close();
-        cout << "Report saved to " << filename << endl;
+struct GradeRecency {
+    static const int NO_DAY = INT32_MIN;
+
+    int latestDay[GRADE_COUNT];
+    GradeSystem preferred = V_SCALE;
+
+    GradeRecency() {
+        for (int& day : latestDay) day = NO_DAY;
     }
-    else {
-        cout << "Error saving report.\n";
+
+    // highest ordinal sent on or after fromDay, -1 if none
+    int hardestSince(int fromDay) const {
+        for (int o = GRADE_COUNT - 1; o >= 0; o--)
+            if (latestDay[o] != NO_DAY && latestDay[o] >= fromDay) return o;
+        return -1;
     }
-}
 
-// ==========================
-// FILE LOAD 
-// ==========================
-string loadReport(const string& filename) {
-    ifstream inFile(filename);
-    string content, line;
-    if (inFile) {
-        while (getline(inFile, line)) {
-            content += line + "\n";
-        }
-        inFile.close();
+    bool operator==(const GradeRecency& other) const {
+        return preferred == other.preferred && equal(begin(latestDay), end(latestDay), begin(other.latestDay));
     }
-    return content;
-}
-// ===== DYNAMIC ARRAY TEMPLATE (FINAL - NO LEAKS, NO SHALLOW COPIES) =====
-template <typename T>
-class DynamicArray {
+};
+
+// ==========================
+// GRADE PYRAMID
+// send days per ordinal, updated per send and mergeable across climbers
+// ==========================
+class GradePyramid {
 private:
-    T* arr;
-    int capacity;
-    int size;
+    static const int NO_DAY = INT32_MIN;
 
-    // resize helper
-    void resize(int newCapacity) {
-        T* newArr = new T[newCapacity];
+    vector<int> sendDays[GRADE_COUNT];   // ascending; one entry per send
+    uint32_t systemUse[3];
+    uint32_t total;
 
-        for (int i = 0; i < size; i++)
-            newArr[i] = arr[i];
+public:
+    GradePyramid() : total(0) {
+        clear();
+    }
 
-        delete[] arr;
-        arr = newArr;
-        capacity = newCapacity;
+    void clear() {
+        for (int o = 0; o < GRADE_COUNT; o++) sendDays[o].clear();
+        systemUse[V_SCALE] = systemUse[YDS] = systemUse[FRENCH] = 0;
+        total = 0;
     }
 
-public:
-    // ==========================
-    // CONSTRUCTOR
-    // ==========================
-    DynamicArray(int cap = 5)
-        : capacity(cap), size(0) {
-        arr = new T[capacity];
+    // days mostly arrive in order, so this is usually an append
+    void addSend(Grade g, int day) {
+        if (!g.isValid()) return;
+        vector<int>& days = sendDays[g.ordinal()];
+        days.insert(upper_bound(days.begin(), days.end(), day), day);
+        systemUse[g.system()]++;
+        total++;
     }
 
-    // ==========================
-    // 🚫 DISABLE COPYING
-    // ==========================
-    // Prevents shallow copy of pointers (CRITICAL for your assignment)
-    DynamicArray(const DynamicArray&) = delete;
-    DynamicArray& operator=(const DynamicArray&) = delete;
+    // removes the send recorded on that day; unknown sends are ignored
+    void removeSend(Grade g, int day) {
+        if (!g.isValid()) return;
+        vector<int>& days = sendDays[g.ordinal()];
+        auto it = lower_bound(days.begin(), days.end(), day);
+        if (it == days.end() || *it != day) return;
+        days.erase(it);
+        if (systemUse[g.system()] > 0) systemUse[g.system()]--;
+        total--;
+    }
 
-    // ==========================
-    // DESTRUCTOR
-    // ==========================
-    ~DynamicArray() {
-        delete[] arr;
+    void merge(const GradePyramid& other) {
+        for (int o = 0; o < GRADE_COUNT; o++) {
+            vector<int>& days = sendDays[o];
+            size_t mid = days.size();
+            days.insert(days.end(), other.sendDays[o].begin(), other.sendDays[o].end());
+            inplace_merge(days.begin(), days.begin() + mid, days.end());
+        }
+        for (int s = 0; s < 3; s++)
+            systemUse[s] += other.systemUse[s];
+        total += other.total;
     }
 
-    // ==========================
-    // ADD ELEMENT
-    // ==========================
-    void add(const T& value) {
-        if (size == capacity)
-            resize(capacity * 2);
+    void addFootprint(MemoryFootprint& f) const {
+        for (const vector<int>& days : sendDays) addVectorFootprint(f, days, &MemoryFootprint::auxiliary);
+    }
 
-        arr[size++] = value;
+    uint32_t sendsAt(int ordinal) const { return static_cast<uint32_t>(sendDays[ordinal].size()); }
+
+    GradeRecency recency() const {
+        GradeRecency r;
+        for (int o = 0; o < GRADE_COUNT; o++)
+            if (!sendDays[o].empty()) r.latestDay[o] = sendDays[o].back();
+        r.preferred = preferredSystem();
+        return r;
     }
+    uint32_t getTotal() const { return total; }
 
-    // ==========================
-    // REMOVE ELEMENT
-    // ==========================
-    void remove(int index) {
-        if (index < 0 || index >= size) {
-            throw IndexOutOfRange("DynamicArray::remove - index out of range");
-        }
+    // highest ordinal sent on or after fromDay, -1 if none
+    int hardestSince(int fromDay) const {
+        for (int o = GRADE_COUNT - 1; o >= 0; o--)
+            if (!sendDays[o].empty() && sendDays[o].back() >= fromDay) return o;
+        return -1;
+    }
 
-        for (int i = index; i < size - 1; i++)
-            arr[i] = arr[i + 1];
+    int hardest() const { return hardestSince(NO_DAY); }
 
-        size--;
+    // the system most sends were recorded in
+    GradeSystem preferredSystem() const {
+        GradeSystem best = V_SCALE;
+        for (int s = YDS; s <= FRENCH; s++)
+            if (systemUse[s] > systemUse[best]) best = static_cast<GradeSystem>(s);
+        return best;
     }
 
-    // ==========================
-    // INDEXING
-    // ==========================
-    T& operator[](int index) {
-        if (index < 0 || index >= size) {
-            throw IndexOutOfRange("DynamicArray::operator[] - index out of range");
+    // hardest grade at the top, one '#' per send (scaled down past 40);
+    // ordinals with no label in this system fold into the one below
+    void render(ostream& os, GradeSystem system) const {
+        int top = hardest();
+        if (top < 0) {
+            os << "No graded sends recorded.\n";
+            return;
+        }
+        int bottom = 0;
+        while (sendDays[bottom].empty()) bottom++;
+
+        vector<pair<string_view, uint32_t>> rows;
+        for (int o = top; o >= bottom; o--) {
+            string_view label = gradeLabel(o, system);
+            if (rows.empty() || rows.back().first != label)
+                rows.push_back({ label, 0 });
+            rows.back().second += sendsAt(o);
         }
-        return arr[index];
-    }
 
-    const T& operator[](int index) const {
-        if (index < 0 || index >= size) {
-            throw IndexOutOfRange("DynamicArray::operator[] const - index out of range");
+        uint32_t widest = 0;
+        for (const auto& row : rows)
+            if (row.second > widest) widest = row.second;
+
+        for (const auto& row : rows) {
+            uint32_t bar = (widest > 40) ? (row.second * 40 + widest - 1) / widest : row.second;
+            os << left << setw(7) << row.first << "| "
+                << string(bar, '#') << ' ' << row.second << '\n';
         }
-        return arr[index];
-    }
-    // ==========================
-    // SIZE ACCESSOR
-    // ==========================
-    int getSize() const {
-        return size;
     }
 };
+
 // ==========================
-// LINKED LIST ADT
-// Unordered singly linked list
+// TERMINAL
+// colors are the Windows console attributes the menus always used
+// (7 default, 10 green, 11 cyan, 12 red, 14 yellow), sent as ANSI
+// escapes. Nothing is sent when stdout is not a terminal or NO_COLOR
+// is set. Windows consoles get virtual terminal processing switched on
+// and fall back to SetConsoleTextAttribute when that is refused.
 // ==========================
-class ActivityLinkedList {
+class Terminal {
 private:
-    struct Node {
-        Activity* data;
-        Node* next;
+    bool color;
+    bool ansi;
+    int current;
+
+    Terminal() : color(false), ansi(true), current(7) {
+#ifdef _WIN32
+        color = _isatty(_fileno(stdout)) != 0;
+        if (color) {
+            HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+            DWORD mode = 0;
+            ansi = GetConsoleMode(out, &mode) && SetConsoleMode(out, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+        }
+#else
+        color = isatty(STDOUT_FILENO) != 0;
+#endif
+        const char* noColor = getenv("NO_COLOR");
+        if (noColor != nullptr && noColor[0] != '\0') color = false;
+    }
 
-        Node(Activity* d, Node* n = nullptr)
-            : data(d), next(n) {
+public:
+    static Terminal& instance() {
+        static Terminal terminal;
+        return terminal;
+    }
+
+    bool colorEnabled() const { return color; }
+
+    void setColorEnabled(bool on) {
+        color = on;
+        current = 7;
+    }
+
+    // SGR code for a console attribute: bit 0 blue, 1 green, 2 red,
+    // 3 bright; the default gray resets instead
+    static int ansiCode(int attribute) {
+        if ((attribute & 15) == 7) return 0;
+        int hue = ((attribute & 4) ? 1 : 0) | ((attribute & 2) ? 2 : 0) | ((attribute & 1) ? 4 : 0);
+        return ((attribute & 8) ? 90 : 30) + hue;
+    }
+
+    void setColor(int attribute) {
+        if (!color || attribute == current) return;
+        current = attribute;
+#ifdef _WIN32
+        if (!ansi) {
+            if (ostream* tied = cin.tie()) tied->flush();   // what a ScreenOutput holds, too
+            cout.flush();
+            SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), static_cast<WORD>(attribute));
+            return;
         }
-    };
+#endif
+        char sequence[8];
+        int n = snprintf(sequence, sizeof(sequence), "\033[%dm", ansiCode(attribute));
+        cout.write(sequence, n);
+    }
+};
 
-    Node* head;
-    Node* tail;
-    int size;
+void setColor(int color) {
+    Terminal::instance().setColor(color);
+}
 
-public:
-    // ==========================
-    // ITERATOR CLASS
-    // ==========================
-    class Iterator {
-    private:
-        Node* current;
+// ==========================
+// SCREEN OUTPUT
+// while alive, cout collects a whole screen and writes it once, when
+// input is read (cin is tied to the presenter) or the scope ends, so
+// endl and color changes no longer cost a write each. The screen goes
+// to the stdout descriptor in one system call unless cout was
+// redirected to another buffer, which then gets it in one sputn.
+// ==========================
 
-    public:
-        Iterator(Node* start) : current(start) {}
+// cout's buffer at startup, before anything could redirect it
+streambuf* const STANDARD_OUTPUT = cout.rdbuf();
+
+// loops until everything is written or the descriptor fails
+bool writeToStdout(const char* data, size_t size) {
+#ifdef _WIN32
+    HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+    while (size > 0) {
+        DWORD written = 0;
+        DWORD chunk = static_cast<DWORD>(min<size_t>(size, 1u << 30));
+        if (!WriteFile(out, data, chunk, &written, nullptr) || written == 0) return false;
+        data += written;
+        size -= written;
+    }
+#else
+    while (size > 0) {
+        ssize_t written = ::write(STDOUT_FILENO, data, size);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+#endif
+    return true;
+}
 
-        bool hasCurrent() const {
-            return current != nullptr;
+class ScreenOutput {
+private:
+    class Buffer : public streambuf {
+    private:
+        streambuf* target;      // nullptr: straight to the stdout descriptor
+        vector<char> storage;   // the put area; a full one is presented
+
+        void send(const char* data, size_t size) {
+            if (target != nullptr) {
+                target->sputn(data, static_cast<streamsize>(size));
+                return;
+            }
+            fflush(stdout);     // whatever stdio still holds goes first
+            writeToStdout(data, size);
         }
 
-        void next() {
-            if (current != nullptr) {
-                current = current->next;
+    protected:
+        int_type overflow(int_type ch) override {
+            present();
+            if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+                *pptr() = traits_type::to_char_type(ch);
+                pbump(1);
             }
+            return traits_type::not_eof(ch);
         }
 
-        Activity* getData() const {
-            if (current == nullptr) {
-                return nullptr;
+        streamsize xsputn(const char* s, streamsize n) override {
+            size_t size = static_cast<size_t>(n);
+            if (size > static_cast<size_t>(epptr() - pptr())) {
+                present();
+                if (size >= storage.size()) {
+                    send(s, size);
+                    return n;
+                }
             }
-            return current->data;
+            memcpy(pptr(), s, size);
+            pbump(static_cast<int>(size));
+            return n;
         }
-    };
 
-    // ==========================
-    // CONSTRUCTOR
-    // ==========================
-    ActivityLinkedList() : head(nullptr), tail(nullptr), size(0) {}
+        int sync() override { return 0; }
 
-    // ==========================
-    // COPY CONSTRUCTOR
-    // deep copy
-    // ==========================
-    ActivityLinkedList(const ActivityLinkedList& other)
-        : head(nullptr), tail(nullptr), size(0) {
-        Node* current = other.head;
-        while (current != nullptr) {
-            insertBack(current->data->clone());
-            current = current->next;
+    public:
+        static const size_t SCREEN_FLUSH_BYTES = 64 * 1024;
+
+        explicit Buffer(streambuf* t)
+            : target(t == STANDARD_OUTPUT ? nullptr : t), storage(SCREEN_FLUSH_BYTES) {
+            setp(storage.data(), storage.data() + storage.size());
         }
-    }
 
-    // ==========================
-    // COPY ASSIGNMENT
-    // deep copy
-    // ==========================
-    ActivityLinkedList& operator=(const ActivityLinkedList& other) {
-        if (this != &other) {
-            clear();
-            Node* current = other.head;
-            while (current != nullptr) {
-                insertBack(current->data->clone());
-                current = current->next;
+        void present() {
+            if (pptr() > pbase()) {
+                send(pbase(), static_cast<size_t>(pptr() - pbase()));
+                setp(storage.data(), storage.data() + storage.size());
             }
+            if (target != nullptr) target->pubsync();
         }
-        return *this;
-    }
-
-    // ==========================
-    // DESTRUCTOR
-    // ==========================
-    ~ActivityLinkedList() {
-        clear();
-    }
+    };
 
-    // ==========================
-    // INSERT FRONT
-    // ==========================
-    void insertFront(Activity* act) {
-        Node* newNode = new Node(act, head);
-        head = newNode;
+    class Presenter : public streambuf {
+    private:
+        Buffer& screen;
 
-        if (tail == nullptr) {
-            tail = newNode;
+    protected:
+        int sync() override {
+            screen.present();
+            return 0;
         }
 
-        size++;
-    }
+    public:
+        explicit Presenter(Buffer& s) : screen(s) {}
+    };
 
-    // ==========================
-    // INSERT BACK
-    // ==========================
-    void insertBack(Activity* act) {
-        Node* newNode = new Node(act);
+    Buffer buffer;
+    Presenter presenter;
+    ostream presenterStream;
+    streambuf* savedBuffer;
+    ostream* savedInTie;
+    ostream* savedErrTie;
 
-        if (head == nullptr) {
-            head = tail = newNode;
-        }
-        else {
-            tail->next = newNode;
-            tail = newNode;
-        }
+public:
+    ScreenOutput()
+        : buffer(cout.rdbuf()), presenter(buffer), presenterStream(&presenter),
+        savedBuffer(cout.rdbuf(&buffer)), savedInTie(cin.tie(&presenterStream)),
+        savedErrTie(cerr.tie(&presenterStream)) {
+    }
 
-        size++;
+    ~ScreenOutput() {
+        setColor(7);
+        buffer.present();
+        cout.rdbuf(savedBuffer);
+        cin.tie(savedInTie);
+        cerr.tie(savedErrTie);
     }
 
-    // ==========================
-    // DELETE AT POSITION
-    // returns true if removed
-    // ==========================
-    bool deleteAtPosition(int index) {
-        if (index < 0 || index >= size) {
-            return false;
-        }
+    ScreenOutput(const ScreenOutput&) = delete;
+    ScreenOutput& operator=(const ScreenOutput&) = delete;
 
-        Node* toDelete = nullptr;
+    void present() { buffer.present(); }
+};
 
-        if (index == 0) {
-            toDelete = head;
-            head = head->next;
+// ==========================
+// CUSTOM EXCEPTION (NEW)
+// ==========================
+class IndexOutOfRange : public std::runtime_error {
+public:
+    explicit IndexOutOfRange(const std::string& msg)
+        : std::runtime_error(msg) {}
+};
 
-            if (head == nullptr) {
-                tail = nullptr;
-            }
-        }
-        else {
-            Node* prev = head;
-            for (int i = 0; i < index - 1; i++) {
-                prev = prev->next;
-            }
+//New code for week 11 assignment, added by Chris Noonan
 
-            toDelete = prev->next;
-            prev->next = toDelete->next;
+template <class Type>
+class arrayStack {
+private:
+    int maxStackSize;
+    int stackTop;
+    Type* list;
 
-            if (toDelete == tail) {
-                tail = prev;
-            }
+public:
+
+    arrayStack(int stackSize = 100)  //default size 100
+    {
+        if (stackSize <= 0) {
+            cout << "Size of stack must be positive; defaulting to size 100..." << endl;
+
+            maxStackSize = 100;
         }
+        else
+            maxStackSize = stackSize;
+        
+        stackTop = 0;
+        list = new Type[maxStackSize];
+    }
+    void initializeStack() 
+    {
+        stackTop = 0;
+    }
 
-        delete toDelete->data;
-        delete toDelete;
-        size--;
-        return true;
+    bool isEmptyStack() 
+    {
+        return (stackTop == 0);
     }
 
-    // ==========================
-    // SEARCH BY NAME
-    // returns index or -1
-    // ==========================
-    int searchByName(const string& target) const {
-        Node* current = head;
-        int index = 0;
+    bool isFullStack() 
+    {
+        return (stackTop == maxStackSize);
+    }
 
-        while (current != nullptr) {
-            if (current->data != nullptr && current->data->getName() == target) {
-                return index;
-            }
-            current = current->next;
-            index++;
+    void push(const Type& newItem) 
+    {
+        if (!isFullStack()) {
+            list[stackTop] = newItem;
+
+            stackTop++;
         }
+        else
+            cout << "Cannot push to full stack" << endl;
+    }
 
-        return -1;
+    Type top() const 
+    {
+        assert(stackTop != 0);
+
+        return list[stackTop - 1];
     }
 
-    // ==========================
-    // GET AT POSITION
-    // ==========================
-    Activity* getAtPosition(int index) const {
-        if (index < 0 || index >= size) {
-            return nullptr;
-        }
+    void pop()
+    {
+        if (!isEmptyStack())
+            stackTop--;
+        else
+            cout << "Cannot pop from empty stack" << endl;
+    }
 
-        Node* current = head;
-        for (int i = 0; i < index; i++) {
-            current = current->next;
+    ~arrayStack() 
+    {
+        delete[] list;
+    }
+};
+
+template <class Type>
+class arrayQueue {
+private:
+    int maxQueueSize;
+    int count;
+    int queueFront;
+    int queueRear;
+    Type* list;
+
+public:
+
+    arrayQueue(int queueSize = 100) //default size 100
+    {
+        if (queueSize <= 0) {
+            cout << "Size of queue must be positive; defaulting to size 100..." << endl;
+
+            maxQueueSize = 100;
         }
+        else
+            maxQueueSize = queueSize;
+        queueFront = 0;
+        queueRear = maxQueueSize - 1;
+        count = 0;
+        list = new Type[maxQueueSize];
+    }
 
-        return current->data;
+    void initializeQueue()
+    {
+        queueFront = 0;
+        queueRear = maxQueueSize - 1;
+        count = 0;
     }
 
-    // ==========================
-    // PRINT/TRAVERSE
-    // uses iterator
-    // ==========================
-    void printList() const {
-        Iterator it(head);
+    bool isEmptyQueue() const
+    {
+        return(count == 0);
+    }
 
-        while (it.hasCurrent()) {
-            Activity* act = it.getData();
-            if (act != nullptr) {
-                act->print();
-            }
-            it.next();
-        }
+    bool isFullQueue() const
+    {
+        return(count == maxQueueSize);
     }
 
-    // ==========================
-    // CLEAR
-    // ==========================
-    void clear() {
-        Node* current = head;
+    Type front() const
+    {
+        assert(!isEmptyQueue());
+        return list[queueFront];
+    }
 
-        while (current != nullptr) {
-            Node* temp = current;
-            current = current->next;
+    Type back() const 
+    {
+        assert(!isEmptyQueue());
+        return list[queueRear];
+    }
 
-            delete temp->data;
-            delete temp;
-        }
+    void addQueue(const Type& queueElement)
+    {
+        if (!isFullQueue()) {
+            queueRear = (queueRear + 1) % maxQueueSize;
 
-        head = nullptr;
-        tail = nullptr;
-        size = 0;
+            count++;
+            list[queueRear] = queueElement;
+        }
+        else
+            cout << "Cannot add to a full queue." << endl;
     }
 
-    // ==========================
-    // SIZE
-    // ==========================
-    int getSize() const {
-        return size;
+    void deleteQueue()
+    {
+        if (!isEmptyQueue()) {
+            count--;
+            queueFront = (queueFront + 1) % maxQueueSize;
+        }
+        else
+            cout << "Cannot remove from an empty queue." << endl;
     }
 
-    // ==========================
-    // BEGIN ITERATOR
-    // ==========================
-    Iterator begin() const {
-        return Iterator(head);
+    ~arrayQueue()
+    {
+        delete[] list;
     }
 };
 
 // ==========================
-// MANAGER CLASS
-// now uses custom linked list ADT
+// MPMC QUEUE
+// bounded queue for many producer and consumer threads (Vyukov's
+// sequence-numbered cells). try* calls never block and report FULL or
+// EMPTY so producers can apply backpressure; the blocking calls wait
+// for room or items. After close() enqueues fail with CLOSED and
+// consumers drain what is left before they see CLOSED.
 // ==========================
-class ActivityManager {
+enum class QueueStatus { OK, FULL, EMPTY, CLOSED };
+
+template <class Type>
+class mpmcQueue {
 private:
-    ActivityLinkedList items;
+    struct Cell {
+        atomic<size_t> sequence;
+        Type data;
+    };
 
-public:
-    // Constructor
-    ActivityManager() = default;
+    Cell* buffer;
+    size_t mask;
+    alignas(64) atomic<size_t> enqueuePos;
+    alignas(64) atomic<size_t> dequeuePos;
+    atomic<bool> closed;
 
-    // Copy constructor
-    ActivityManager(const ActivityManager& other)
-        : items(other.items) {
+    // blocking calls sleep here; wakeups are timed so a missed notify only costs a tick
+    mutex waitLock;
+    condition_variable notFull;
+    condition_variable notEmpty;
+    atomic<int> sleepers;
+
+    template <typename Value>
+    QueueStatus push(Value&& value)
+    {
+        if (closed.load(memory_order_acquire))
+            return QueueStatus::CLOSED;
+
+        size_t pos = enqueuePos.load(memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &buffer[pos & mask];
+            size_t seq = cell->sequence.load(memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return QueueStatus::FULL;
+            else
+                pos = enqueuePos.load(memory_order_relaxed);
+        }
+        cell->data = std::forward<Value>(value);
+        cell->sequence.store(pos + 1, memory_order_release);
+        wake(notEmpty);
+        return QueueStatus::OK;
     }
 
-    // Copy assignment
-    ActivityManager& operator=(const ActivityManager& other) {
-        if (this != &other) {
-            items = other.items;
+    void wake(condition_variable& cv)
+    {
+        if (sleepers.load(memory_order_acquire) > 0) {
+            lock_guard<mutex> lock(waitLock);
+            cv.notify_all();
         }
-        return *this;
     }
 
-    // Destructor
-    ~ActivityManager() = default;
+    void sleep(condition_variable& cv)
+    {
+        unique_lock<mutex> lock(waitLock);
+        sleepers++;
+        cv.wait_for(lock, chrono::milliseconds(1));
+        sleepers--;
+    }
 
-    // Add activity at back
-    void add(Activity* act) {
-        items.insertBack(act);
+public:
+    // the capacity is rounded up to a power of two
+    mpmcQueue(int queueSize = 128)
+        : enqueuePos(0), dequeuePos(0), closed(false), sleepers(0)
+    {
+        if (queueSize <= 0)
+            throw runtime_error("mpmcQueue - size must be positive");
+        size_t size = 2;
+        while (size < static_cast<size_t>(queueSize)) size *= 2;
+        buffer = new Cell[size];
+        mask = size - 1;
+        for (size_t i = 0; i < size; i++)
+            buffer[i].sequence.store(i, memory_order_relaxed);
     }
 
-    // Optional second insertion position
-    void addToFront(Activity* act) {
-        items.insertFront(act);
+    mpmcQueue(const mpmcQueue&) = delete;
+    mpmcQueue& operator=(const mpmcQueue&) = delete;
+
+    ~mpmcQueue()
+    {
+        delete[] buffer;
     }
 
-    // Remove activity at index
-    void remove(int index) {
-        if (!items.deleteAtPosition(index)) {
-            throw IndexOutOfRange("ActivityManager::remove - invalid index");
+    QueueStatus tryEnqueue(const Type& item) { return push(item); }
+    QueueStatus tryEnqueue(Type&& item) { return push(std::move(item)); }
+
+    QueueStatus tryDequeue(Type& item)
+    {
+        size_t pos = dequeuePos.load(memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &buffer[pos & mask];
+            size_t seq = cell->sequence.load(memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return closed.load(memory_order_acquire) ? QueueStatus::CLOSED : QueueStatus::EMPTY;
+            else
+                pos = dequeuePos.load(memory_order_relaxed);
         }
+        item = std::move(cell->data);
+        cell->sequence.store(pos + mask + 1, memory_order_release);
+        wake(notFull);
+        return QueueStatus::OK;
     }
 
-    // Clear all activities
-    void clear() {
-        items.clear();
+    // waits while full; returns OK or CLOSED
+    QueueStatus enqueue(Type item)
+    {
+        for (int spins = 0;; spins++) {
+            QueueStatus status = push(std::move(item));
+            if (status != QueueStatus::FULL) return status;
+            if (spins < 64) this_thread::yield();
+            else sleep(notFull);
+        }
     }
 
-    // Size
-    int getSize() const {
-        return items.getSize();
+    // waits while empty; returns OK, or CLOSED once closed and drained
+    QueueStatus dequeue(Type& item)
+    {
+        for (int spins = 0;; spins++) {
+            QueueStatus status = tryDequeue(item);
+            if (status != QueueStatus::EMPTY) return status;
+            if (spins < 64) this_thread::yield();
+            else sleep(notEmpty);
+        }
     }
 
-    // Get by index
-    Activity* get(int index) const {
-        return items.getAtPosition(index);
+    // up to maxItems without waiting; returns how many were taken
+    size_t tryDequeueBatch(Type* items, size_t maxItems)
+    {
+        size_t taken = 0;
+        while (taken < maxItems && tryDequeue(items[taken]) == QueueStatus::OK)
+            taken++;
+        return taken;
     }
 
-    // operator[]
-    Activity* operator[](int index) const {
-        Activity* act = items.getAtPosition(index);
-        if (act == nullptr) {
-            throw IndexOutOfRange("ActivityManager::operator[] - invalid index");
-        }
-        return act;
+    // waits for at least one item; 0 means closed and drained
+    size_t dequeueBatch(Type* items, size_t maxItems)
+    {
+        if (maxItems == 0) return 0;
+        if (dequeue(items[0]) != QueueStatus::OK) return 0;
+        return 1 + tryDequeueBatch(items + 1, maxItems - 1);
     }
 
-    // operator+=
-    ActivityManager& operator+=(Activity* act) {
-        add(act);
-        return *this;
+    // call once the producers are done: an enqueue racing with close()
+    // may still succeed after a consumer has already seen CLOSED
+    void close()
+    {
+        closed.store(true, memory_order_release);
+        lock_guard<mutex> lock(waitLock);
+        notFull.notify_all();
+        notEmpty.notify_all();
     }
 
-    // operator-=
-    ActivityManager& operator-=(int index) {
-        remove(index);
-        return *this;
+    bool isClosed() const { return closed.load(memory_order_acquire); }
+
+    int capacity() const { return static_cast<int>(mask + 1); }
+
+    // approximate while other threads are active
+    int size() const
+    {
+        size_t in = enqueuePos.load(memory_order_acquire);
+        size_t out = dequeuePos.load(memory_order_acquire);
+        return in > out ? static_cast<int>(in - out) : 0;
     }
+};
 
-    // Display all
-    void displayAll() const {
-        items.printList();
+
+// ==========================
+// BASE CLASS 
+// ==========================
+class Activity {
+protected:
+    string name;
+    int duration;
+    ClimbDifficulty difficulty;
+    long long timestamp;       // seconds since the epoch, 0 = not recorded
+
+public:
+    Activity()
+        : name(""), duration(0), difficulty(EASY), timestamp(0) {
     }
 
-    // Recursive count
-    int countTypeRecursive(const string& type, int index = 0) const {
-        if (index >= items.getSize()) {
-            return 0;
-        }
+    Activity(string n, int d, ClimbDifficulty diff)
+        : name(n), duration(d), difficulty(diff), timestamp(0) {
+    }
 
-        Activity* act = items.getAtPosition(index);
-        int match = (act != nullptr && act->getType() == type) ? 1 : 0;
+    // NEW REQUIRED virtual destructor
+    virtual ~Activity() {}
 
-        return match + countTypeRecursive(type, index + 1);
+    // ===== SETTERS =====
+    void setName(const string& n) { name = n; }
+    void setDuration(int d) { duration = d; }
+    void setDifficulty(ClimbDifficulty diff) { difficulty = diff; }
+    void setTimestamp(long long t) { timestamp = t; }
+
+    // ===== GETTERS =====
+    const string& getName() const { return name; }
+    int getDuration() const { return duration; }
+    ClimbDifficulty getDifficulty() const { return difficulty; }
+    long long getTimestamp() const { return timestamp; }
+    int getDay() const { return static_cast<int>(timestamp / SECONDS_PER_DAY); }
+
+    // session load: minutes of effort weighted by difficulty (1..4)
+    virtual double trainingLoad() const {
+        return static_cast<double>(duration) * static_cast<int>(difficulty);
     }
 
-    // Search
-    int sequentialSearchByName(const string& target) const {
-        return items.searchByName(target);
+    // NEW PURE VIRTUAL FUNCTION
+    virtual string getType() const = 0;
+
+    // keep print virtual
+    virtual void print() const {
+        cout << "Name: " << name << endl;
+        cout << "Duration: " << duration << " minutes" << endl;
+        cout << "Difficulty: " << difficultyToString(difficulty) << endl;
+    }
+    // ===== STREAM SUPPORT (for operator<< polymorphism) ===== NEW
+    virtual void toStream(ostream& os) const {
+        os << name << " | "
+            << duration << " mins | "
+            << difficultyToString(difficulty);
     }
+    virtual Activity* clone() const = 0;
 
-    // using iterator 
-    void displayAllWithIterator() const {
-        ActivityLinkedList::Iterator it = items.begin();
+    // derived classes add their own size and fields, then call this
+    virtual void addFootprint(MemoryFootprint& f) const {
+        addStringFootprint(f, name);
+    }
+};
 
-        while (it.hasCurrent()) {
-            Activity* act = it.getData();
-            if (act != nullptr) {
-                act->print();
-            }
-            it.next();
-        }
+
+
+// ==========================
+// COMPOSITION CLASS 
+// ==========================
+class Location {
+private:
+    string place;
+    bool indoor;
+
+public:
+    Location() : place(""), indoor(true) {}
+    Location(string p, bool i) : place(p), indoor(i) {}
+
+    string getPlace() const { return place; }
+    const string& getPlaceRef() const { return place; }
+    bool isIndoor() const { return indoor; }
+
+    void setPlace(string p) { place = p; }
+    void setIndoor(bool i) { indoor = i; }
+
+    // Helper method 
+    string formattedLocation() const {
+        return place + (indoor ? " (Indoor)" : " (Outdoor)");
+    }
+
+    // same text as formattedLocation, streamed without building a string
+    void writeTo(ostream& os) const {
+        os << place << (indoor ? " (Indoor)" : " (Outdoor)");
     }
 };
-/*
-    // ==========================
-    // NEW: Binary Search
-    // Vector must already be sorted
-    // ==========================
-    int binarySearchByName(const string& target) const {
-        int low = 0;
-        int high = static_cast<int>(items.size()) - 1;
 
-        while (low <= high) {
-            int mid = (low + high) / 2;
-            string midName = items.at(mid)->getName();
+// ==========================
+// DERIVED CLASS #1 
+// ==========================
+class ClimbSession : public Activity {
+private:
+    double hours;
+    Location location;
+    Grade grade;               // optional, Ungraded by default
 
-            if (midName == target) {
-                return mid;
-            }
-            else if (midName < target) {
-                low = mid + 1;
-            }
-            else {
-                high = mid - 1;
-            }
-        }
+public:
+    ClimbSession(string n, int d, ClimbDifficulty diff,
+        double h, Location loc)
+        : Activity(n, d, diff), hours(h), location(loc) {
+    }
+    // ===== OPERATOR== (identity comparison) =====
+    bool operator==(const ClimbSession& other) const {
+        return name == other.name &&
+            hours == other.hours &&
+            location.getPlace() == other.location.getPlace() &&
+            location.isIndoor() == other.location.isIndoor();
+    }
 
-        return -1;
+    // ===== STREAM OVERRIDE ===== 
+    void toStream(ostream& os) const override {
+        os << "[Climb] "
+            << name << " | "
+            << hours << " hrs | ";
+        location.writeTo(os);
+    }
+    //  PURE VIRTUAL IMPLEMENTATION
+    string getType() const override {
+        return "Climb Session";
+    }
+
+    void setHours(double h) { hours = h; }
+    void setLocation(const Location& loc) { location = loc; }
+    void setGrade(Grade g) { grade = g; }
+    Grade getGrade() const { return grade; }
+
+    double getHours() const { return hours; }
+    Location getLocation() const { return location; }
+    const Location& getLocationRef() const { return location; }
+
+    // interactive climbs only record hours, so fall back to them
+    double trainingLoad() const override {
+        double minutes = (duration > 0) ? duration : hours * 60.0;
+        return minutes * static_cast<int>(difficulty);
+    }
+
+    void print() const override {
+        Activity::print();
+        cout << "Hours Climbed: " << hours << endl;
+        cout << "Location: ";
+        location.writeTo(cout);
+        cout << endl;
+        if (grade.isValid())
+            cout << "Grade: " << grade.toString() << endl;
+    }
+    Activity* clone() const override {
+        return new ClimbSession(*this);
+    }
+
+    void addFootprint(MemoryFootprint& f) const override {
+        f.payload += sizeof(ClimbSession);
+        addStringFootprint(f, location.getPlaceRef());
+        Activity::addFootprint(f);
     }
 };
-*/
-class ClimbingTracker {
+
+
+
+
+// ==========================
+// DERIVED CLASS #2 
+// ==========================
+class TrainingSession : public Activity {
 private:
-    string climberName;
-    int totalHours;
-    int climbingDays;
-    ActivityManager manager;   // handles memory automatically
+    int reps;
 
 public:
-    // ==========================
-    // CONSTRUCTOR / DESTRUCTOR
-    // ==========================
-    ClimbingTracker() : climberName(""), totalHours(0), climbingDays(0) {}
-    ~ClimbingTracker() = default; // manager cleans up Activities automatically
+    TrainingSession(string n, int d, ClimbDifficulty diff, int r)
+        : Activity(n, d, diff), reps(r) {
+    }
 
-    // ==========================
-    // SETTERS
-    // ==========================
-    void setClimberName(const string& name) { climberName = name; }
-    void setClimbingDays(int days) { climbingDays = days; }
+    //  PURE VIRTUAL IMPLEMENTATION
+    string getType() const override {
+        return "Training Session";
+    }
+    // ===== STREAM OVERRIDE ===== 
+    void toStream(ostream& os) const override {
+        os << "[Training] "
+            << name << " | "
+            << reps << " reps";
+    }
+    void setReps(int r) { reps = r; }
+    int getReps() const { return reps; }
+
+    double trainingLoad() const override {
+        return Activity::trainingLoad() + reps * LOAD_PER_REP * static_cast<int>(difficulty);
+    }
+
+    void print() const override {
+        Activity::print();
+        cout << "Reps: " << reps << endl;
+    }
+    Activity* clone() const override {
+        return new TrainingSession(*this);
+    }
+
+    void addFootprint(MemoryFootprint& f) const override {
+        f.payload += sizeof(TrainingSession);
+        Activity::addFootprint(f);
+    }
+};
+
+// ===== GLOBAL STREAM OPERATOR =====
+ostream& operator<<(ostream& os, const Activity& a) {
+    a.toStream(os);   // polymorphic call
+    return os;
+}
+// ==========================
+// BANNER
+// ==========================
+void displayBanner() {
+    setColor(11);
+    cout << "=========================================\n";
+    cout << "        CLIMBING ACTIVITY TRACKER         \n";
+    cout << "=========================================\n";
+    setColor(7);
+}
+
+// ==========================
+// INPUT VALIDATION
+// ==========================
+int getValidatedInt(const string& prompt, int min, int max) {
+    int value;
+    do {
+        cout << prompt;
+        cin >> value;
+        if (cin.fail() || value < min || value > max) {
+            cin.clear();
+            cin.ignore(1000, '\n');
+            cout << "Invalid input. Please enter a number between "
+                << min << " and " << max << ".\n";
+        }
+    } while (value < min || value > max);
+    return value;
+}
+
+double getValidatedDouble(const string& prompt, double min, double max) {
+    double value;
+    do {
+        cout << prompt;
+        cin >> value;
+        if (cin.fail() || value < min || value > max) {
+            cin.clear();
+            cin.ignore(1000, '\n');
+            cout << "Invalid input. Please enter a value between "
+                << min << " and " << max << ".\n";
+        }
+    } while (value < min || value > max);
+    return value;
+}
+
+// ==========================
+// YES / NO VALIDATION
+// ==========================
+bool getYesNo(const string& prompt) {
+    char choice;
+    do {
+        cout << prompt << " (y/n): ";
+        cin >> choice;
+
+        if (choice == 'Y') choice = 'y';
+        if (choice == 'N') choice = 'n';
+
+    } while (choice != 'y' && choice != 'n');
+
+    return choice == 'y';
+}
+
+// ==========================
+// DIFFICULTY PROMPT
+// ==========================
+ClimbDifficulty promptDifficulty() {
+    cout << "Select Difficulty:\n";
+    cout << "1. Easy\n";
+    cout << "2. Moderate\n";
+    cout << "3. Hard\n";
+    cout << "4. Extreme\n";
+    int choice = getValidatedInt("Choice: ", 1, 4);
+    return static_cast<ClimbDifficulty>(choice);
+}
+
+// ==========================
+// CLASSIFICATION CODES
+// one byte per climber; labels are rendered from the tables below
+// ==========================
+enum ExperienceLevel : uint8_t { BEGINNER, INTERMEDIATE, ADVANCED };
+enum ClimberFrequency : uint8_t { NEW_CLIMBER, REGULAR_CLIMBER, FREQUENT_CLIMBER };
+enum DedicationRating : uint8_t { CASUAL, MODERATELY_DEDICATED, HIGHLY_DEDICATED };
+
+const double MODERATE_SESSION_HOURS = 1.0;
+
+const string_view EXPERIENCE_LABELS[] = { "Beginner", "Intermediate", "Advanced" };
+const string_view FREQUENCY_LABELS[] = { "New Climber", "Regular Climber", "Frequent Climber" };
+const string_view DEDICATION_LABELS[] = { "Casual", "Moderately Dedicated", "Highly Dedicated" };
+
+inline ExperienceLevel experienceCode(int totalHours) {
+    return static_cast<ExperienceLevel>(
+        (totalHours >= INTERMEDIATE_HOURS) + (totalHours >= ADVANCED_HOURS));
+}
+
+inline ClimberFrequency climberTypeCode(int climbingDays) {
+    return static_cast<ClimberFrequency>(
+        (climbingDays >= NEW_CLIMBER_DAYS) + (climbingDays >= FREQUENT_CLIMBER_DAYS));
+}
+
+inline DedicationRating performanceCode(double hoursPerSession) {
+    return static_cast<DedicationRating>(
+        (hoursPerSession >= MODERATE_SESSION_HOURS) + (hoursPerSession >= DEDICATED_SESSION_HOURS));
+}
+
+// ==========================
+// EXPERIENCE LEVEL
+// ==========================
+string determineExperienceLevel(int totalHours) {
+    return string(EXPERIENCE_LABELS[experienceCode(totalHours)]);
+}
+
+// ==========================
+// CLIMBING FREQUENCY
+// ==========================
+string determineClimberType(int climbingDays) {
+    return string(FREQUENCY_LABELS[climberTypeCode(climbingDays)]);
+}
+
+// ==========================
+// PERFORMANCE RATING
+// ==========================
+string performanceRating(double hoursPerSession) {
+    return string(DEDICATION_LABELS[performanceCode(hoursPerSession)]);
+}
+
+// ==========================
+// BATCH CLASSIFICATION
+// code = (value >= low) + (value >= high), 16 ints or 2 doubles per compare
+// ==========================
+inline void classifyThresholds(const int* values, uint8_t* out, size_t n, int low, int high) {
+    size_t i = 0;
+#ifdef TRACKER_HAS_SSE2
+    // v >= t  <=>  v > t - 1; each true compare is -1, so subtracting counts it
+    const __m128i lowMinusOne = _mm_set1_epi32(low - 1);
+    const __m128i highMinusOne = _mm_set1_epi32(high - 1);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i codes[4];
+        for (int k = 0; k < 4; k++) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i + 4 * k));
+            codes[k] = _mm_sub_epi32(_mm_sub_epi32(zero, _mm_cmpgt_epi32(v, lowMinusOne)),
+                _mm_cmpgt_epi32(v, highMinusOne));
+        }
+        __m128i words = _mm_packs_epi32(codes[0], codes[1]);
+        __m128i words2 = _mm_packs_epi32(codes[2], codes[3]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(words, words2));
+    }
+#endif
+    for (; i < n; i++)
+        out[i] = static_cast<uint8_t>((values[i] >= low) + (values[i] >= high));
+}
+
+inline void classifyThresholds(const double* values, uint8_t* out, size_t n, double low, double high) {
+    size_t i = 0;
+#ifdef TRACKER_HAS_SSE2
+    const __m128d lowVec = _mm_set1_pd(low);
+    const __m128d highVec = _mm_set1_pd(high);
+
+    for (; i + 2 <= n; i += 2) {
+        __m128d v = _mm_loadu_pd(values + i);
+        int lowMask = _mm_movemask_pd(_mm_cmpge_pd(v, lowVec));
+        int highMask = _mm_movemask_pd(_mm_cmpge_pd(v, highVec));
+        out[i] = static_cast<uint8_t>((lowMask & 1) + (highMask & 1));
+        out[i + 1] = static_cast<uint8_t>((lowMask >> 1) + (highMask >> 1));
+    }
+#endif
+    for (; i < n; i++)
+        out[i] = static_cast<uint8_t>((values[i] >= low) + (values[i] >= high));
+}
+
+// out[i] is an ExperienceLevel
+void classifyExperienceLevels(const int* totalHours, uint8_t* out, size_t n) {
+    classifyThresholds(totalHours, out, n, INTERMEDIATE_HOURS, ADVANCED_HOURS);
+}
+
+// out[i] is a ClimberFrequency
+void classifyClimberTypes(const int* climbingDays, uint8_t* out, size_t n) {
+    classifyThresholds(climbingDays, out, n, NEW_CLIMBER_DAYS, FREQUENT_CLIMBER_DAYS);
+}
+
+// out[i] is a DedicationRating
+void classifyPerformanceRatings(const double* hoursPerSession, uint8_t* out, size_t n) {
+    classifyThresholds(hoursPerSession, out, n, MODERATE_SESSION_HOURS, DEDICATED_SESSION_HOURS);
+}
+
+// ==========================
+// FILE SAVE (UNCHANGED)
+// ==========================
+void saveReport(const string& filename, const string& report) {
+    ofstream outFile(filename);
+    if (outFile) {
+        outFile << report;
+        outFile.close();
+        cout << "Report saved to " << filename << endl;
+    }
+    else {
+        cout << "Error saving report.\n";
+    }
+}
+
+// ==========================
+// FILE LOAD 
+// ==========================
+string loadReport(const string& filename) {
+    TRACK_OP(TrackedOp::LOAD);
+    ifstream inFile(filename);
+    string content, line;
+    if (inFile) {
+        while (getline(inFile, line)) {
+            content += line + "\n";
+        }
+        inFile.close();
+    }
+    return content;
+}
+// ===== DYNAMIC ARRAY TEMPLATE (FINAL - NO LEAKS, NO SHALLOW COPIES) =====
+template <typename T>
+class DynamicArray {
+private:
+    T* arr;
+    int capacity;
+    int size;
+
+    // resize helper
+    void resize(int newCapacity) {
+        T* newArr = new T[newCapacity];
+
+        for (int i = 0; i < size; i++)
+            newArr[i] = arr[i];
+
+        delete[] arr;
+        arr = newArr;
+        capacity = newCapacity;
+    }
+
+public:
+    // ==========================
+    // CONSTRUCTOR
+    // ==========================
+    DynamicArray(int cap = 5)
+        : capacity(cap), size(0) {
+        arr = new T[capacity];
+    }
+
+    // ==========================
+    // 🚫 DISABLE COPYING
+    // ==========================
+    // Prevents shallow copy of pointers (CRITICAL for your assignment)
+    DynamicArray(const DynamicArray&) = delete;
+    DynamicArray& operator=(const DynamicArray&) = delete;
+
+    // ==========================
+    // DESTRUCTOR
+    // ==========================
+    ~DynamicArray() {
+        delete[] arr;
+    }
+
+    // ==========================
+    // ADD ELEMENT
+    // ==========================
+    void add(const T& value) {
+        if (size == capacity)
+            resize(capacity * 2);
+
+        arr[size++] = value;
+    }
+
+    // ==========================
+    // REMOVE ELEMENT
+    // ==========================
+    void remove(int index) {
+        if (index < 0 || index >= size) {
+            throw IndexOutOfRange("DynamicArray::remove - index out of range");
+        }
+
+        for (int i = index; i < size - 1; i++)
+            arr[i] = arr[i + 1];
+
+        size--;
+    }
+
+    // ==========================
+    // INDEXING
+    // ==========================
+    T& operator[](int index) {
+        if (index < 0 || index >= size) {
+            throw IndexOutOfRange("DynamicArray::operator[] - index out of range");
+        }
+        return arr[index];
+    }
+
+    const T& operator[](int index) const {
+        if (index < 0 || index >= size) {
+            throw IndexOutOfRange("DynamicArray::operator[] const - index out of range");
+        }
+        return arr[index];
+    }
+    // ==========================
+    // SIZE ACCESSOR
+    // ==========================
+    int getSize() const {
+        return size;
+    }
+
+    // the element array only; what elements point to is not followed
+    MemoryFootprint footprint() const {
+        MemoryFootprint f;
+        f.payload = sizeof(*this) + static_cast<size_t>(size) * sizeof(T);
+        f.slack = static_cast<size_t>(capacity - size) * sizeof(T);
+        return f;
+    }
+};
+// ==========================
+// LINKED LIST ADT
+// Unordered singly linked list
+// ==========================
+class ActivityLinkedList {
+private:
+    struct Node {
+        Activity* data;
+        Node* next;
+
+        Node(Activity* d, Node* n = nullptr)
+            : data(d), next(n) {
+        }
+    };
+
+    Node* head;
+    Node* tail;
+    int size;
+
+public:
+    // ==========================
+    // ITERATOR CLASS
+    // ==========================
+    class Iterator {
+    private:
+        Node* current;
+
+    public:
+        Iterator(Node* start) : current(start) {}
+
+        bool hasCurrent() const {
+            return current != nullptr;
+        }
+
+        void next() {
+            if (current != nullptr) {
+                current = current->next;
+            }
+        }
+
+        Activity* getData() const {
+            if (current == nullptr) {
+                return nullptr;
+            }
+            return current->data;
+        }
+    };
+
+    // ==========================
+    // CONSTRUCTOR
+    // ==========================
+    ActivityLinkedList() : head(nullptr), tail(nullptr), size(0) {}
+
+    // ==========================
+    // COPY CONSTRUCTOR
+    // deep copy
+    // ==========================
+    ActivityLinkedList(const ActivityLinkedList& other)
+        : head(nullptr), tail(nullptr), size(0) {
+        Node* current = other.head;
+        while (current != nullptr) {
+            insertBack(current->data->clone());
+            current = current->next;
+        }
+    }
+
+    // ==========================
+    // COPY ASSIGNMENT
+    // deep copy
+    // ==========================
+    ActivityLinkedList& operator=(const ActivityLinkedList& other) {
+        if (this != &other) {
+            clear();
+            Node* current = other.head;
+            while (current != nullptr) {
+                insertBack(current->data->clone());
+                current = current->next;
+            }
+        }
+        return *this;
+    }
+
+    // ==========================
+    // DESTRUCTOR
+    // ==========================
+    ~ActivityLinkedList() {
+        clear();
+    }
+
+    // ==========================
+    // INSERT FRONT
+    // ==========================
+    void insertFront(Activity* act) {
+        Node* newNode = new Node(act, head);
+        head = newNode;
+
+        if (tail == nullptr) {
+            tail = newNode;
+        }
+
+        size++;
+    }
+
+    // ==========================
+    // INSERT BACK
+    // ==========================
+    void insertBack(Activity* act) {
+        Node* newNode = new Node(act);
+
+        if (head == nullptr) {
+            head = tail = newNode;
+        }
+        else {
+            tail->next = newNode;
+            tail = newNode;
+        }
+
+        size++;
+    }
+
+    // ==========================
+    // DELETE AT POSITION
+    // returns true if removed
+    // ==========================
+    bool deleteAtPosition(int index) {
+        if (index < 0 || index >= size) {
+            return false;
+        }
+
+        Node* toDelete = nullptr;
+
+        if (index == 0) {
+            toDelete = head;
+            head = head->next;
+
+            if (head == nullptr) {
+                tail = nullptr;
+            }
+        }
+        else {
+            Node* prev = head;
+            for (int i = 0; i < index - 1; i++) {
+                prev = prev->next;
+            }
+
+            toDelete = prev->next;
+            prev->next = toDelete->next;
+
+            if (toDelete == tail) {
+                tail = prev;
+            }
+        }
+
+        delete toDelete->data;
+        delete toDelete;
+        size--;
+        return true;
+    }
+
+    // ==========================
+    // SEARCH BY NAME
+    // returns index or -1
+    // ==========================
+    int searchByName(const string& target) const {
+        Node* current = head;
+        int index = 0;
+
+        while (current != nullptr) {
+            if (current->data != nullptr && current->data->getName() == target) {
+                return index;
+            }
+            current = current->next;
+            index++;
+        }
+
+        return -1;
+    }
+
+    // ==========================
+    // GET AT POSITION
+    // ==========================
+    Activity* getAtPosition(int index) const {
+        if (index < 0 || index >= size) {
+            return nullptr;
+        }
+
+        Node* current = head;
+        for (int i = 0; i < index; i++) {
+            current = current->next;
+        }
+
+        return current->data;
+    }
+
+    // ==========================
+    // PRINT/TRAVERSE
+    // uses iterator
+    // ==========================
+    void printList() const {
+        Iterator it(head);
+
+        while (it.hasCurrent()) {
+            Activity* act = it.getData();
+            if (act != nullptr) {
+                act->print();
+            }
+            it.next();
+        }
+    }
+
+    // ==========================
+    // CLEAR
+    // ==========================
+    void clear() {
+        Node* current = head;
+
+        while (current != nullptr) {
+            Node* temp = current;
+            current = current->next;
+
+            delete temp->data;
+            delete temp;
+        }
+
+        head = nullptr;
+        tail = nullptr;
+        size = 0;
+    }
+
+    // ==========================
+    // SIZE
+    // ==========================
+    int getSize() const {
+        return size;
+    }
+
+    // nodes plus the activities they own
+    void addFootprint(MemoryFootprint& f) const {
+        f.nodes += static_cast<size_t>(size) * sizeof(Node);
+        for (Node* n = head; n != nullptr; n = n->next)
+            if (n->data != nullptr) n->data->addFootprint(f);
+    }
+
+    // ==========================
+    // BEGIN ITERATOR
+    // ==========================
+    Iterator begin() const {
+        return Iterator(head);
+    }
+};
+
+// ==========================
+// BIT HELPERS
+// ==========================
+inline int popCount64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<int>((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// x must be non-zero
+inline int trailingZeros64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while ((x & 1) == 0) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// ==========================
+// ACTIVITY BITMAP
+// one bit per activity row, combined a 64-bit word at a time
+// ==========================
+class ActivityBitmap {
+private:
+    vector<uint64_t> words;
+    int bitCount;
+
+    // keep bits past the end at zero so count() and ~ stay exact
+    void clearTail() {
+        int extra = bitCount % 64;
+        if (extra != 0) {
+            words.back() &= (uint64_t(1) << extra) - 1;
+        }
+    }
+
+public:
+    explicit ActivityBitmap(int bits = 0)
+        : words((bits + 63) / 64, 0), bitCount(bits) {
+    }
+
+    int getSize() const { return bitCount; }
+
+    void addFootprint(MemoryFootprint& f) const { addVectorFootprint(f, words, &MemoryFootprint::auxiliary); }
+
+    bool test(int i) const {
+        return (words[i >> 6] >> (i & 63)) & 1;
+    }
+
+    void set(int i) {
+        words[i >> 6] |= uint64_t(1) << (i & 63);
+    }
+
+    void reset(int i) {
+        words[i >> 6] &= ~(uint64_t(1) << (i & 63));
+    }
+
+    // grow (new rows are 0) or shrink to the given number of rows
+    void resize(int bits) {
+        words.resize((bits + 63) / 64, 0);
+        bitCount = bits;
+        clearTail();
+    }
+
+    // ==========================
+    // INSERT ROW
+    // rows at or after i move up by one
+    // ==========================
+    void insert(int i, bool value) {
+        if (bitCount % 64 == 0) {
+            words.push_back(0);
+        }
+
+        size_t w = static_cast<size_t>(i >> 6);
+        int b = i & 63;
+
+        for (size_t k = words.size() - 1; k > w; k--) {
+            words[k] = (words[k] << 1) | (words[k - 1] >> 63);
+        }
+
+        uint64_t lowMask = (uint64_t(1) << b) - 1;
+        uint64_t low = words[w] & lowMask;
+        uint64_t high = (words[w] & ~lowMask) << 1;
+        words[w] = low | high | (uint64_t(value ? 1 : 0) << b);
+
+        bitCount++;
+    }
+
+    // ==========================
+    // ERASE ROW
+    // rows after i move down by one
+    // ==========================
+    void erase(int i) {
+        size_t w = static_cast<size_t>(i >> 6);
+        int b = i & 63;
+
+        uint64_t low = words[w] & ((uint64_t(1) << b) - 1);
+        uint64_t high = (b == 63) ? 0 : (words[w] >> (b + 1)) << b;
+        words[w] = low | high;
+
+        for (size_t k = w + 1; k < words.size(); k++) {
+            words[k - 1] |= words[k] << 63;
+            words[k] >>= 1;
+        }
+
+        bitCount--;
+        if (bitCount % 64 == 0) {
+            words.pop_back();
+        }
+    }
+
+    // ==========================
+    // WORD-LEVEL SET OPERATIONS
+    // ==========================
+    ActivityBitmap& operator&=(const ActivityBitmap& other) {
+        for (size_t k = 0; k < words.size(); k++)
+            words[k] &= (k < other.words.size()) ? other.words[k] : 0;
+        return *this;
+    }
+
+    ActivityBitmap& operator|=(const ActivityBitmap& other) {
+        for (size_t k = 0; k < words.size() && k < other.words.size(); k++)
+            words[k] |= other.words[k];
+        return *this;
+    }
+
+    // remove every row set in other
+    ActivityBitmap& andNot(const ActivityBitmap& other) {
+        for (size_t k = 0; k < words.size() && k < other.words.size(); k++)
+            words[k] &= ~other.words[k];
+        return *this;
+    }
+
+    ActivityBitmap operator~() const {
+        ActivityBitmap result(*this);
+        for (uint64_t& word : result.words)
+            word = ~word;
+        result.clearTail();
+        return result;
+    }
+
+    friend ActivityBitmap operator&(ActivityBitmap a, const ActivityBitmap& b) { return a &= b; }
+    friend ActivityBitmap operator|(ActivityBitmap a, const ActivityBitmap& b) { return a |= b; }
+
+    int count() const {
+        int total = 0;
+        for (uint64_t word : words)
+            total += popCount64(word);
+        return total;
+    }
+
+    bool any() const {
+        for (uint64_t word : words)
+            if (word != 0) return true;
+        return false;
+    }
+
+    // visits set rows in ascending order
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        for (size_t k = 0; k < words.size(); k++) {
+            uint64_t word = words[k];
+            while (word != 0) {
+                visit(static_cast<int>(k * 64) + trailingZeros64(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+    vector<int> toIndices() const {
+        vector<int> result;
+        result.reserve(count());
+        forEach([&result](int row) { result.push_back(row); });
+        return result;
+    }
+};
+
+// ==========================
+// PLACE DICTIONARY
+// interns place names to small integer ids
+// ==========================
+class PlaceDictionary {
+private:
+    unordered_map<string, int> ids;
+    vector<string> names;
+
+public:
+    int intern(const string& place) {
+        auto found = ids.find(place);
+        if (found != ids.end()) {
+            return found->second;
+        }
+        int id = static_cast<int>(names.size());
+        ids.emplace(place, id);
+        names.push_back(place);
+        return id;
+    }
+
+    // returns id or -1
+    int find(const string& place) const {
+        auto found = ids.find(place);
+        return (found == ids.end()) ? -1 : found->second;
+    }
+
+    const string& nameOf(int id) const { return names.at(id); }
+
+    int getSize() const { return static_cast<int>(names.size()); }
+
+    void clear() {
+        ids.clear();
+        names.clear();
+    }
+
+    // hash nodes are estimated as next pointer + cached hash + entry
+    void addFootprint(MemoryFootprint& f) const {
+        addVectorFootprint(f, names, &MemoryFootprint::auxiliary);
+        f.nodes += ids.size() * (sizeof(void*) + sizeof(size_t) + sizeof(pair<const string, int>))
+            + ids.bucket_count() * sizeof(void*);
+        for (const string& name : names) {
+            addStringFootprint(f, name);   // once in names, once as the map key
+            addStringFootprint(f, name);
+        }
+    }
+};
+
+// ==========================
+// ACTIVITY INDEX
+// per-attribute bitmaps kept in step with the manager's row order
+// ==========================
+class ActivityIndex {
+public:
+    // whole-hour buckets: [0,1), [1,2) ... [23,24), [24, +inf)
+    static const int HOUR_BUCKETS = 25;
+
+private:
+    vector<Activity*> rows;
+    vector<double> hoursColumn;          // -1 for activities without hours
+
+    ActivityBitmap difficultyRows[EXTREME];
+    ActivityBitmap indoorRows;
+    ActivityBitmap outdoorRows;
+    ActivityBitmap climbRows;
+    ActivityBitmap trainingRows;
+    ActivityBitmap hourRows[HOUR_BUCKETS];
+    vector<ActivityBitmap> placeRows;    // grown lazily, see whereLocation
+    PlaceDictionary places;
+
+    static int hourBucket(double h) {
+        if (h >= HOUR_BUCKETS - 1) return HOUR_BUCKETS - 1;
+        return static_cast<int>(h);
+    }
+
+    ActivityBitmap padded(const ActivityBitmap& bits) const {
+        ActivityBitmap result(bits);
+        result.resize(getSize());
+        return result;
+    }
+
+public:
+    int getSize() const { return static_cast<int>(rows.size()); }
+
+    Activity* row(int i) const { return rows[i]; }
+    double hoursAt(int i) const { return hoursColumn[i]; }
+
+    // ==========================
+    // INSERT ROW
+    // ==========================
+    void insertRow(int pos, Activity* act) {
+        ClimbDifficulty diff = act->getDifficulty();
+        const ClimbSession* climb = dynamic_cast<const ClimbSession*>(act);
+
+        double hours = -1.0;
+        int placeId = -1;
+        bool indoor = false;
+        if (climb != nullptr) {
+            hours = climb->getHours();
+            Location loc = climb->getLocation();
+            placeId = places.intern(loc.getPlace());
+            indoor = loc.isIndoor();
+        }
+
+        rows.insert(rows.begin() + pos, act);
+        hoursColumn.insert(hoursColumn.begin() + pos, hours);
+
+        for (int d = EASY; d <= EXTREME; d++)
+            difficultyRows[d - 1].insert(pos, diff == d);
+
+        indoorRows.insert(pos, climb != nullptr && indoor);
+        outdoorRows.insert(pos, climb != nullptr && !indoor);
+        climbRows.insert(pos, climb != nullptr);
+        trainingRows.insert(pos, dynamic_cast<const TrainingSession*>(act) != nullptr);
+
+        int bucket = (climb != nullptr) ? hourBucket(hours) : -1;
+        for (int b = 0; b < HOUR_BUCKETS; b++)
+            hourRows[b].insert(pos, b == bucket);
+
+        // place bitmaps only cover rows up to their last set bit
+        if (placeId >= static_cast<int>(placeRows.size()))
+            placeRows.resize(placeId + 1);
+        for (ActivityBitmap& bits : placeRows) {
+            if (pos < bits.getSize())
+                bits.insert(pos, false);
+        }
+        if (placeId >= 0) {
+            ActivityBitmap& own = placeRows[placeId];
+            if (own.getSize() <= pos)
+                own.resize(pos + 1);
+            own.set(pos);
+        }
+    }
+
+    // ==========================
+    // ERASE ROW
+    // ==========================
+    void eraseRow(int pos) {
+        rows.erase(rows.begin() + pos);
+        hoursColumn.erase(hoursColumn.begin() + pos);
+
+        for (ActivityBitmap& bits : difficultyRows) bits.erase(pos);
+        indoorRows.erase(pos);
+        outdoorRows.erase(pos);
+        climbRows.erase(pos);
+        trainingRows.erase(pos);
+        for (ActivityBitmap& bits : hourRows) bits.erase(pos);
+
+        for (ActivityBitmap& bits : placeRows) {
+            if (pos < bits.getSize())
+                bits.erase(pos);
+        }
+    }
+
+    void clear() {
+        rows.clear();
+        hoursColumn.clear();
+        for (ActivityBitmap& bits : difficultyRows) bits = ActivityBitmap();
+        indoorRows = outdoorRows = climbRows = trainingRows = ActivityBitmap();
+        for (ActivityBitmap& bits : hourRows) bits = ActivityBitmap();
+        placeRows.clear();
+        places.clear();
+    }
+
+    void addFootprint(MemoryFootprint& f) const {
+        addVectorFootprint(f, rows, &MemoryFootprint::auxiliary);
+        addVectorFootprint(f, hoursColumn, &MemoryFootprint::auxiliary);
+        for (const ActivityBitmap& bits : difficultyRows) bits.addFootprint(f);
+        indoorRows.addFootprint(f);
+        outdoorRows.addFootprint(f);
+        climbRows.addFootprint(f);
+        trainingRows.addFootprint(f);
+        for (const ActivityBitmap& bits : hourRows) bits.addFootprint(f);
+        addVectorFootprint(f, placeRows, &MemoryFootprint::auxiliary);
+        for (const ActivityBitmap& bits : placeRows) bits.addFootprint(f);
+        places.addFootprint(f);
+    }
+
+    // ==========================
+    // PREDICATES
+    // ==========================
+    ActivityBitmap all() const { return ~ActivityBitmap(getSize()); }
+
+    ActivityBitmap whereDifficulty(ClimbDifficulty d) const {
+        if (d < EASY || d > EXTREME) return ActivityBitmap(getSize());
+        return difficultyRows[d - 1];
+    }
+
+    ActivityBitmap whereIndoor(bool indoor) const {
+        return indoor ? indoorRows : outdoorRows;
+    }
+
+    // type names match Activity::getType()
+    ActivityBitmap whereType(const string& type) const {
+        if (type == "Climb Session") return climbRows;
+        if (type == "Training Session") return trainingRows;
+        return ActivityBitmap(getSize());
+    }
+
+    ActivityBitmap whereLocation(const string& place) const {
+        int id = places.find(place);
+        if (id < 0 || id >= static_cast<int>(placeRows.size()))
+            return ActivityBitmap(getSize());
+        return padded(placeRows[id]);
+    }
+
+    // climbs with lo <= hours <= hi; only the two edge buckets are checked row by row
+    ActivityBitmap whereHoursBetween(double lo, double hi) const {
+        ActivityBitmap result(getSize());
+        if (lo > hi) return result;
+
+        int first = hourBucket(lo < 0 ? 0 : lo);
+        int last = hourBucket(hi < 0 ? 0 : hi);
+
+        for (int b = first + 1; b < last; b++)
+            result |= hourRows[b];
+
+        for (int b : { first, last }) {
+            hourRows[b].forEach([&](int r) {
+                double h = hoursColumn[r];
+                if (h >= lo && h <= hi) result.set(r);
+            });
+        }
+        return result;
+    }
+
+    vector<const Activity*> select(const ActivityBitmap& bits) const {
+        vector<const Activity*> result;
+        result.reserve(bits.count());
+        bits.forEach([&](int r) {
+            if (r < getSize()) result.push_back(rows[r]);
+        });
+        return result;
+    }
+};
+
+// ==========================
+// ACTIVITY EVENT BUS
+// One producer (the thread that owns the ActivityManager) appends
+// events to a ring; every subscriber has its own cursor and receives
+// contiguous batches. Inline subscribers are drained on the producer
+// thread (every BATCH events and on flush()); other subscribers are
+// drained by their own thread through poll(). When the ring is full the
+// producer drains inline subscribers and waits for the slowest poller;
+// a poller that holds it up past the stall timeout without polling is
+// detached. The ring starts at BATCH slots, all inline subscribers ever
+// need, and grows to the full capacity when a poller subscribes.
+// subscribe/unsubscribe must not race with publishing.
+// ==========================
+enum class ActivityKind : uint8_t { OTHER, CLIMB, TRAINING };
+enum class ActivityEventType : uint8_t { ADDED, REMOVED, UPDATED, CLEARED };
+
+// value copy of an activity, so events outlive the activity itself
+struct ActivityRecord {
+    ActivityKind kind = ActivityKind::OTHER;
+    string name;
+    string place;
+    bool indoor = false;
+    double hours = 0.0;
+    int duration = 0;
+    int reps = 0;
+    ClimbDifficulty difficulty = EASY;
+    Grade grade;
+    long long timestamp = 0;
+    double load = 0.0;          // Activity::trainingLoad() at the time
+
+    int day() const { return static_cast<int>(timestamp / SECONDS_PER_DAY); }
+
+    // reuses the string buffers of the ring slot
+    void assign(const Activity& act) {
+        kind = ActivityKind::OTHER;
+        name = act.getName();
+        place.clear();
+        indoor = false;
+        hours = 0.0;
+        reps = 0;
+        grade = Grade();
+        duration = act.getDuration();
+        difficulty = act.getDifficulty();
+        timestamp = act.getTimestamp();
+        load = act.trainingLoad();
+
+        if (const ClimbSession* cs = dynamic_cast<const ClimbSession*>(&act)) {
+            kind = ActivityKind::CLIMB;
+            Location loc = cs->getLocation();
+            place = loc.getPlace();
+            indoor = loc.isIndoor();
+            hours = cs->getHours();
+            grade = cs->getGrade();
+        }
+        else if (const TrainingSession* ts = dynamic_cast<const TrainingSession*>(&act)) {
+            kind = ActivityKind::TRAINING;
+            reps = ts->getReps();
+        }
+    }
+};
+
+struct ActivityEvent {
+    ActivityEventType type = ActivityEventType::ADDED;
+    uint64_t sequence = 0;
+    int position = -1;          // list position when the change happened
+    ActivityRecord activity;    // the new value; the removed value for REMOVED
+    ActivityRecord previous;    // UPDATED only
+};
+
+class EventSubscriber {
+public:
+    virtual ~EventSubscriber() {}
+    virtual void onEvents(const ActivityEvent* events, size_t count) = 0;
+};
+
+class ActivityEventBus {
+public:
+    static constexpr int MAX_SUBSCRIBERS = 16;
+    static constexpr int BATCH = 64;
+
+private:
+    enum : int { FREE, ACTIVE, POLLING, DETACHED };
+
+    struct alignas(64) Subscription {
+        atomic<uint64_t> cursor{ 0 };
+        EventSubscriber* target = nullptr;
+        bool inlineDrain = false;
+        atomic<int> state{ FREE };      // POLLING while its thread is inside poll()
+
+        bool live() const {
+            int st = state.load(memory_order_acquire);
+            return st == ACTIVE || st == POLLING;
+        }
+    };
+
+    vector<ActivityEvent> ring;
+    uint64_t mask;
+    size_t capacity;                          // ring size once a poller subscribes
+    chrono::milliseconds stallTimeout{ 1000 };
+    alignas(64) atomic<uint64_t> head{ 0 };   // next sequence to publish
+    Subscription subs[MAX_SUBSCRIBERS];
+
+    static size_t roundUp(size_t n) {
+        size_t size = 16;
+        while (size < n) size *= 2;
+        return size;
+    }
+
+    uint64_t slowestCursor() const {
+        uint64_t end = head.load(memory_order_relaxed);
+        uint64_t slowest = end;
+        for (const Subscription& sub : subs) {
+            if (!sub.live()) continue;
+            uint64_t c = sub.cursor.load(memory_order_acquire);
+            if (c < slowest) slowest = c;
+        }
+        return slowest;
+    }
+
+    // hands [cursor, end) to the subscriber in at most two contiguous runs
+    size_t drain(Subscription& sub, uint64_t end) {
+        uint64_t from = sub.cursor.load(memory_order_relaxed);
+        size_t total = static_cast<size_t>(end - from);
+        while (from < end) {
+            size_t offset = static_cast<size_t>(from & mask);
+            size_t run = static_cast<size_t>(end - from);
+            if (run > ring.size() - offset) run = ring.size() - offset;
+            sub.target->onEvents(&ring[offset], run);
+            from += run;
+            sub.cursor.store(from, memory_order_release);
+        }
+        return total;
+    }
+
+    void drainInline(uint64_t end) {
+        for (Subscription& sub : subs) {
+            if (sub.inlineDrain && sub.state.load(memory_order_relaxed) == ACTIVE)
+                drain(sub, end);
+        }
+    }
+
+    // pollers that are a full ring behind and not inside poll() right now
+    void detachStalled(uint64_t seq) {
+        for (Subscription& sub : subs) {
+            if (sub.inlineDrain || seq - sub.cursor.load(memory_order_acquire) < ring.size()) continue;
+            int expected = ACTIVE;
+            sub.state.compare_exchange_strong(expected, DETACHED, memory_order_acq_rel);
+        }
+    }
+
+    // only from subscribe(), which never races with publishing or polling
+    void grow(size_t size) {
+        if (size <= ring.size()) return;
+        vector<ActivityEvent> larger(size);
+        uint64_t end = head.load(memory_order_relaxed);
+        for (uint64_t seq = slowestCursor(); seq < end; seq++)
+            larger[static_cast<size_t>(seq & (size - 1))] = std::move(ring[static_cast<size_t>(seq & mask)]);
+        ring.swap(larger);
+        mask = size - 1;
+    }
+
+public:
+    explicit ActivityEventBus(int capacity = 1024) : capacity(roundUp(static_cast<size_t>(max(capacity, 1)))) {
+        ring.resize(min(this->capacity, static_cast<size_t>(BATCH)));
+        mask = ring.size() - 1;
+    }
+
+    ActivityEventBus(const ActivityEventBus&) = delete;
+    ActivityEventBus& operator=(const ActivityEventBus&) = delete;
+
+    // returns the subscription id; the subscriber sees events published from now on
+    int subscribe(EventSubscriber* target, bool inlineDrain = true) {
+        for (int i = 0; i < MAX_SUBSCRIBERS; i++) {
+            if (subs[i].state.load() != FREE) continue;
+            if (!inlineDrain) grow(capacity);
+            subs[i].target = target;
+            subs[i].inlineDrain = inlineDrain;
+            subs[i].cursor.store(head.load());
+            subs[i].state.store(ACTIVE);
+            return i;
+        }
+        throw runtime_error("ActivityEventBus - too many subscribers");
+    }
+
+    void unsubscribe(int id) {
+        if (id >= 0 && id < MAX_SUBSCRIBERS) subs[id].state.store(FREE);
+    }
+
+    // false once the subscriber was detached for stalling the producer;
+    // it gets no more events and should unsubscribe
+    bool attached(int id) const { return subs[id].live(); }
+
+    void setStallTimeout(chrono::milliseconds timeout) { stallTimeout = timeout; }
+
+    // producer side: fill the returned slot, then commit()
+    ActivityEvent& claim() {
+        uint64_t seq = head.load(memory_order_relaxed);
+        chrono::steady_clock::time_point deadline{};
+        while (seq - slowestCursor() >= ring.size()) {
+            drainInline(seq);
+            if (seq - slowestCursor() < ring.size()) break;
+            auto now = chrono::steady_clock::now();
+            if (deadline == chrono::steady_clock::time_point{}) {
+                deadline = now + stallTimeout;
+            }
+            else if (now >= deadline) {
+                detachStalled(seq);
+                deadline = now + stallTimeout;
+            }
+            this_thread::yield();
+        }
+        ActivityEvent& event = ring[static_cast<size_t>(seq & mask)];
+        event.sequence = seq;
+        return event;
+    }
+
+    void commit() {
+        uint64_t end = head.load(memory_order_relaxed) + 1;
+        head.store(end, memory_order_release);
+        if (end % BATCH == 0) drainInline(end);
+    }
+
+    // producer side: deliver everything pending to inline subscribers
+    void flush() { drainInline(head.load(memory_order_relaxed)); }
+
+    // consumer side, from the subscriber's own thread; returns events
+    // delivered, 0 once detached
+    size_t poll(int id, size_t maxEvents = SIZE_MAX) {
+        Subscription& sub = subs[id];
+        int expected = ACTIVE;
+        if (!sub.state.compare_exchange_strong(expected, POLLING, memory_order_acq_rel)) return 0;
+        uint64_t end = head.load(memory_order_acquire);
+        uint64_t from = sub.cursor.load(memory_order_relaxed);
+        if (end - from > maxEvents) end = from + maxEvents;
+        size_t delivered = drain(sub, end);
+        sub.state.store(ACTIVE, memory_order_release);
+        return delivered;
+    }
+
+    uint64_t published() const { return head.load(); }
+
+    // ring slots, plus the string buffers they keep for reuse
+    void addFootprint(MemoryFootprint& f) const {
+        addVectorFootprint(f, ring, &MemoryFootprint::auxiliary);
+        for (const ActivityEvent& e : ring) {
+            addStringFootprint(f, e.activity.name);
+            addStringFootprint(f, e.activity.place);
+            addStringFootprint(f, e.previous.name);
+            addStringFootprint(f, e.previous.place);
+        }
+    }
+
+    uint64_t pending(int id) const {
+        return head.load() - subs[id].cursor.load();
+    }
+
+    size_t ringSize() const { return ring.size(); }
+};
+
+// ==========================
+// PARALLEL MERGE SORT
+// stable sort of an index permutation: each thread stable-sorts one
+// chunk, then pairs of sorted runs are merged in parallel passes
+// ==========================
+const size_t PARALLEL_SORT_GRAIN = 1 << 14;   // smallest chunk worth a thread
+
+template <typename Task>
+void runParallel(size_t count, Task task) {
+    vector<thread> helpers;
+    helpers.reserve(count > 0 ? count - 1 : 0);
+    for (size_t i = 1; i < count; i++)
+        helpers.emplace_back(task, i);
+    if (count > 0) task(static_cast<size_t>(0));
+    for (thread& t : helpers) t.join();
+}
+
+template <typename Less>
+void parallelMergeSort(vector<int>& order, Less less, unsigned threads = thread::hardware_concurrency()) {
+    TRACE_SPAN("sort");
+    size_t n = order.size();
+    size_t chunks = 1;
+    while (chunks * 2 <= threads && n / (chunks * 2) >= PARALLEL_SORT_GRAIN)
+        chunks *= 2;
+    if (chunks == 1) {
+        stable_sort(order.begin(), order.end(), less);
+        return;
+    }
+
+    vector<size_t> bounds(chunks + 1);
+    for (size_t i = 0; i <= chunks; i++)
+        bounds[i] = n * i / chunks;
+
+    runParallel(chunks, [&](size_t c) {
+        TRACE_SPAN("sort chunk");
+        stable_sort(order.begin() + bounds[c], order.begin() + bounds[c + 1], less);
+    });
+
+    vector<int> buffer(n);
+    for (size_t width = 1; width < chunks; width *= 2) {
+        runParallel(chunks / (width * 2), [&](size_t pair) {
+            TRACE_SPAN("sort merge");
+            size_t lo = bounds[pair * width * 2];
+            size_t mid = bounds[pair * width * 2 + width];
+            size_t hi = bounds[pair * width * 2 + width * 2];
+            merge(order.begin() + lo, order.begin() + mid, order.begin() + mid, order.begin() + hi,
+                buffer.begin() + lo, less);
+        });
+        order.swap(buffer);
+    }
+}
+
+enum class SortKey : uint8_t { NAME, HOURS, DIFFICULTY, TIMESTAMP };
+const int SORT_KEY_COUNT = 4;
+
+// ==========================
+// MANAGER CLASS
+// now uses custom linked list ADT
+// ==========================
+class ActivityManager {
+private:
+    ActivityLinkedList items;
+    ActivityIndex filterIndex; // filter bitmaps, same row order as items
+    ActivityEventBus* events = nullptr;   // not owned, not copied
+
+    // ordered views: list positions sorted by key, rebuilt on demand
+    // after any mutation (not safe for concurrent const callers)
+    uint64_t generation = 1;
+    mutable vector<int> orderCache[SORT_KEY_COUNT];
+    mutable uint64_t orderBuiltAt[SORT_KEY_COUNT] = { 0, 0, 0, 0 };
+
+    void changed() { generation++; }
+
+    // Refresh the filter index after the activity at position was edited in place
+    void reindex(int position, Activity* act) {
+        filterIndex.eraseRow(position);
+        filterIndex.insertRow(position, act);
+        changed();
+    }
+
+    void buildOrder(SortKey key, vector<int>& order) const {
+        int n = filterIndex.getSize();
+        order.resize(n);
+        for (int i = 0; i < n; i++) order[i] = i;
+
+        // compare copied key columns rather than chasing Activity pointers
+        switch (key) {
+        case SortKey::NAME: {
+            vector<const string*> names(n);
+            for (int i = 0; i < n; i++) names[i] = &filterIndex.row(i)->getName();
+            parallelMergeSort(order, [&names](int a, int b) { return *names[a] < *names[b]; });
+            break;
+        }
+        case SortKey::HOURS: {
+            vector<double> hours(n);
+            for (int i = 0; i < n; i++) hours[i] = filterIndex.hoursAt(i);
+            parallelMergeSort(order, [&hours](int a, int b) { return hours[a] < hours[b]; });
+            break;
+        }
+        case SortKey::DIFFICULTY: {
+            vector<uint8_t> diff(n);
+            for (int i = 0; i < n; i++) diff[i] = static_cast<uint8_t>(filterIndex.row(i)->getDifficulty());
+            parallelMergeSort(order, [&diff](int a, int b) { return diff[a] < diff[b]; });
+            break;
+        }
+        case SortKey::TIMESTAMP: {
+            vector<long long> stamps(n);
+            for (int i = 0; i < n; i++) stamps[i] = filterIndex.row(i)->getTimestamp();
+            parallelMergeSort(order, [&stamps](int a, int b) { return stamps[a] < stamps[b]; });
+            break;
+        }
+        }
+    }
+
+    void publish(ActivityEventType type, int position, const Activity* act) {
+        if (events == nullptr) return;
+        ActivityEvent& e = events->claim();
+        e.type = type;
+        e.position = position;
+        if (act != nullptr) e.activity.assign(*act);
+        events->commit();
+    }
+
+    void rebuildIndex() {
+        filterIndex.clear();
+        ActivityLinkedList::Iterator it = items.begin();
+        while (it.hasCurrent()) {
+            filterIndex.insertRow(filterIndex.getSize(), it.getData());
+            it.next();
+        }
+    }
+
+public:
+    // Constructor
+    ActivityManager() = default;
+
+    // Copy constructor
+    ActivityManager(const ActivityManager& other)
+        : items(other.items) {
+        rebuildIndex();
+    }
+
+    // Copy assignment
+    ActivityManager& operator=(const ActivityManager& other) {
+        if (this != &other) {
+            items = other.items;
+            rebuildIndex();
+            changed();
+            publish(ActivityEventType::CLEARED, -1, nullptr);
+            for (int i = 0; events != nullptr && i < filterIndex.getSize(); i++)
+                publish(ActivityEventType::ADDED, i, filterIndex.row(i));
+        }
+        return *this;
+    }
+
+    // Destructor
+    ~ActivityManager() = default;
+
+    // Publish every later change to bus (nullptr detaches)
+    void attachEventBus(ActivityEventBus* bus) { events = bus; }
+
+    // Add activity at back
+    void add(Activity* act) {
+        TRACK_OP(TrackedOp::ADD);
+        items.insertBack(act);
+        filterIndex.insertRow(filterIndex.getSize(), act);
+        changed();
+        publish(ActivityEventType::ADDED, filterIndex.getSize() - 1, act);
+    }
+
+    // Optional second insertion position
+    void addToFront(Activity* act) {
+        TRACK_OP(TrackedOp::ADD);
+        items.insertFront(act);
+        filterIndex.insertRow(0, act);
+        changed();
+        publish(ActivityEventType::ADDED, 0, act);
+    }
+
+    // Remove activity at index
+    void remove(int index) {
+        TRACK_OP(TrackedOp::REMOVE);
+        if (index < 0 || index >= filterIndex.getSize()) {
+            throw IndexOutOfRange("ActivityManager::remove - invalid index");
+        }
+        // events carry copies, so publish while the activity still exists
+        publish(ActivityEventType::REMOVED, index, filterIndex.row(index));
+        items.deleteAtPosition(index);
+        filterIndex.eraseRow(index);
+        changed();
+    }
+
+    // Clear all activities
+    void clear() {
+        items.clear();
+        filterIndex.clear();
+        changed();
+        publish(ActivityEventType::CLEARED, -1, nullptr);
+    }
+
+    // Edit the activity at position in place, keeping the index, the ordered
+    // views and subscribers current. The accessors hand out const pointers,
+    // so this is the only way to change an activity the manager owns.
+    template <typename Edit>
+    void update(int position, Edit edit) {
+        Activity* act = items.getAtPosition(position);
+        if (act == nullptr) {
+            throw IndexOutOfRange("ActivityManager::update - invalid index");
+        }
+        if (events == nullptr) {
+            edit(*act);
+            reindex(position, act);
+            return;
+        }
+        ActivityEvent& e = events->claim();
+        e.type = ActivityEventType::UPDATED;
+        e.position = position;
+        e.previous.assign(*act);
+        edit(*act);
+        reindex(position, act);
+        e.activity.assign(*act);
+        events->commit();
+    }
+
+    // Size
+    int getSize() const {
+        return items.getSize();
+    }
+
+    // activities, list nodes, filter index and cached sort orders
+    void addFootprint(MemoryFootprint& f) const {
+        items.addFootprint(f);
+        filterIndex.addFootprint(f);
+        for (const vector<int>& order : orderCache) addVectorFootprint(f, order, &MemoryFootprint::auxiliary);
+    }
+
+    MemoryFootprint footprint() const {
+        MemoryFootprint f;
+        f.payload = sizeof(*this);
+        addFootprint(f);
+        return f;
+    }
+
+    // Get by index (index rows follow list order, so no list walk)
+    const Activity* get(int index) const {
+        if (index < 0 || index >= filterIndex.getSize()) return nullptr;
+        return filterIndex.row(index);
+    }
+
+    // operator[]
+    const Activity* operator[](int index) const {
+        const Activity* act = get(index);
+        if (act == nullptr) {
+            throw IndexOutOfRange("ActivityManager::operator[] - invalid index");
+        }
+        return act;
+    }
+
+    // operator+=
+    ActivityManager& operator+=(Activity* act) {
+        add(act);
+        return *this;
+    }
+
+    // operator-=
+    ActivityManager& operator-=(int index) {
+        remove(index);
+        return *this;
+    }
+
+    // Display all
+    void displayAll() const {
+        items.printList();
+    }
+
+    // Recursive count
+    int countTypeRecursive(const string& type, int index = 0) const {
+        if (index >= items.getSize()) {
+            return 0;
+        }
+
+        Activity* act = items.getAtPosition(index);
+        int match = (act != nullptr && act->getType() == type) ? 1 : 0;
+
+        return match + countTypeRecursive(type, index + 1);
+    }
+
+    // Search
+    int sequentialSearchByName(const string& target) const {
+        TRACK_OP(TrackedOp::SEARCH);
+        return items.searchByName(target);
+    }
+
+    // ==========================
+    // FILTER QUERIES
+    // combine with & | ~ and andNot, then select()
+    // ==========================
+    ActivityBitmap allActivities() const { return filterIndex.all(); }
+    ActivityBitmap whereDifficulty(ClimbDifficulty d) const { return filterIndex.whereDifficulty(d); }
+    ActivityBitmap whereIndoor(bool indoor) const { return filterIndex.whereIndoor(indoor); }
+    ActivityBitmap whereType(const string& type) const { return filterIndex.whereType(type); }
+    ActivityBitmap whereLocation(const string& place) const { return filterIndex.whereLocation(place); }
+    ActivityBitmap whereHoursBetween(double lo, double hi) const { return filterIndex.whereHoursBetween(lo, hi); }
+
+    // matching activities in list order (manager keeps ownership)
+    vector<const Activity*> select(const ActivityBitmap& rows) const {
+        return filterIndex.select(rows);
+    }
+
+    // ==========================
+    // ORDERED VIEWS
+    // ascending and stable (ties keep list order); activities stay put
+    // ==========================
+    const vector<int>& orderedPositions(SortKey key) const {
+        int k = static_cast<int>(key);
+        if (orderBuiltAt[k] != generation) {
+            buildOrder(key, orderCache[k]);
+            orderBuiltAt[k] = generation;
+        }
+        return orderCache[k];
+    }
+
+    vector<const Activity*> sortedBy(SortKey key) const {
+        const vector<int>& order = orderedPositions(key);
+        vector<const Activity*> result(order.size());
+        for (size_t i = 0; i < order.size(); i++)
+            result[i] = filterIndex.row(order[i]);
+        return result;
+    }
+
+    // list position of the first activity (in name order) with this name, or -1
+    int binarySearchByName(const string& target) const {
+        TRACK_OP(TrackedOp::SEARCH);
+        const vector<int>& order = orderedPositions(SortKey::NAME);
+        int low = 0;
+        int high = static_cast<int>(order.size()) - 1;
+        int found = -1;
+
+        while (low <= high) {
+            int mid = (low + high) / 2;
+            const string& midName = filterIndex.row(order[mid])->getName();
+
+            if (midName < target) {
+                low = mid + 1;
+            }
+            else {
+                if (midName == target) found = order[mid];
+                high = mid - 1;
+            }
+        }
+
+        return found;
+    }
+
+    // using iterator 
+    void displayAllWithIterator() const {
+        ActivityLinkedList::Iterator it = items.begin();
+
+        while (it.hasCurrent()) {
+            Activity* act = it.getData();
+            if (act != nullptr) {
+                act->print();
+            }
+            it.next();
+        }
+    }
+};
+// ==========================
+// EPOCH-BASED RECLAMATION
+// A reader records the epoch it entered in. Memory unlinked by a writer
+// is tagged with the epoch at unlink time and freed once every reader
+// still inside entered after that tag.
+// ==========================
+class EpochDomain {
+public:
+    static const int MAX_READERS = 128;
+
+private:
+    struct alignas(64) ReaderSlot {
+        atomic<uint64_t> epoch{ 0 };      // 0 = not reading
+        atomic<bool> claimed{ false };
+    };
+
+    struct Retired {
+        uint64_t epoch;
+        function<void()> reclaim;
+    };
+
+    // released when its thread exits
+    struct ThreadSlot {
+        int index = -1;
+        int depth = 0;
+
+        ~ThreadSlot() {
+            if (index >= 0) EpochDomain::global().slots[index].claimed.store(false);
+        }
+    };
+
+    ReaderSlot slots[MAX_READERS];
+    atomic<uint64_t> globalEpoch{ 1 };
+    mutex retireLock;
+    vector<Retired> retired;
+
+    ThreadSlot& self() {
+        thread_local ThreadSlot mine;
+        if (mine.index < 0) {
+            for (int i = 0; i < MAX_READERS; i++) {
+                bool expected = false;
+                if (slots[i].claimed.compare_exchange_strong(expected, true)) {
+                    mine.index = i;
+                    return mine;
+                }
+            }
+            throw runtime_error("EpochDomain - too many reader threads");
+        }
+        return mine;
+    }
+
+    // call with retireLock held
+    void collectLocked() {
+        uint64_t oldestReader = UINT64_MAX;
+        for (const ReaderSlot& slot : slots) {
+            uint64_t e = slot.epoch.load();
+            if (e != 0 && e < oldestReader) oldestReader = e;
+        }
+
+        size_t kept = 0;
+        for (size_t i = 0; i < retired.size(); i++) {
+            if (retired[i].epoch < oldestReader)
+                retired[i].reclaim();
+            else
+                retired[kept++] = std::move(retired[i]);
+        }
+        retired.resize(kept);
+    }
+
+public:
+    static EpochDomain& global() {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    ~EpochDomain() {
+        for (Retired& r : retired) r.reclaim();
+    }
+
+    // nested enter/exit on one thread only count the outermost pair
+    void enter() {
+        ThreadSlot& t = self();
+        if (t.depth++ == 0)
+            slots[t.index].epoch.store(globalEpoch.load());
+    }
+
+    void exit() {
+        ThreadSlot& t = self();
+        if (--t.depth == 0)
+            slots[t.index].epoch.store(0);
+    }
+
+    // reclaim runs once no reader can still see the unlinked memory
+    void retire(function<void()> reclaim) {
+        lock_guard<mutex> lock(retireLock);
+        retired.push_back({ globalEpoch.fetch_add(1), std::move(reclaim) });
+        collectLocked();
+    }
+
+    void collect() {
+        lock_guard<mutex> lock(retireLock);
+        collectLocked();
+    }
+
+    size_t pendingCount() {
+        lock_guard<mutex> lock(retireLock);
+        return retired.size();
+    }
+
+    // collect, and give the list's storage back once nothing is pending
+    // (leak checks call this after their threads are joined)
+    void trim() {
+        lock_guard<mutex> lock(retireLock);
+        collectLocked();
+        if (retired.empty()) vector<Retired>().swap(retired);
+    }
+
+    // for callers that track their own garbage: tag it with advance()
+    // when it is unlinked and free it once quiescent(tag) is true
+    uint64_t advance() { return globalEpoch.fetch_add(1); }
+
+    bool quiescent(uint64_t tag) const {
+        for (const ReaderSlot& slot : slots) {
+            uint64_t e = slot.epoch.load();
+            if (e != 0 && e <= tag) return false;
+        }
+        return true;
+    }
+};
+
+class EpochGuard {
+public:
+    EpochGuard() { EpochDomain::global().enter(); }
+    ~EpochGuard() { EpochDomain::global().exit(); }
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+};
+
+// ==========================
+// CONCURRENT MANAGER
+// Readers never lock: they load the published version inside an
+// EpochGuard. Writers take one mutex. Appends fill spare capacity and
+// publish the new count; removals and growth publish a fresh version
+// and retire the old one. Stored activities are never modified.
+// Standalone: ClimbingTracker keeps its single-threaded ActivityManager.
+// This is the store for callers that scan from several threads; the
+// benchmarks report its scan throughput at 1, 2 and 4 threads.
+// ==========================
+struct ActivitySummary {
+    int climbSessions;
+    int trainingSessions;
+    double totalHours;
+};
+
+class ConcurrentActivityManager {
+private:
+    struct Version {
+        const Activity** slots;
+        int capacity;
+        atomic<int> count;
+
+        explicit Version(int cap) : slots(new const Activity*[cap]), capacity(cap), count(0) {}
+        ~Version() { delete[] slots; }
+    };
+
+    atomic<Version*> current;
+    mutex writeLock;
+
+    void publish(Version* next) {
+        Version* old = current.exchange(next);
+        EpochDomain::global().retire([old]() { delete old; });
+    }
+
+public:
+    explicit ConcurrentActivityManager(int initialCapacity = 16)
+        : current(new Version(initialCapacity > 0 ? initialCapacity : 16)) {
+    }
+
+    ConcurrentActivityManager(const ConcurrentActivityManager&) = delete;
+    ConcurrentActivityManager& operator=(const ConcurrentActivityManager&) = delete;
+
+    // no reader may still be using the manager
+    ~ConcurrentActivityManager() {
+        Version* v = current.load();
+        for (int i = 0; i < v->count.load(); i++)
+            delete v->slots[i];
+        delete v;
+    }
+
+    // ==========================
+    // WRITERS
+    // ==========================
+    void add(Activity* act) {
+        lock_guard<mutex> lock(writeLock);
+        Version* v = current.load();
+        int n = v->count.load(memory_order_relaxed);
+
+        if (n < v->capacity) {
+            v->slots[n] = act;
+            v->count.store(n + 1, memory_order_release);
+            return;
+        }
+
+        Version* grown = new Version(v->capacity * 2);
+        copy(v->slots, v->slots + n, grown->slots);
+        grown->slots[n] = act;
+        grown->count.store(n + 1, memory_order_relaxed);
+        publish(grown);
+    }
+
+    void remove(int index) {
+        lock_guard<mutex> lock(writeLock);
+        Version* v = current.load();
+        int n = v->count.load(memory_order_relaxed);
+        if (index < 0 || index >= n) {
+            throw IndexOutOfRange("ConcurrentActivityManager::remove - invalid index");
+        }
+
+        Version* next = new Version(v->capacity);
+        copy(v->slots, v->slots + index, next->slots);
+        copy(v->slots + index + 1, v->slots + n, next->slots + index);
+        next->count.store(n - 1, memory_order_relaxed);
+
+        const Activity* removed = v->slots[index];
+        publish(next);
+        EpochDomain::global().retire([removed]() { delete removed; });
+    }
+
+    void clear() {
+        lock_guard<mutex> lock(writeLock);
+        Version* v = current.load();
+        int n = v->count.load(memory_order_relaxed);
+        vector<const Activity*> removed(v->slots, v->slots + n);
+
+        publish(new Version(16));
+        EpochDomain::global().retire([removed]() {
+            for (const Activity* act : removed) delete act;
+        });
+    }
+
+    // ==========================
+    // READERS (lock-free)
+    // ==========================
+    // visits a consistent prefix of the list in order
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        EpochGuard guard;
+        const Version* v = current.load(memory_order_acquire);
+        int n = v->count.load(memory_order_acquire);
+        for (int i = 0; i < n; i++)
+            visit(*v->slots[i]);
+    }
+
+    int getSize() const {
+        EpochGuard guard;
+        return current.load(memory_order_acquire)->count.load(memory_order_acquire);
+    }
+
+    int sequentialSearchByName(const string& target) const {
+        EpochGuard guard;
+        const Version* v = current.load(memory_order_acquire);
+        int n = v->count.load(memory_order_acquire);
+        for (int i = 0; i < n; i++)
+            if (v->slots[i]->getName() == target) return i;
+        return -1;
+    }
+
+    int countType(const string& type) const {
+        int matches = 0;
+        forEach([&](const Activity& act) {
+            if (act.getType() == type) matches++;
+        });
+        return matches;
+    }
+
+    ActivitySummary summarize() const {
+        ActivitySummary summary{ 0, 0, 0.0 };
+        forEach([&summary](const Activity& act) {
+            if (const ClimbSession* cs = dynamic_cast<const ClimbSession*>(&act)) {
+                summary.climbSessions++;
+                summary.totalHours += cs->getHours();
+            }
+            else if (dynamic_cast<const TrainingSession*>(&act) != nullptr) {
+                summary.trainingSessions++;
+            }
+        });
+        return summary;
+    }
+
+    void displayAll(ostream& os) const {
+        forEach([&os](const Activity& act) {
+            os << act << '\n';
+        });
+    }
+};
+
+// ==========================
+// VERSIONED STATE (MVCC)
+// Every publish() installs a new immutable version. read() pins the
+// current one, so a reader sees one consistent value however many
+// writes land meanwhile. Superseded versions are freed by the writer
+// once no reader can still be pinning them and none holds a pin.
+// ==========================
+template <typename Type>
+class VersionedState {
+private:
+    struct Node {
+        Type value;
+        uint64_t version;
+        atomic<int> pins{ 0 };
+        uint64_t retiredAt = 0;
+
+        Node(Type v, uint64_t ver) : value(std::move(v)), version(ver) {}
+    };
+
+    atomic<Node*> head;
+    mutex writeLock;
+    vector<Node*> retired;   // superseded, guarded by writeLock
+
+    // call with writeLock held
+    void collectLocked() {
+        EpochDomain& domain = EpochDomain::global();
+        size_t kept = 0;
+        for (size_t i = 0; i < retired.size(); i++) {
+            Node* node = retired[i];
+            // after the grace period nobody can take a new pin
+            if (domain.quiescent(node->retiredAt) && node->pins.load(memory_order_acquire) == 0)
+                delete node;
+            else
+                retired[kept++] = node;
+        }
+        retired.resize(kept);
+    }
+
+public:
+    class Snapshot {
+    private:
+        Node* node;
+
+    public:
+        explicit Snapshot(Node* n) : node(n) {}
+        Snapshot(Snapshot&& other) noexcept : node(other.node) { other.node = nullptr; }
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+        Snapshot& operator=(Snapshot&&) = delete;
+        ~Snapshot() {
+            if (node) node->pins.fetch_sub(1, memory_order_release);
+        }
+
+        const Type& operator*() const { return node->value; }
+        const Type* operator->() const { return &node->value; }
+        uint64_t version() const { return node->version; }
+    };
+
+    explicit VersionedState(Type initial = Type()) : head(new Node(std::move(initial), 1)) {}
+
+    // no reader may outlive the state
+    ~VersionedState() {
+        delete head.load();
+        for (Node* node : retired) delete node;
+    }
+
+    VersionedState(const VersionedState&) = delete;
+    VersionedState& operator=(const VersionedState&) = delete;
+
+    Snapshot read() const {
+        EpochGuard guard;   // keeps head alive until the pin is taken
+        Node* node = head.load();
+        node->pins.fetch_add(1, memory_order_acq_rel);
+        return Snapshot(node);
+    }
+
+    uint64_t publish(Type value) {
+        lock_guard<mutex> lock(writeLock);
+        Node* old = head.load();
+        Node* next = new Node(std::move(value), old->version + 1);
+        head.store(next);
+        old->retiredAt = EpochDomain::global().advance();
+        retired.push_back(old);
+        collectLocked();
+        return next->version;
+    }
+
+    // frees versions whose last reader has gone since the previous write
+    void collect() {
+        lock_guard<mutex> lock(writeLock);
+        collectLocked();
+    }
+
+    uint64_t currentVersion() const { return head.load()->version; }
+
+    size_t retainedVersions() {
+        lock_guard<mutex> lock(writeLock);
+        return retired.size();
+    }
+};
+
+// ==========================
+// TRAINING LOAD MODEL
+// exponentially weighted acute (7-day) and chronic (28-day) load.
+// Both averages are linear in the session loads, so a session on any
+// day is folded in (or taken back out) in O(1). Taking loads back out
+// through pow() leaves rounding residue, so the model resets once its
+// last session is removed and treats a chronic load that is negligible
+// next to the largest session as no load at all.
+// ==========================
+class TrainingLoadModel {
+public:
+    static constexpr double ACUTE_ALPHA = 2.0 / (7 + 1);
+    static constexpr double CHRONIC_ALPHA = 2.0 / (28 + 1);
+
+private:
+    static constexpr double NEGLIGIBLE = 1e-9;   // of the largest load seen
+
+    double acute;
+    double chronic;
+    int lastDay;       // both averages are expressed as of this day
+    bool started;
+    int sessions;      // loads added and not yet removed
+    double largest;    // largest single load added
+
+    static double decayed(double value, double alpha, int days) {
+        return (days <= 0) ? value : value * pow(1.0 - alpha, days);
+    }
+
+    void fold(int day, double load) {
+        if (day >= lastDay) {
+            acute = decayed(acute, ACUTE_ALPHA, day - lastDay) + ACUTE_ALPHA * load;
+            chronic = decayed(chronic, CHRONIC_ALPHA, day - lastDay) + CHRONIC_ALPHA * load;
+            lastDay = day;
+        }
+        else {
+            // late session: its contribution has already decayed to lastDay
+            acute += decayed(ACUTE_ALPHA * load, ACUTE_ALPHA, lastDay - day);
+            chronic += decayed(CHRONIC_ALPHA * load, CHRONIC_ALPHA, lastDay - day);
+        }
+    }
+
+public:
+    TrainingLoadModel() : acute(0.0), chronic(0.0), lastDay(0), started(false), sessions(0), largest(0.0) {}
+
+    void addLoad(int day, double load) {
+        if (!started) {
+            lastDay = day;
+            started = true;
+        }
+        sessions++;
+        largest = max(largest, fabs(load));
+        fold(day, load);
+    }
+
+    // the last removal resets both averages to exactly 0
+    void removeLoad(int day, double load) {
+        if (!started || sessions == 0) return;
+        if (--sessions == 0) {
+            acute = chronic = 0.0;
+            return;
+        }
+        fold(day, -load);
+    }
+
+    void addSession(const Activity& act) { addLoad(act.getDay(), act.trainingLoad()); }
+    void removeSession(const Activity& act) { removeLoad(act.getDay(), act.trainingLoad()); }
+
+    // ===== QUERIES (as of a day at or after the last session) =====
+    double acuteLoad(int day) const { return decayed(acute, ACUTE_ALPHA, day - lastDay); }
+    double chronicLoad(int day) const { return decayed(chronic, CHRONIC_ALPHA, day - lastDay); }
+
+    // acute:chronic workload ratio, 0 without a meaningful chronic load
+    double ratio(int day) const {
+        double c = chronicLoad(day);
+        return (c > largest * NEGLIGIBLE) ? acuteLoad(day) / c : 0.0;
+    }
+
+    int getLastDay() const { return lastDay; }
+    int getSessionCount() const { return sessions; }
+
+    bool operator==(const TrainingLoadModel& other) const {
+        return acute == other.acute && chronic == other.chronic && lastDay == other.lastDay
+            && started == other.started && sessions == other.sessions && largest == other.largest;
+    }
+};
+
+// the aggregates a report prints, captured together
+struct TrackerSummary {
+    string climberName;
+    int totalHours = 0;
+    int climbingDays = 0;
+    int climbSessions = 0;
+    int trainingSessions = 0;
+
+    bool operator==(const TrackerSummary& other) const {
+        return climberName == other.climberName && totalHours == other.totalHours
+            && climbingDays == other.climbingDays && climbSessions == other.climbSessions
+            && trainingSessions == other.trainingSessions;
+    }
+};
+
+// what a tracker publishes: the summary plus the date-dependent figures'
+// inputs, so a whole report reads one version
+struct TrackerSnapshot : TrackerSummary {
+    TrainingLoadModel trainingLoad;
+    GradeRecency grades;
+
+    bool operator==(const TrackerSnapshot& other) const {
+        return static_cast<const TrackerSummary&>(*this) == other
+            && trainingLoad == other.trainingLoad && grades == other.grades;
+    }
+};
+
+// ==========================
+// REPORT TEMPLATES
+// A layout is parsed once into a list of instructions (literal spans,
+// summary fields and label tabs) and then rendered many times without
+// reparsing. {field} inserts a summary value; {tab} pads the label before
+// it to the template's label column, or a single space when that is 0
+// ==========================
+enum class ReportField : uint8_t { NAME, TOTAL_HOURS, DAYS, AVG_HOURS, LEVEL, TYPE, RATING, CLIMBS, TRAINING, COUNT };
+const string_view REPORT_FIELD_NAMES[static_cast<int>(ReportField::COUNT)] = {
+    "name", "total_hours", "days", "avg", "level", "type", "rating", "climbs", "training"
+};
+
+class ReportTemplate {
+private:
+    enum class Op : uint8_t { TEXT, FIELD, TAB };
+
+    struct Instruction {
+        Op op;
+        ReportField field;
+        uint32_t offset;        // TEXT: span in literals
+        uint32_t length;
+        uint32_t lineStart;     // TEXT: chars after its last newline, or UINT32_MAX
+    };
+
+    string literals;
+    vector<Instruction> program;
+    int labelColumn;
+
+    void addText(string_view text) {
+        if (text.empty()) return;
+        size_t newline = text.rfind('\n');
+        program.push_back({ Op::TEXT, ReportField::COUNT, static_cast<uint32_t>(literals.size()),
+            static_cast<uint32_t>(text.size()),
+            newline == string_view::npos ? UINT32_MAX : static_cast<uint32_t>(newline + 1) });
+        literals.append(text);
+    }
+
+public:
+    ReportTemplate(string_view layout, int labelColumn = 0) : labelColumn(labelColumn) {
+        size_t pos = 0;
+        while (pos < layout.size()) {
+            size_t open = layout.find('{', pos);
+            if (open == string_view::npos) open = layout.size();
+            addText(layout.substr(pos, open - pos));
+            if (open == layout.size()) break;
+
+            size_t close = layout.find('}', open);
+            if (close == string_view::npos)
+                throw runtime_error("Unclosed field in report layout");
+            string_view name = layout.substr(open + 1, close - open - 1);
+            pos = close + 1;
+            if (name == "tab") {
+                program.push_back({ Op::TAB, ReportField::COUNT, 0, 0, 0 });
+                continue;
+            }
+            int field = 0;
+            while (field < static_cast<int>(ReportField::COUNT) && REPORT_FIELD_NAMES[field] != name) field++;
+            if (field == static_cast<int>(ReportField::COUNT))
+                throw runtime_error("Unknown report field: " + string(name));
+            program.push_back({ Op::FIELD, static_cast<ReportField>(field), 0, 0, 0 });
+        }
+    }
+
+    size_t instructionCount() const { return program.size(); }
+
+    // returns the full length; a result > capacity means out was too small
+    // and holds only the first capacity bytes
+    size_t render(const TrackerSummary& s, char* out, size_t capacity) const {
+        double avgHours = (s.climbingDays > 0) ? static_cast<double>(s.totalHours) / s.climbingDays : 0.0;
+        size_t length = 0;
+        size_t lineStart = 0;
+        auto emit = [&](const char* text, size_t n) {
+            if (length < capacity) memcpy(out + length, text, min(n, capacity - length));
+            length += n;
+        };
+        auto emitView = [&](string_view text) { emit(text.data(), text.size()); };
+
+        char number[32];
+        for (const Instruction& in : program) {
+            switch (in.op) {
+            case Op::TEXT:
+                emit(literals.data() + in.offset, in.length);
+                if (in.lineStart != UINT32_MAX) lineStart = length - in.length + in.lineStart;
+                break;
+            case Op::TAB: {
+                size_t column = length - lineStart;
+                size_t pad = (column < static_cast<size_t>(labelColumn)) ? labelColumn - column : (labelColumn == 0 ? 1 : 0);
+                for (size_t i = 0; i < pad; i++) emit(" ", 1);
+                break;
+            }
+            case Op::FIELD: {
+                to_chars_result r{ number, errc() };
+                switch (in.field) {
+                case ReportField::NAME: emitView(s.climberName); break;
+                case ReportField::TOTAL_HOURS: r = to_chars(number, number + sizeof(number), s.totalHours); break;
+                case ReportField::DAYS: r = to_chars(number, number + sizeof(number), s.climbingDays); break;
+                case ReportField::AVG_HOURS: r = to_chars(number, number + sizeof(number), avgHours, chars_format::fixed, 1); break;
+                case ReportField::LEVEL: emitView(EXPERIENCE_LABELS[experienceCode(s.totalHours)]); break;
+                case ReportField::TYPE: emitView(FREQUENCY_LABELS[climberTypeCode(s.climbingDays)]); break;
+                case ReportField::RATING: emitView(DEDICATION_LABELS[performanceCode(avgHours)]); break;
+                case ReportField::CLIMBS: r = to_chars(number, number + sizeof(number), s.climbSessions); break;
+                case ReportField::TRAINING: r = to_chars(number, number + sizeof(number), s.trainingSessions); break;
+                default: break;
+                }
+                emit(number, static_cast<size_t>(r.ptr - number));
+                break;
+            }
+            }
+        }
+        return length;
+    }
+
+    // renders into a reused buffer; allocates only when it has to grow
+    void render(const TrackerSummary& s, string& out) const {
+        out.resize(out.capacity());
+        size_t length = render(s, out.data(), out.size());
+        if (length > out.size()) {
+            out.resize(length);
+            render(s, out.data(), out.size());
+        }
+        out.resize(length);
+    }
+};
+
+// the summary block shared by the saved file and the screen
+const string_view SUMMARY_LAYOUT =
+    "Name:{tab}{name}\n"
+    "Total Hours:{tab}{total_hours}\n"
+    "Climbing Days:{tab}{days}\n"
+    "Avg Hours / Session:{tab}{avg}\n"
+    "Experience Level:{tab}{level}\n"
+    "Climber Type:{tab}{type}\n"
+    "Performance Rating:{tab}{rating}\n";
+const string_view SESSION_COUNTS_LAYOUT =
+    "Climb Sessions:{tab}{climbs}\n"
+    "Training Sessions:{tab}{training}\n";
+const string_view PROTOCOL_LAYOUT =
+    "OK name={name}|total_hours={total_hours}|days={days}|avg={avg}|level={level}"
+    "|type={type}|rating={rating}|climbs={climbs}|training={training}\n";
+
+enum class ReportLayout : uint8_t { SAVED, SCREEN, PROTOCOL, COUNT };
+const int SCREEN_LABEL_COLUMN = 25;
+
+// compiled once at startup and shared by every tracker
+const ReportTemplate REPORT_TEMPLATES[static_cast<int>(ReportLayout::COUNT)] = {
+    ReportTemplate(SUMMARY_LAYOUT),
+    ReportTemplate(string(SUMMARY_LAYOUT) + string(SESSION_COUNTS_LAYOUT), SCREEN_LABEL_COLUMN),
+    ReportTemplate(PROTOCOL_LAYOUT)
+};
+
+inline const ReportTemplate& reportTemplate(ReportLayout layout) {
+    return REPORT_TEMPLATES[static_cast<int>(layout)];
+}
+
+// the saved report text; returns the full length, so a result > capacity
+// means out was too small
+inline size_t renderReport(const TrackerSummary& s, char* out, size_t capacity) {
+    TRACK_OP(TrackedOp::REPORT);
+    return reportTemplate(ReportLayout::SAVED).render(s, out, capacity);
+}
+
+// fixed text of a report apart from the name, with room to spare
+const size_t REPORT_FIXED_BYTES = 256;
+
+// ==========================
+// GYM TRAINING LOAD
+// one model per climber, stored contiguously for gym-wide scans
+// ==========================
+class GymTrainingLoad {
+private:
+    unordered_map<string, int> climberIds;
+    vector<string> climberNames;
+    vector<TrainingLoadModel> models;
+
+    int idFor(const string& climber) {
+        auto found = climberIds.find(climber);
+        if (found != climberIds.end()) {
+            return found->second;
+        }
+        int id = static_cast<int>(models.size());
+        climberIds.emplace(climber, id);
+        climberNames.push_back(climber);
+        models.emplace_back();
+        return id;
+    }
+
+public:
+    void addSession(const string& climber, const Activity& act) {
+        models[idFor(climber)].addSession(act);
+    }
+
+    void removeSession(const string& climber, const Activity& act) {
+        auto found = climberIds.find(climber);
+        if (found != climberIds.end()) {
+            models[found->second].removeSession(act);
+        }
+    }
+
+    int getClimberCount() const { return static_cast<int>(models.size()); }
+
+    // returns nullptr for unknown climbers
+    const TrainingLoadModel* find(const string& climber) const {
+        auto found = climberIds.find(climber);
+        return (found == climberIds.end()) ? nullptr : &models[found->second];
+    }
+
+    double ratio(const string& climber, int day) const {
+        const TrainingLoadModel* model = find(climber);
+        return (model == nullptr) ? 0.0 : model->ratio(day);
+    }
+
+    // climbers whose ratio is above threshold (1.5 is the usual injury-risk line)
+    vector<string> climbersAbove(double threshold, int day) const {
+        vector<string> result;
+        for (size_t i = 0; i < models.size(); i++) {
+            if (models[i].ratio(day) > threshold)
+                result.push_back(climberNames[i]);
+        }
+        return result;
+    }
+};
+
+// ==========================
+// LOCATION GROUP-BY
+// hours, sessions and difficulty mix per (place, indoor), in an
+// open-addressing table keyed by interned place id; fed directly or
+// as a subscriber of an ActivityEventBus
+// ==========================
+struct LocationStats {
+    int placeId;
+    bool indoor;
+    double totalHours;
+    int sessions;
+    int difficultyCounts[EXTREME];     // [difficulty - 1]
+};
+
+class LocationGroupBy : public EventSubscriber {
+private:
+    static const uint32_t EMPTY = 0xFFFFFFFFu;
+
+    struct Slot {
+        uint32_t key;
+        LocationStats stats;
+    };
+
+    vector<Slot> slots;                // power-of-two size, linear probing
+    int used;
+    PlaceDictionary places;
+
+    static uint32_t makeKey(int placeId, bool indoor) {
+        return (static_cast<uint32_t>(placeId) << 1) | (indoor ? 1u : 0u);
+    }
+
+    size_t home(uint32_t key) const {
+        uint32_t h = key * 0x9E3779B1u;
+        return (h ^ (h >> 16)) & (slots.size() - 1);
+    }
+
+    const Slot* findSlot(uint32_t key) const {
+        for (size_t i = home(key);; i = (i + 1) & (slots.size() - 1)) {
+            if (slots[i].key == key) return &slots[i];
+            if (slots[i].key == EMPTY) return nullptr;
+        }
+    }
+
+    Slot* findSlot(uint32_t key) {
+        return const_cast<Slot*>(static_cast<const LocationGroupBy*>(this)->findSlot(key));
+    }
+
+    void grow() {
+        vector<Slot> old;
+        old.swap(slots);
+        slots.assign(old.size() * 2, Slot{ EMPTY, LocationStats() });
+        for (const Slot& s : old) {
+            if (s.key == EMPTY) continue;
+            size_t i = home(s.key);
+            while (slots[i].key != EMPTY) i = (i + 1) & (slots.size() - 1);
+            slots[i] = s;
+        }
+    }
+
+    LocationStats& upsert(int placeId, bool indoor) {
+        if ((used + 1) * 10 > static_cast<int>(slots.size()) * 7)  // load factor 0.7
+            grow();
+
+        uint32_t key = makeKey(placeId, indoor);
+        size_t i = home(key);
+        while (slots[i].key != key) {
+            if (slots[i].key == EMPTY) {
+                slots[i].key = key;
+                slots[i].stats = LocationStats{ placeId, indoor, 0.0, 0, { 0, 0, 0, 0 } };
+                used++;
+                break;
+            }
+            i = (i + 1) & (slots.size() - 1);
+        }
+        return slots[i].stats;
+    }
+
+    // removals only touch groups that still hold a session
+    void apply(const string& place, bool indoor, double hours, ClimbDifficulty diff, int sign) {
+        LocationStats* stats;
+        if (sign > 0) {
+            stats = &upsert(places.intern(place), indoor);
+        }
+        else {
+            int id = places.find(place);
+            Slot* slot = (id < 0) ? nullptr : findSlot(makeKey(id, indoor));
+            if (slot == nullptr || slot->stats.sessions <= 0) return;
+            stats = &slot->stats;
+        }
+        stats->totalHours += sign * hours;
+        stats->sessions += sign;
+        if (diff >= EASY && diff <= EXTREME)
+            stats->difficultyCounts[diff - 1] += sign;
+    }
+
+public:
+    explicit LocationGroupBy(int initialCapacity = 16) : used(0) {
+        size_t size = 16;
+        while (size < static_cast<size_t>(initialCapacity)) size *= 2;
+        slots.assign(size, Slot{ EMPTY, LocationStats() });
+    }
+
+    // ==========================
+    // INCREMENTAL UPDATES
+    // ==========================
+    void add(const ClimbSession& cs) {
+        Location loc = cs.getLocation();
+        apply(loc.getPlace(), loc.isIndoor(), cs.getHours(), cs.getDifficulty(), +1);
+    }
+
+    // groups that drop to zero sessions stay in the table but are skipped;
+    // places that were never added are ignored
+    void remove(const ClimbSession& cs) {
+        Location loc = cs.getLocation();
+        apply(loc.getPlace(), loc.isIndoor(), cs.getHours(), cs.getDifficulty(), -1);
+    }
+
+    void onEvents(const ActivityEvent* events, size_t count) override {
+        for (size_t i = 0; i < count; i++) {
+            const ActivityEvent& e = events[i];
+            if (e.type == ActivityEventType::CLEARED) {
+                clear();
+                continue;
+            }
+            if (e.type == ActivityEventType::UPDATED && e.previous.kind == ActivityKind::CLIMB)
+                apply(e.previous.place, e.previous.indoor, e.previous.hours, e.previous.difficulty, -1);
+            if (e.activity.kind == ActivityKind::CLIMB)
+                apply(e.activity.place, e.activity.indoor, e.activity.hours, e.activity.difficulty,
+                    e.type == ActivityEventType::REMOVED ? -1 : +1);
+        }
+    }
+
+    void addAll(const ActivityManager& mgr) {
+        for (const Activity* act : mgr.select(mgr.whereType("Climb Session")))
+            add(*static_cast<const ClimbSession*>(act));
+    }
+
+    // fold another table in (for example, every climber in a gym)
+    void merge(const LocationGroupBy& other) {
+        other.forEach([this, &other](const LocationStats& s) {
+            LocationStats& mine = upsert(places.intern(other.placeName(s.placeId)), s.indoor);
+            mine.totalHours += s.totalHours;
+            mine.sessions += s.sessions;
+            for (int d = 0; d < EXTREME; d++)
+                mine.difficultyCounts[d] += s.difficultyCounts[d];
+        });
+    }
+
+    void clear() {
+        slots.assign(slots.size(), Slot{ EMPTY, LocationStats() });
+        used = 0;
+        places.clear();
+    }
+
+    // ==========================
+    // QUERIES
+    // ==========================
+    // returns nullptr if the place was never seen
+    const LocationStats* find(const string& place, bool indoor) const {
+        int id = places.find(place);
+        if (id < 0) return nullptr;
+        const Slot* slot = findSlot(makeKey(id, indoor));
+        return (slot == nullptr || slot->stats.sessions == 0) ? nullptr : &slot->stats;
+    }
+
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        for (const Slot& s : slots)
+            if (s.key != EMPTY && s.stats.sessions != 0) visit(s.stats);
+    }
+
+    void addFootprint(MemoryFootprint& f) const {
+        addVectorFootprint(f, slots, &MemoryFootprint::auxiliary);
+        places.addFootprint(f);
+    }
+
+    int getGroupCount() const {
+        int groups = 0;
+        forEach([&groups](const LocationStats&) { groups++; });
+        return groups;
+    }
+
+    const string& placeName(int placeId) const { return places.nameOf(placeId); }
+
+    void print(ostream& os) const {
+        ios_base::fmtflags flags = os.flags();
+        streamsize precision = os.precision();
+        forEach([&](const LocationStats& s) {
+            os << left << setw(30) << placeName(s.placeId) + (s.indoor ? " (Indoor)" : " (Outdoor)")
+                << setw(6) << s.sessions << " sessions  "
+                << fixed << setprecision(1) << s.totalHours << " hrs  E/M/H/X "
+                << s.difficultyCounts[0] << '/' << s.difficultyCounts[1] << '/'
+                << s.difficultyCounts[2] << '/' << s.difficultyCounts[3] << '\n';
+        });
+        os.flags(flags);
+        os.precision(precision);
+    }
+};
+
+// keeps a tracker's training load and grade pyramid in step with its
+// manager, including in-place updates and clears
+class SessionAggregates : public EventSubscriber {
+private:
+    TrainingLoadModel& load;
+    GradePyramid& pyramid;
+
+    void apply(const ActivityRecord& r, int sign) {
+        if (sign > 0) {
+            load.addLoad(r.day(), r.load);
+            pyramid.addSend(r.grade, r.day());
+        }
+        else {
+            load.removeLoad(r.day(), r.load);
+            pyramid.removeSend(r.grade, r.day());
+        }
+    }
+
+public:
+    SessionAggregates(TrainingLoadModel& load, GradePyramid& pyramid) : load(load), pyramid(pyramid) {}
+
+    void onEvents(const ActivityEvent* events, size_t count) override {
+        for (size_t i = 0; i < count; i++) {
+            const ActivityEvent& e = events[i];
+            switch (e.type) {
+            case ActivityEventType::ADDED: apply(e.activity, +1); break;
+            case ActivityEventType::REMOVED: apply(e.activity, -1); break;
+            case ActivityEventType::UPDATED:
+                apply(e.previous, -1);
+                apply(e.activity, +1);
+                break;
+            case ActivityEventType::CLEARED:
+                load = TrainingLoadModel();
+                pyramid.clear();
+                break;
+            }
+        }
+    }
+};
+
+class ClimbingTracker {
+private:
+    string climberName;
+    int totalHours;
+    int climbingDays;
+    int climbSessions;
+    int trainingSessions;
+    mutable ActivityEventBus events;   // manager changes, drained before derived reads
+    ActivityManager manager;   // handles memory automatically
+    TrainingLoadModel trainingLoad;    // these three are subscribed to events
+    GradePyramid pyramid;
+    SessionAggregates aggregates{ trainingLoad, pyramid };
+    LocationGroupBy byLocation;
+    VersionedState<TrackerSnapshot> summary;   // what concurrent readers see
+
+    struct ReportCache {
+        bool valid = false;
+        uint64_t version = 0;   // summary version the text was rendered from
+        string text;
+    };
+    mutable ReportCache reportCache[static_cast<int>(ReportLayout::COUNT)];
+
+    // every mutator ends here so readers get the aggregates as one version;
+    // nothing is published when they did not change
+    void publishSummary() {
+        events.flush();
+        TrackerSnapshot s;
+        s.climberName = climberName;
+        s.totalHours = totalHours;
+        s.climbingDays = climbingDays;
+        s.climbSessions = climbSessions;
+        s.trainingSessions = trainingSessions;
+        s.trainingLoad = trainingLoad;
+        s.grades = pyramid.recency();
+        if (*summary.read() == s) return;
+        summary.publish(std::move(s));
+    }
+
+    const string& renderedReport(ReportLayout layout, const VersionedState<TrackerSnapshot>::Snapshot& snap) const {
+        ReportCache& cache = reportCache[static_cast<int>(layout)];
+        if (!cache.valid || cache.version != snap.version()) {
+            reportTemplate(layout).render(*snap, cache.text);
+            cache.version = snap.version();
+            cache.valid = true;
+        }
+        return cache.text;
+    }
+
+    void countSession(const Activity* act, int delta) {
+        if (act->getType() == "Climb Session") climbSessions += delta;
+        else if (act->getType() == "Training Session") trainingSessions += delta;
+    }
+
+public:
+    // ==========================
+    // CONSTRUCTOR / DESTRUCTOR
+    // ==========================
+    ClimbingTracker() : climberName(""), totalHours(0), climbingDays(0), climbSessions(0), trainingSessions(0) {
+        manager.attachEventBus(&events);
+        events.subscribe(&aggregates);
+        events.subscribe(&byLocation);
+    }
+    ~ClimbingTracker() = default; // manager cleans up Activities automatically
+
+    // ==========================
+    // SETTERS
+    // ==========================
+    void setClimberName(const string& name) { climberName = name; publishSummary(); }
+    void setClimbingDays(int days) { climbingDays = days; publishSummary(); }
+
+    // ==========================
+    // NON-INTERACTIVE ADD (FOR TESTS)
+    // ==========================
+    void addSession(Activity* activity) {
+        manager.add(activity);  // manager takes ownership
+        if (ClimbSession* cs = dynamic_cast<ClimbSession*>(activity)) {
+            totalHours += static_cast<int>(cs->getHours());
+        }
+        countSession(activity, 1);
+        publishSummary();
+    }
+
+    int getActivityCount() const { return manager.getSize(); }
+    string getClimberName() const { return climberName; }
+    int getTotalHours() const { return totalHours; }
+    int getClimbingDays() const { return climbingDays; }
+    int getClimbSessionCount() const { return climbSessions; }
+    int getTrainingSessionCount() const { return trainingSessions; }
+
+    // safe from any thread while the owner keeps writing
+    VersionedState<TrackerSnapshot>::Snapshot readSummary() const { return summary.read(); }
+    uint64_t getVersion() const { return summary.currentVersion(); }
+
+    // owner thread only; rendered again only after the summary version moves
+    const string& renderedReport(ReportLayout layout) const {
+        const ReportCache& cache = reportCache[static_cast<int>(layout)];
+        if (cache.valid && cache.version == getVersion()) return cache.text;
+        return renderedReport(layout, readSummary());
+    }
+    int findActivity(const string& name) const { return manager.sequentialSearchByName(name); }
+    const Activity* activityAt(int index) const { return manager.get(index); }   // O(1), nullptr if out of range
+
+    // owner thread only, like the other non-snapshot reads
+    MemoryFootprint footprint() const {
+        MemoryFootprint f;
+        f.payload = sizeof(*this);
+        addStringFootprint(f, climberName);
+        for (const ReportCache& cache : reportCache) addStringFootprint(f, cache.text);
+        manager.addFootprint(f);
+        events.addFootprint(f);
+        byLocation.addFootprint(f);
+        pyramid.addFootprint(f);
+        addStringFootprint(f, readSummary()->climberName);
+        return f;
+    }
+
+    // ==========================
+    // INTERACTIVE ADD CLIMB SESSION
+    // ==========================
+    void addClimbSession() {
+        cin.ignore(1000, '\n');
+        string name;
+        cout << "Enter climbing style: ";
+        getline(cin, name);
+
+        bool indoor = getYesNo("Is this climb indoor or outdoor? (Y=Indoor, N=Outdoor)");
+        ClimbDifficulty diff = promptDifficulty();
+        double hours = getValidatedDouble("Hours climbed this session: ", MIN_SESSION_HOURS, MAX_SESSION_HOURS);
+        Grade grade;
+        if (getYesNo("Record the hardest grade sent?")) {
+            string text;
+            do {
+                cout << "Grade (e.g. V4, 5.11a, 6b+): ";
+                cin >> text;
+                grade = Grade::parse(text);
+            } while (!grade.isValid());
+        }
+
+        // Allocate and immediately give to manager
+        ClimbSession* session = new ClimbSession(name, 0, diff, hours, Location(name, indoor));
+        session->setTimestamp(static_cast<long long>(time(nullptr)));
+        session->setGrade(grade);
+        manager.add(session);
+
+        totalHours += static_cast<int>(hours);
+        countSession(session, 1);
+        publishSummary();
+    }
+
+    // ==========================
+    // INTERACTIVE ADD TRAINING SESSION
+    // ==========================
+    void addTrainingSession() {
+        cin.ignore(1000, '\n');
+        string name;
+        cout << "Enter training name: ";
+        getline(cin, name);
+
+        ClimbDifficulty diff = promptDifficulty();
+        int reps = getValidatedInt("Enter reps: ", MIN_REPS, MAX_REPS);
+
+        TrainingSession* session = new TrainingSession(name, 0, diff, reps);
+        session->setTimestamp(static_cast<long long>(time(nullptr)));
+        manager.add(session);
+        countSession(session, 1);
+        publishSummary();
+
+        setColor(10);
+        cout << "Training session added.\n";
+        setColor(7);
+    }
+
+    // ==========================
+    // DISPLAY ACTIVITIES
+    // ==========================
+    void displayActivities() const {
+        if (manager.getSize() == 0) {
+            cout << "No activities recorded.\n";
+            return;
+        }
+
+        for (int i = 0; i < manager.getSize(); i++) {
+            cout << "-----------------------------\n";
+            manager.get(i)->print();
+        }
+    }
+
+    // ==========================
+    // REMOVE ACTIVITY
+    // ==========================
+    void removeActivity(int index) {
+        if (const Activity* act = manager.get(index)) {
+            countSession(act, -1);
+        }
+        manager.remove(index);
+        publishSummary();
+    }
+    int getManagerSize() const { return manager.getSize(); }
+    const ActivityManager& getActivities() const { return manager; }
+
+    // ==========================
+    // TRAINING LOAD
+    // ==========================
+    const TrainingLoadModel& getTrainingLoad() const {
+        events.flush();
+        return trainingLoad;
+    }
+
+    // ==========================
+    // LOCATION BREAKDOWN
+    // ==========================
+    const LocationGroupBy& getLocationStats() const {
+        events.flush();
+        return byLocation;
+    }
+
+    // for further subscribers (leaderboards, persistence logs, ...)
+    ActivityEventBus& getEventBus() { return events; }
+    void flushEvents() const {
+        TRACE_SPAN("drain events");
+        events.flush();
+    }
+
+    void displayLocations() const {
+        events.flush();
+        if (byLocation.getGroupCount() == 0) {
+            cout << "No climbs recorded.\n";
+            return;
+        }
+        setColor(11);
+        cout << "\n===== HOURS BY LOCATION =====\n";
+        setColor(7);
+        byLocation.print(cout);
+    }
+
+    // ==========================
+    // GRADE PYRAMID
+    // ==========================
+    const GradePyramid& getPyramid() const {
+        events.flush();
+        return pyramid;
+    }
+
+    void displayPyramid() const {
+        events.flush();
+        setColor(11);
+        cout << "\n======= GRADE PYRAMID =======\n";
+        setColor(7);
+        pyramid.render(cout, pyramid.preferredSystem());
+    }
+
+    // ==========================
+    // REPORT GENERATION
+    // ==========================
+    void generateReport() const {
+        TRACK_OP(TrackedOp::REPORT);
+        auto snap = readSummary();      // every figure below comes from this version
+        // Generate a table
+        setColor(11);
+        cout << "\n=================================\n";
+        cout << "       CLIMBING SUMMARY\n";
+        cout << "=================================\n";
+        setColor(7);
+
+        cout << renderedReport(ReportLayout::SCREEN, snap);
+
+        // these depend on today's date, so they are not cached with the summary
+        int today = static_cast<int>(time(nullptr) / SECONDS_PER_DAY);
+        cout << left << setw(SCREEN_LABEL_COLUMN) << "Acute:Chronic Load:"
+            << fixed << setprecision(2) << snap->trainingLoad.ratio(today)
+            << setprecision(1) << endl;
+
+        int recent = snap->grades.hardestSince(today - 90);
+        if (recent >= 0) {
+            cout << left << setw(SCREEN_LABEL_COLUMN) << "Hardest Grade (90 days):"
+                << gradeLabel(recent, snap->grades.preferred) << endl;
+        }
+
+        cout << "=================================\n";
+    }
+    // ==========================
+    // SAVE / LOAD
+    // ==========================
+    void saveToFile() const {
+        string filename;
+        cout << "Enter filename to save report: ";
+        cin >> filename;
+
+        if (writeReportFile(filename))
+            cout << "Report saved to " << filename << endl;
+        else
+            cout << "Error saving report.\n";
+    }
+
+    // non-interactive save used by the menu and by batch scripts
+    bool writeReportFile(const string& filename) const {
+        TRACK_OP(TrackedOp::SAVE);
+        ofstream outFile(filename);
+        if (!outFile) {
+            return false;
+        }
+
+        outFile << renderedReport(ReportLayout::SAVED);
+
+        outFile.close();
+        return static_cast<bool>(outFile);
+    }
+
+    void loadFromFile() const {
+        string filename;
+        cout << "Enter filename to load report: ";
+        cin >> filename;
+
+        string report = loadReport(filename);
+        cout << "\n----- LOADED REPORT -----\n";
+        cout << report << endl;
+    }
+
+    // ==========================
+    // UTILITY TEMPLATE
+    // ==========================
+    template <typename T>
+    T maxValue(T a, T b) {
+        return (a > b) ? a : b;
+    }
+};
+
+// ==========================
+// CLIMBER REGISTRY
+// the report inputs of every member, for jobs that cover the whole gym
+// ==========================
+class ClimberRegistry {
+private:
+    vector<TrackerSummary> members;
+
+public:
+    void add(const TrackerSummary& member) { members.push_back(member); }
+    void addTracker(const ClimbingTracker& tracker) { members.push_back(*tracker.readSummary()); }
+    void reserve(int count) { members.reserve(count); }
+    void clear() { members.clear(); }
+
+    int getSize() const { return static_cast<int>(members.size()); }
+
+    const TrackerSummary& operator[](int index) const {
+        if (index < 0 || index >= getSize()) {
+            throw IndexOutOfRange("ClimberRegistry::operator[] - invalid index");
+        }
+        return members[index];
+    }
+};
+// ==========================
+// ACTIVITY PAGER
+// a cursor over the tracker's activities. Only the current page is
+// rendered, into one reused buffer that writeToStdout sends to the
+// stdout descriptor in a single write. Rows come from the manager's
+// index, so jumping to any page is O(1) and a page costs the same
+// however long the list is.
+// ==========================
+const int PAGER_PAGE_SIZE = 20;
+
+class ActivityPager {
+private:
+    const ClimbingTracker& tracker;
+    int pageSize;
+    int page;
+    string screen;
+
+    // pads to width, or cuts the text so one space always separates columns
+    static void appendColumn(string& out, string_view text, size_t width) {
+        if (text.size() >= width) {
+            out.append(text.substr(0, width - 1));
+            out += ' ';
+            return;
+        }
+        out.append(text);
+        out.append(width - text.size(), ' ');
+    }
+
+    void appendRow(int index, const Activity& act) {
+        char field[64];
+        snprintf(field, sizeof(field), "%7d  ", index);
+        screen += field;
+
+        const ClimbSession* climb = dynamic_cast<const ClimbSession*>(&act);
+        const TrainingSession* training = dynamic_cast<const TrainingSession*>(&act);
+        appendColumn(screen, climb != nullptr ? "Climb" : (training != nullptr ? "Training" : "Other"), 10);
+        appendColumn(screen, act.getName(), 24);
+        appendColumn(screen, DIFFICULTY_LABELS[act.getDifficulty()], 11);
+        if (climb != nullptr) {
+            const Location& loc = climb->getLocationRef();
+            snprintf(field, sizeof(field), "%.1f hrs, ", climb->getHours());
+            screen += field;
+            screen += loc.getPlaceRef();
+            screen += loc.isIndoor() ? " (Indoor)" : " (Outdoor)";
+            if (climb->getGrade().isValid()) {
+                screen += ", ";
+                screen += gradeLabel(climb->getGrade().ordinal(), climb->getGrade().system());
+            }
+        }
+        else if (training != nullptr) {
+            snprintf(field, sizeof(field), "%d reps", training->getReps());
+            screen += field;
+        }
+        screen += '\n';
+    }
+
+public:
+    explicit ActivityPager(const ClimbingTracker& t, int rowsPerPage = PAGER_PAGE_SIZE)
+        : tracker(t), pageSize(rowsPerPage > 0 ? rowsPerPage : PAGER_PAGE_SIZE), page(0) {
+    }
+
+    int getPage() const { return page; }
+    int getPageCount() const { return max(1, (tracker.getActivityCount() + pageSize - 1) / pageSize); }
+
+    // pages past either end clamp to it
+    void goTo(int p) { page = max(0, min(p, getPageCount() - 1)); }
+    void next() { goTo(page + 1); }
+    void previous() { goTo(page - 1); }
+    void first() { goTo(0); }
+    void last() { goTo(getPageCount() - 1); }
+
+    // the current page and the navigation prompt
+    const string& render() {
+        goTo(page);   // the list may have shrunk since the last page
+        int count = tracker.getActivityCount();
+        int begin = page * pageSize;
+        int end = min(begin + pageSize, count);
+
+        screen.clear();
+        char line[128];
+        if (count == 0) {
+            screen += "No activities recorded.\n";
+        }
+        else {
+            snprintf(line, sizeof(line), "\nActivities %d-%d of %d (page %d of %d)\n",
+                begin + 1, end, count, page + 1, getPageCount());
+            screen += line;
+            screen += "  index  Type      Name                    Difficulty Details\n";
+            screen.append(79, '-');
+            screen += '\n';
+        }
+        for (int i = begin; i < end; i++)
+            if (const Activity* act = tracker.activityAt(i)) appendRow(i, *act);
+        screen += "[n]ext [p]revious [f]irst [l]ast [g]o <page> [q]uit: ";
+        return screen;
+    }
+
+    // whatever cout still holds (a ScreenOutput's screen, too) goes
+    // first; false when stdout could not take the page
+    bool show() {
+        const string& text = render();
+        if (ostream* tied = cin.tie()) tied->flush();
+        cout.flush();
+        return writeToStdout(text.data(), text.size());
+    }
+};
+
+// ==========================
+// COMMAND PROCESSOR
+// one command per line, fields separated by '|':
+//   add-climb <name>|<hours>|<difficulty>|<place>|<indoor|outdoor>[|<grade>[|<timestamp>]]
+//   add-training <name>|<difficulty>|<reps>[|<timestamp>]
+//   delete <index>
+//   query <name>
+//   report
+//   save <filename>
+//   name <climber name>
+//   days <climbing days per year>
+//   stats
+//   trace on|off|<filename>     (a filename writes the spans so far)
+// Each command appends one response line, "OK ..." or "ERR <reason>".
+// Service clients may not save or trace: both write files on the server
+// and trace switches tracing for the whole process.
+// In quiet mode successful updates (everything but query and report)
+// append nothing. Blank lines and lines starting with '#' are skipped.
+// ==========================
+class CommandProcessor {
+private:
+    ClimbingTracker& tracker;
+    bool quiet;
+    bool remote;        // service clients: no files, no process-wide switches
+
+    bool ok(string& response) {
+        if (!quiet) response += "OK\n";
+        return true;
+    }
+
+    bool okIndex(string& response, int index) {
+        if (!quiet) {
+            response += "OK ";
+            response += to_string(index);
+            response += '\n';
+        }
+        return true;
+    }
+
+    static string_view trim(string_view s) {
+        while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+        while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+        return s;
+    }
+
+    // returns the number of fields found (at most maxFields)
+    static int splitFields(string_view args, string_view* fields, int maxFields) {
+        int n = 0;
+        while (n < maxFields) {
+            size_t bar = args.find('|');
+            fields[n++] = trim(args.substr(0, bar));
+            if (bar == string_view::npos) break;
+            args.remove_prefix(bar + 1);
+        }
+        return n;
+    }
+
+    static bool sameText(string_view a, const char* b) {
+        size_t i = 0;
+        for (; i < a.size() && b[i] != '\0'; i++)
+            if (tolower(static_cast<unsigned char>(a[i])) != b[i]) return false;
+        return i == a.size() && b[i] == '\0';
+    }
+
+    // the whole field must be a decimal that fits; value is untouched otherwise
+    static bool parseLong(string_view text, long long& value) {
+        const char* end = text.data() + text.size();
+        from_chars_result r = from_chars(text.data(), end, value);
+        return r.ec == errc() && r.ptr == end;
+    }
+
+    // finite values only: nan, inf and overflowing exponents are refused
+    static bool parseDouble(string_view text, double& value) {
+        const char* end = text.data() + text.size();
+        double parsed = 0;
+        from_chars_result r = from_chars(text.data(), end, parsed);
+        if (r.ec != errc() || r.ptr != end || !isfinite(parsed)) return false;
+        value = parsed;
+        return true;
+    }
+
+    // 1-4 or the difficulty name
+    static bool parseDifficulty(string_view text, ClimbDifficulty& diff) {
+        long long n = 0;
+        if (parseLong(text, n)) {
+            if (n < EASY || n > EXTREME) return false;
+            diff = static_cast<ClimbDifficulty>(n);
+            return true;
+        }
+        const char* names[] = { "easy", "moderate", "hard", "extreme" };
+        for (int d = EASY; d <= EXTREME; d++) {
+            if (sameText(text, names[d - 1])) {
+                diff = static_cast<ClimbDifficulty>(d);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static bool fail(string& response, const char* reason) {
+        response += "ERR ";
+        response += reason;
+        response += '\n';
+        return false;
+    }
+
+    bool addClimb(string_view args, string& response) {
+        string_view f[7];
+        int n = splitFields(args, f, 7);
+        double hours = 0;
+        ClimbDifficulty diff = EASY;
+        if (n < 5 || f[0].empty()) return fail(response, "usage: add-climb name|hours|difficulty|place|indoor");
+        if (!parseDouble(f[1], hours) || hours < MIN_SESSION_HOURS || hours > MAX_SESSION_HOURS)
+            return fail(response, "bad hours");
+        if (!parseDifficulty(f[2], diff)) return fail(response, "bad difficulty");
+
+        bool indoor = sameText(f[4], "indoor") || sameText(f[4], "yes") || sameText(f[4], "y");
+        if (!indoor && !sameText(f[4], "outdoor") && !sameText(f[4], "no") && !sameText(f[4], "n"))
+            return fail(response, "bad indoor flag");
+
+        Grade grade;
+        if (n > 5 && !f[5].empty()) {
+            grade = Grade::parse(f[5]);
+            if (!grade.isValid()) return fail(response, "bad grade");
+        }
+        long long stamp = static_cast<long long>(time(nullptr));
+        if (n > 6 && (!parseLong(f[6], stamp) || stamp < 0 || stamp > MAX_TIMESTAMP))
+            return fail(response, "bad timestamp");
+
+        ClimbSession* session = new ClimbSession(string(f[0]), 0, diff, hours,
+            Location(string(f[3]), indoor));
+        session->setGrade(grade);
+        session->setTimestamp(stamp);
+        tracker.addSession(session);
+        return okIndex(response, tracker.getActivityCount() - 1);
+    }
+
+    bool addTraining(string_view args, string& response) {
+        string_view f[4];
+        int n = splitFields(args, f, 4);
+        ClimbDifficulty diff = EASY;
+        long long reps = 0;
+        if (n < 3 || f[0].empty()) return fail(response, "usage: add-training name|difficulty|reps");
+        if (!parseDifficulty(f[1], diff)) return fail(response, "bad difficulty");
+        if (!parseLong(f[2], reps) || reps < MIN_REPS || reps > MAX_REPS) return fail(response, "bad reps");
+        long long stamp = static_cast<long long>(time(nullptr));
+        if (n > 3 && (!parseLong(f[3], stamp) || stamp < 0 || stamp > MAX_TIMESTAMP))
+            return fail(response, "bad timestamp");
+
+        TrainingSession* session = new TrainingSession(string(f[0]), 0, diff, static_cast<int>(reps));
+        session->setTimestamp(stamp);
+        tracker.addSession(session);
+        return okIndex(response, tracker.getActivityCount() - 1);
+    }
+
+    bool remove(string_view args, string& response) {
+        long long index = 0;
+        if (!parseLong(args, index)) return fail(response, "usage: delete index");
+        if (index < 0 || index >= tracker.getActivityCount()) return fail(response, "invalid index");
+        tracker.removeActivity(static_cast<int>(index));
+        return ok(response);
+    }
+
+    static void appendNumber(string& out, double value) {
+        char text[32];
+        snprintf(text, sizeof(text), "%.10g", value);
+        out += text;
+    }
+
+    bool save(string_view args, string& response) {
+        if (remote) return fail(response, "save is not available to service clients");
+        if (args.empty()) return fail(response, "usage: save filename");
+        if (!tracker.writeReportFile(string(args))) return fail(response, "cannot write file");
+        return ok(response);
+    }
+
+    bool trace(string_view args, string& response) {
+        if (remote) return fail(response, "trace is not available to service clients");
+        if (args.empty()) return fail(response, "usage: trace on|off|filename");
+        if (args == "on" || args == "off") {
+            enableTracing(args == "on");
+            return ok(response);
+        }
+        long long spans = writeChromeTrace(string(args));
+        if (spans < 0) return fail(response, "cannot write file");
+        response += "OK ";
+        response += to_string(spans);
+        response += '\n';
+        return true;
+    }
+
+    bool setDays(string_view args, string& response) {
+        long long days = 0;
+        if (!parseLong(args, days) || days < 0 || days > 366) return fail(response, "usage: days 0-366");
+        tracker.setClimbingDays(static_cast<int>(days));
+        return ok(response);
+    }
+
+    bool query(string_view args, string& response) {
+        response += "OK ";
+        response += to_string(tracker.findActivity(string(args)));
+        response += '\n';
+        return true;
+    }
+
+    bool report(string& response) {
+        TRACK_OP(TrackedOp::REPORT);
+        response += tracker.renderedReport(ReportLayout::PROTOCOL);
+        return true;
+    }
+
+public:
+    explicit CommandProcessor(ClimbingTracker& t, bool quietMode = false, bool remoteClients = false)
+        : tracker(t), quiet(quietMode), remote(remoteClients) {
+    }
+
+    // blank lines and # comments are skipped, after trimming
+    static bool isCommand(string_view line) {
+        line = trim(line);
+        return !line.empty() && line.front() != '#';
+    }
+
+    // appends the response line; returns false when the command failed
+    bool execute(string_view line, string& response) {
+        if (!isCommand(line)) return true;
+        line = trim(line);
+
+        size_t space = line.find(' ');
+        string_view verb = line.substr(0, space);
+        string_view args = (space == string_view::npos) ? string_view() : trim(line.substr(space + 1));
+
+        if (verb == "add-climb") return addClimb(args, response);
+        if (verb == "add-training") return addTraining(args, response);
+        if (verb == "delete") return remove(args, response);
+        if (verb == "query") return query(args, response);
+        if (verb == "report") return report(response);
+        if (verb == "save") return save(args, response);
+        if (verb == "days") return setDays(args, response);
+        if (verb == "stats") {
+            response += "OK ";
+            response += opStatsJson(snapshotOpStats());
+            response += '\n';
+            return true;
+        }
+        if (verb == "name") {
+            tracker.setClimberName(string(args));
+            return ok(response);
+        }
+        if (verb == "trace") return trace(args, response);
+        return fail(response, "unknown command");
+    }
+
+    // the add-climb / add-training line that recreates act (export format)
+    static void appendCommand(string& out, const Activity& act) {
+        if (const ClimbSession* cs = dynamic_cast<const ClimbSession*>(&act)) {
+            Location loc = cs->getLocation();
+            out += "add-climb ";
+            out += act.getName();
+            out += '|';
+            appendNumber(out, cs->getHours());
+            out += '|';
+            out += to_string(static_cast<int>(act.getDifficulty()));
+            out += '|';
+            out += loc.getPlace();
+            out += loc.isIndoor() ? "|indoor|" : "|outdoor|";
+            if (cs->getGrade().isValid()) out += cs->getGrade().toString();
+        }
+        else if (const TrainingSession* ts = dynamic_cast<const TrainingSession*>(&act)) {
+            out += "add-training ";
+            out += act.getName();
+            out += '|';
+            out += to_string(static_cast<int>(act.getDifficulty()));
+            out += '|';
+            out += to_string(ts->getReps());
+        }
+        else {
+            return;
+        }
+        out += '|';
+        out += to_string(act.getTimestamp());
+        out += '\n';
+    }
+
+    // runs every complete line in text; returns the number of failures
+    int executeAll(string_view text, string& response) {
+        int failures = 0;
+        while (!text.empty()) {
+            size_t newline = text.find('\n');
+            if (!execute(text.substr(0, newline), response)) failures++;
+            if (newline == string_view::npos) break;
+            text.remove_prefix(newline + 1);
+        }
+        tracker.flushEvents();
+        return failures;
+    }
+};
+
+// ==========================
+// BATCH SCRIPTS
+// runs a whole command script with no prompts or colors; query/report
+// replies and "line N: ERR ..." failures go to out
+// ==========================
+struct BatchResult {
+    long long commands;
+    long long failures;
+    double seconds;
+};
+
+inline BatchResult runBatchScript(string_view script, ClimbingTracker& tracker, string& out) {
+    TRACE_SPAN("batch script");
+    CommandProcessor processor(tracker, true);
+    BatchResult result{ 0, 0, 0.0 };
+    auto start = chrono::steady_clock::now();
+
+    long long lineNumber = 0;
+    while (!script.empty()) {
+        size_t newline = script.find('\n');
+        string_view line = script.substr(0, newline);
+        lineNumber++;
+
+        size_t before = out.size();
+        if (!processor.execute(line, out)) {
+            out.insert(before, "line " + to_string(lineNumber) + ": ");
+            result.failures++;
+        }
+        if (CommandProcessor::isCommand(line)) result.commands++;
+
+        if (newline == string_view::npos) break;
+        script.remove_prefix(newline + 1);
+    }
+
+    tracker.flushEvents();
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+// whole file in one read; "-" reads standard input
+inline bool readWholeFile(const string& path, string& text) {
+    if (path == "-") {
+        ostringstream buffer;
+        buffer << cin.rdbuf();
+        text = buffer.str();
+        return true;
+    }
+    ifstream in(path, ios::binary);
+    if (!in) return false;
+    in.seekg(0, ios::end);
+    text.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0, ios::beg);
+    in.read(&text[0], static_cast<streamsize>(text.size()));
+    return static_cast<bool>(in) || in.eof();
+}
+
+#ifdef __linux__
+// ==========================
+// SHARED-MEMORY STORE (Linux)
+// Sessions in a POSIX shared-memory segment so other local processes
+// can read them in place. Everything is addressed by offset, so each
+// process may map the segment anywhere:
+//   ShmHeader | ShmRecord[recordCapacity] | string arena
+// One writer. Readers retry while the seqlock sequence is odd (write in
+// progress) or changed during their read, and give up with an error when
+// that lasts past a timeout (a writer that died mid-write never finishes).
+// ==========================
+const uint64_t SHM_MAGIC = 0x4B43415254424D43ULL;   // "CMBTRACK"
+const uint32_t SHM_LAYOUT = 1;
+
+struct ShmRecord {
+    uint32_t nameOffset;    // into the arena
+    uint32_t nameLength;
+    uint32_t placeOffset;
+    uint32_t placeLength;
+    double hours;
+    int64_t timestamp;
+    int32_t duration;
+    int32_t reps;
+    uint8_t kind;           // ActivityKind
+    uint8_t difficulty;
+    uint8_t indoor;
+    uint8_t grade;          // Grade::encoded()
+    uint32_t reserved;
+};
+
+struct ShmHeader {
+    uint64_t magic;
+    uint32_t layout;
+    uint32_t recordCapacity;
+    uint32_t arenaCapacity;
+    uint32_t reserved;
+    atomic<uint64_t> sequence;
+    atomic<uint32_t> count;
+    atomic<uint32_t> arenaUsed;
+};
+
+static_assert(atomic<uint64_t>::is_always_lock_free && atomic<uint32_t>::is_always_lock_free,
+    "shared-memory header needs address-free atomics");
+
+// what a reader sees during one seqlock attempt; offsets are bounds
+// checked because a torn read may carry garbage (the retry discards it)
+class ShmView {
+private:
+    const ShmRecord* records;
+    int count;
+    const char* arena;
+    uint32_t arenaSize;
+
+public:
+    ShmView(const ShmRecord* r, int n, const char* a, uint32_t size)
+        : records(r), count(n), arena(a), arenaSize(size) {
+    }
+
+    int getSize() const { return count; }
+    const ShmRecord& operator[](int i) const { return records[i]; }
+
+    string_view text(uint32_t offset, uint32_t length) const {
+        if (offset > arenaSize || length > arenaSize - offset) return string_view();
+        return string_view(arena + offset, length);
+    }
+    string_view name(const ShmRecord& r) const { return text(r.nameOffset, r.nameLength); }
+    string_view place(const ShmRecord& r) const { return text(r.placeOffset, r.placeLength); }
+
+    void copyTo(int i, ActivityRecord& out) const {
+        const ShmRecord& r = records[i];
+        out.kind = static_cast<ActivityKind>(r.kind);
+        out.name.assign(name(r));
+        out.place.assign(place(r));
+        out.indoor = r.indoor != 0;
+        out.hours = r.hours;
+        out.duration = r.duration;
+        out.reps = r.reps;
+        out.difficulty = static_cast<ClimbDifficulty>(r.difficulty);
+        out.grade = Grade::fromEncoded(r.grade);
+        out.timestamp = r.timestamp;
+    }
+};
+
+class SharedActivityStore {
+private:
+    string segmentName;
+    bool writable;
+    void* base;
+    size_t bytes;
+    ShmHeader* header;
+    ShmRecord* records;
+    char* arena;
+    int writeDepth;
+
+    static size_t layoutBytes(uint32_t recordCapacity, uint32_t arenaBytes) {
+        return sizeof(ShmHeader) + sizeof(ShmRecord) * static_cast<size_t>(recordCapacity) + arenaBytes;
+    }
+
+    void attach(void* mapping, size_t size) {
+        base = mapping;
+        bytes = size;
+        header = static_cast<ShmHeader*>(mapping);
+        records = reinterpret_cast<ShmRecord*>(static_cast<char*>(mapping) + sizeof(ShmHeader));
+        arena = reinterpret_cast<char*>(records + header->recordCapacity);
+    }
+
+    void requireWritable() const {
+        if (!writable) throw runtime_error("SharedActivityStore - segment opened read-only");
+    }
+
+    bool appendText(string_view text, uint32_t& offset) {
+        uint32_t used = header->arenaUsed.load(memory_order_relaxed);
+        if (text.size() > header->arenaCapacity - used) return false;
+        memcpy(arena + used, text.data(), text.size());
+        offset = used;
+        header->arenaUsed.store(used + static_cast<uint32_t>(text.size()), memory_order_relaxed);
+        return true;
+    }
+
+    // drops text of removed records; call inside a write
+    void compact() {
+        uint32_t n = header->count.load(memory_order_relaxed);
+        vector<char> live;
+        live.reserve(header->arenaUsed.load(memory_order_relaxed));
+        for (uint32_t i = 0; i < n; i++) {
+            ShmRecord& r = records[i];
+            uint32_t nameAt = static_cast<uint32_t>(live.size());
+            live.insert(live.end(), arena + r.nameOffset, arena + r.nameOffset + r.nameLength);
+            uint32_t placeAt = static_cast<uint32_t>(live.size());
+            live.insert(live.end(), arena + r.placeOffset, arena + r.placeOffset + r.placeLength);
+            r.nameOffset = nameAt;
+            r.placeOffset = placeAt;
+        }
+        if (!live.empty()) memcpy(arena, live.data(), live.size());
+        header->arenaUsed.store(static_cast<uint32_t>(live.size()), memory_order_relaxed);
+    }
+
+    bool encode(const ActivityRecord& rec, ShmRecord& out) {
+        uint32_t needed = static_cast<uint32_t>(rec.name.size() + rec.place.size());
+        if (needed > header->arenaCapacity - header->arenaUsed.load(memory_order_relaxed))
+            compact();
+        if (!appendText(rec.name, out.nameOffset) || !appendText(rec.place, out.placeOffset))
+            return false;
+        out.nameLength = static_cast<uint32_t>(rec.name.size());
+        out.placeLength = static_cast<uint32_t>(rec.place.size());
+        out.hours = rec.hours;
+        out.timestamp = rec.timestamp;
+        out.duration = rec.duration;
+        out.reps = rec.reps;
+        out.kind = static_cast<uint8_t>(rec.kind);
+        out.difficulty = static_cast<uint8_t>(rec.difficulty);
+        out.indoor = rec.indoor ? 1 : 0;
+        out.grade = rec.grade.encoded();
+        out.reserved = 0;
+        return true;
+    }
+
+public:
+    // creates (or resets) the segment; this process becomes the writer
+    SharedActivityStore(const string& name, uint32_t recordCapacity, uint32_t arenaBytes)
+        : segmentName(name), writable(true), base(nullptr), bytes(0),
+        header(nullptr), records(nullptr), arena(nullptr), writeDepth(0) {
+        int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+        if (fd < 0) throw runtime_error("SharedActivityStore - cannot create " + name);
+
+        size_t size = layoutBytes(recordCapacity, arenaBytes);
+        void* mapping = MAP_FAILED;
+        if (ftruncate(fd, static_cast<off_t>(size)) == 0)
+            mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) throw runtime_error("SharedActivityStore - cannot map " + name);
+
+        ShmHeader* h = new (mapping) ShmHeader{};
+        h->layout = SHM_LAYOUT;
+        h->recordCapacity = recordCapacity;
+        h->arenaCapacity = arenaBytes;
+        h->sequence.store(0);
+        h->count.store(0);
+        h->arenaUsed.store(0);
+        attach(mapping, size);
+        atomic_thread_fence(memory_order_release);
+        h->magic = SHM_MAGIC;   // last, so a reader never maps a half-built header
+    }
+
+    // maps an existing segment for reading
+    explicit SharedActivityStore(const string& name)
+        : segmentName(name), writable(false), base(nullptr), bytes(0),
+        header(nullptr), records(nullptr), arena(nullptr), writeDepth(0) {
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) throw runtime_error("SharedActivityStore - no segment named " + name);
+
+        struct stat info {};
+        void* mapping = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(ShmHeader))
+            mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) throw runtime_error("SharedActivityStore - cannot map " + name);
+
+        const ShmHeader* h = static_cast<const ShmHeader*>(mapping);
+        if (h->magic != SHM_MAGIC || h->layout != SHM_LAYOUT ||
+            layoutBytes(h->recordCapacity, h->arenaCapacity) > static_cast<size_t>(info.st_size)) {
+            munmap(mapping, static_cast<size_t>(info.st_size));
+            throw runtime_error("SharedActivityStore - " + name + " is not a tracker segment");
+        }
+        attach(mapping, static_cast<size_t>(info.st_size));
+    }
+
+    ~SharedActivityStore() {
+        if (base != nullptr) munmap(base, bytes);
+    }
+
+    SharedActivityStore(const SharedActivityStore&) = delete;
+    SharedActivityStore& operator=(const SharedActivityStore&) = delete;
+
+    // the segment outlives its processes until unlinked
+    static bool unlink(const string& name) { return shm_unlink(name.c_str()) == 0; }
+
+    // ==========================
+    // WRITER SIDE
+    // group several changes into one write; nested pairs share it
+    // ==========================
+    void beginWrite() {
+        requireWritable();
+        if (writeDepth++ == 0) {
+            header->sequence.store(header->sequence.load(memory_order_relaxed) + 1, memory_order_relaxed);
+            atomic_thread_fence(memory_order_release);
+        }
+    }
+
+    void endWrite() {
+        if (--writeDepth == 0)
+            header->sequence.store(header->sequence.load(memory_order_relaxed) + 1, memory_order_release);
+    }
+
+    // false when the records or the arena are full
+    bool insert(int position, const ActivityRecord& rec) {
+        uint32_t n = header->count.load(memory_order_relaxed);
+        if (position < 0 || static_cast<uint32_t>(position) > n)
+            throw IndexOutOfRange("SharedActivityStore::insert - invalid index");
+        if (n == header->recordCapacity) return false;
+
+        beginWrite();
+        ShmRecord encoded;
+        bool stored = encode(rec, encoded);
+        if (stored) {
+            memmove(records + position + 1, records + position, sizeof(ShmRecord) * (n - position));
+            records[position] = encoded;
+            header->count.store(n + 1, memory_order_relaxed);
+        }
+        endWrite();
+        return stored;
+    }
+
+    bool append(const ActivityRecord& rec) {
+        return insert(static_cast<int>(header->count.load(memory_order_relaxed)), rec);
+    }
+
+    bool replace(int position, const ActivityRecord& rec) {
+        if (position < 0 || static_cast<uint32_t>(position) >= header->count.load(memory_order_relaxed))
+            throw IndexOutOfRange("SharedActivityStore::replace - invalid index");
+        beginWrite();
+        ShmRecord encoded;
+        bool stored = encode(rec, encoded);
+        if (stored) records[position] = encoded;
+        endWrite();
+        return stored;
+    }
+
+    void remove(int position) {
+        uint32_t n = header->count.load(memory_order_relaxed);
+        if (position < 0 || static_cast<uint32_t>(position) >= n)
+            throw IndexOutOfRange("SharedActivityStore::remove - invalid index");
+        beginWrite();
+        memmove(records + position, records + position + 1, sizeof(ShmRecord) * (n - position - 1));
+        header->count.store(n - 1, memory_order_relaxed);
+        endWrite();
+    }
+
+    void clear() {
+        beginWrite();
+        header->count.store(0, memory_order_relaxed);
+        header->arenaUsed.store(0, memory_order_relaxed);
+        endWrite();
+    }
+
+    // ==========================
+    // READER SIDE
+    // reader(const ShmView&) may run more than once, so it should only
+    // compute from the view and start over on each call
+    // ==========================
+    template <typename Reader>
+    void read(Reader reader, chrono::milliseconds timeout = chrono::milliseconds(1000)) const {
+        chrono::steady_clock::time_point deadline{};
+        for (;;) {
+            uint64_t before = header->sequence.load(memory_order_acquire);
+            if ((before & 1) == 0) {
+                uint32_t n = header->count.load(memory_order_relaxed);
+                if (n > header->recordCapacity) n = header->recordCapacity;
+                reader(ShmView(records, static_cast<int>(n), arena, header->arenaCapacity));
+                atomic_thread_fence(memory_order_acquire);
+                if (header->sequence.load(memory_order_relaxed) == before) return;
+            }
+
+            // only retries look at the clock
+            auto now = chrono::steady_clock::now();
+            if (deadline == chrono::steady_clock::time_point{}) deadline = now + timeout;
+            else if (now >= deadline)
+                throw runtime_error("SharedActivityStore - " + segmentName + " is stuck in a write");
+            this_thread::yield();
+        }
+    }
+
+    vector<ActivityRecord> snapshot() const {
+        vector<ActivityRecord> out;
+        read([&out](const ShmView& view) {
+            out.resize(view.getSize());
+            for (int i = 0; i < view.getSize(); i++) view.copyTo(i, out[i]);
+        });
+        return out;
+    }
+
+    int getSize() const { return static_cast<int>(header->count.load()); }
+    uint64_t getVersion() const { return header->sequence.load() / 2; }
+    const string& getName() const { return segmentName; }
+};
+
+// keeps a store in step with an ActivityManager; one write per batch
+class SharedStoreMirror : public EventSubscriber {
+private:
+    SharedActivityStore& store;
+    long long dropped;
+
+public:
+    explicit SharedStoreMirror(SharedActivityStore& s) : store(s), dropped(0) {}
+
+    void onEvents(const ActivityEvent* events, size_t count) override {
+        store.beginWrite();
+        for (size_t i = 0; i < count; i++) {
+            const ActivityEvent& e = events[i];
+            bool stored = true;
+            try {
+                switch (e.type) {
+                case ActivityEventType::ADDED: stored = store.insert(e.position, e.activity); break;
+                case ActivityEventType::REMOVED: store.remove(e.position); break;
+                case ActivityEventType::UPDATED: stored = store.replace(e.position, e.activity); break;
+                case ActivityEventType::CLEARED: store.clear(); break;
+                }
+            }
+            catch (const IndexOutOfRange&) {
+                stored = false;   // out of step since an earlier drop
+            }
+            if (!stored) dropped++;
+        }
+        store.endWrite();
+    }
+
+    // changes that did not fit; positions after the first drop no longer line up
+    long long getDropped() const { return dropped; }
+};
+
+// ==========================
+// IMPORT / EXPORT
+// files of add-climb / add-training lines, read and written in fixed
+// size chunks; the sync versions are the baseline for the async ones
+// ==========================
+struct ImportResult {
+    long long commands;
+    long long failures;
+    long long bytes;
+    double seconds;
+};
+
+// feeds text chunk by chunk into a quiet CommandProcessor; a line may
+// straddle two chunks
+class CommandStream {
+private:
+    ClimbingTracker& tracker;
+    CommandProcessor processor;
+    string carry;
+    string errors;
+    long long commands;
+    long long failures;
+
+    void line(string_view text) {
+        if (!processor.execute(text, errors)) failures++;
+        if (CommandProcessor::isCommand(text)) commands++;
+    }
+
+public:
+    explicit CommandStream(ClimbingTracker& t) : tracker(t), processor(t, true), commands(0), failures(0) {}
+
+    void feed(const char* data, size_t size) {
+        TRACE_SPAN("import chunk");
+        string_view text(data, size);
+        if (!carry.empty()) {
+            size_t newline = text.find('\n');
+            if (newline == string_view::npos) {
+                carry.append(text);
+                return;
+            }
+            carry.append(text.substr(0, newline));
+            line(carry);
+            carry.clear();
+            text.remove_prefix(newline + 1);
+        }
+        for (;;) {
+            size_t newline = text.find('\n');
+            if (newline == string_view::npos) {
+                carry.assign(text);
+                return;
+            }
+            line(text.substr(0, newline));
+            text.remove_prefix(newline + 1);
+        }
+    }
+
+    void finish() {
+        if (!carry.empty()) line(carry);
+        carry.clear();
+        tracker.flushEvents();
+    }
+
+    long long getCommands() const { return commands; }
+    long long getFailures() const { return failures; }
+    const string& getErrors() const { return errors; }
+};
+
+const size_t IO_CHUNK_BYTES = 256 * 1024;
+
+inline ImportResult importCommandsSync(const string& path, ClimbingTracker& tracker, size_t chunkSize = IO_CHUNK_BYTES) {
+    TRACK_OP(TrackedOp::LOAD);
+    auto start = chrono::steady_clock::now();
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw runtime_error("Cannot open " + path);
+
+    CommandStream stream(tracker);
+    vector<char> buffer(chunkSize);
+    long long bytes = 0;
+    ssize_t n;
+    while ((n = read(fd, buffer.data(), buffer.size())) > 0) {
+        stream.feed(buffer.data(), static_cast<size_t>(n));
+        bytes += n;
+    }
+    close(fd);
+    if (n < 0) throw runtime_error("Read failed on " + path);
+    stream.finish();
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return ImportResult{ stream.getCommands(), stream.getFailures(), bytes, seconds };
+}
+
+// returns the bytes written
+inline long long exportCommandsSync(const string& path, const ActivityManager& mgr, size_t chunkSize = IO_CHUNK_BYTES) {
+    TRACK_OP(TrackedOp::SAVE);
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) throw runtime_error("Cannot create " + path);
+
+    string buffer;
+    buffer.reserve(chunkSize + 256);
+    long long bytes = 0;
+    bool ok = true;
+    auto flush = [&]() {
+        if (ok && !buffer.empty())
+            ok = write(fd, buffer.data(), buffer.size()) == static_cast<ssize_t>(buffer.size());
+        bytes += static_cast<long long>(buffer.size());
+        buffer.clear();
+    };
+    for (const Activity* act : mgr.select(mgr.allActivities())) {
+        CommandProcessor::appendCommand(buffer, *act);
+        if (buffer.size() >= chunkSize) flush();
+    }
+    flush();
+    close(fd);
+    if (!ok) throw runtime_error("Write failed on " + path);
+    return bytes;
+}
+
+#ifdef TRACKER_HAS_COROUTINES
+// ==========================
+// COROUTINE TASKS
+// Task<T> is lazy: it starts when awaited and resumes its awaiter when
+// done (symmetric transfer, so long chains do not grow the stack).
+// syncWait() runs a task from ordinary code and blocks for its result.
+// ==========================
+struct TaskPromiseBase {
+    coroutine_handle<> continuation = noop_coroutine();
+    exception_ptr error;
+
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        template <typename Promise>
+        coroutine_handle<> await_suspend(coroutine_handle<Promise> h) noexcept {
+            return h.promise().continuation;
+        }
+        void await_resume() noexcept {}
+    };
+
+    suspend_always initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() { error = current_exception(); }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+    T value{};
+    void return_value(T v) { value = std::move(v); }
+    T result() {
+        if (error) rethrow_exception(error);
+        return std::move(value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    void return_void() {}
+    void result() {
+        if (error) rethrow_exception(error);
+    }
+};
+
+// T must be default constructible
+template <typename T = void>
+class Task {
+public:
+    struct promise_type : TaskPromise<T> {
+        Task get_return_object() { return Task(coroutine_handle<promise_type>::from_promise(*this)); }
+    };
+
+private:
+    coroutine_handle<promise_type> handle;
+
+public:
+    explicit Task(coroutine_handle<promise_type> h) : handle(h) {}
+    Task(Task&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    Task& operator=(Task&&) = delete;
+    ~Task() {
+        if (handle) handle.destroy();
+    }
+
+    bool await_ready() const noexcept { return false; }
+    coroutine_handle<> await_suspend(coroutine_handle<> awaiter) noexcept {
+        handle.promise().continuation = awaiter;
+        return handle;
+    }
+    T await_resume() { return handle.promise().result(); }
+};
+
+class SyncLatch {
+private:
+    mutex lock;
+    condition_variable cv;
+    bool done = false;
+
+public:
+    void set() {
+        lock_guard<mutex> guard(lock);
+        done = true;
+        cv.notify_all();
+    }
+    void wait() {
+        unique_lock<mutex> guard(lock);
+        cv.wait(guard, [this] { return done; });
+    }
+};
+
+// signals the latch only once it is suspended, so the waiter may destroy it
+struct SyncWaitTask {
+    struct promise_type {
+        SyncLatch* latch = nullptr;
+
+        SyncWaitTask get_return_object() { return SyncWaitTask{ coroutine_handle<promise_type>::from_promise(*this) }; }
+        suspend_always initial_suspend() noexcept { return {}; }
+        auto final_suspend() noexcept {
+            struct Signal {
+                bool await_ready() noexcept { return false; }
+                void await_suspend(coroutine_handle<promise_type> h) noexcept { h.promise().latch->set(); }
+                void await_resume() noexcept {}
+            };
+            return Signal{};
+        }
+        void return_void() {}
+        void unhandled_exception() { terminate(); }
+    };
+
+    coroutine_handle<promise_type> handle;
+};
+
+// void tasks still get somewhere to store their (absent) result
+template <typename T>
+using SyncResult = conditional_t<is_void<T>::value, bool, T>;
+
+template <typename T>
+SyncWaitTask runForSyncWait(Task<T>& task, SyncResult<T>* out, exception_ptr* error) {
+    try {
+        if constexpr (is_void<T>::value) co_await task;
+        else *out = co_await task;
+    }
+    catch (...) {
+        *error = current_exception();
+    }
+}
+
+template <typename T>
+T syncWait(Task<T> task) {
+    SyncLatch latch;
+    exception_ptr error;
+    SyncResult<T> result{};
+    SyncWaitTask waiter = runForSyncWait(task, &result, &error);
+    waiter.handle.promise().latch = &latch;
+    waiter.handle.resume();
+    latch.wait();
+    waiter.handle.destroy();
+    if (error) rethrow_exception(error);
+    if constexpr (!is_void<T>::value) return result;
+}
+
+// ==========================
+// ASYNC FILE I/O
+// An IoOp is submitted first and awaited later, so several can be in
+// flight. Completion resumes the awaiting coroutine on the executor's
+// thread. IoThreadPool does blocking pread/pwrite on worker threads;
+// IoUringExecutor hands the same requests to the kernel via io_uring.
+// ==========================
+class IoOp {
+private:
+    enum { IDLE, SUBMITTED, WAITING, DONE };
+    atomic<int> state{ IDLE };
+    coroutine_handle<> waiter;
+
+public:
+    bool write = false;
+    int fd = -1;
+    char* buffer = nullptr;
+    size_t size = 0;
+    long long offset = 0;
+    long long result = 0;        // bytes transferred or -errno
+#ifdef TRACKER_HAS_IO_URING
+    iovec vec{};
+#endif
+
+    void prepare(bool isWrite, int file, char* data, size_t bytes, long long at) {
+        write = isWrite;
+        fd = file;
+        buffer = data;
+        size = bytes;
+        offset = at;
+        result = 0;
+        state.store(SUBMITTED, memory_order_relaxed);
+    }
+
+    // submitted and not yet awaited (it may already have finished)
+    bool inFlight() const { return state.load(memory_order_acquire) != IDLE; }
+
+    // called once by the executor
+    void complete(long long bytes) {
+        result = bytes;
+        if (state.exchange(DONE, memory_order_acq_rel) == WAITING)
+            waiter.resume();
+    }
+
+    // co_await op yields result; it does not suspend if the op already finished
+    struct Awaiter {
+        IoOp* op;
+
+        bool await_ready() const noexcept { return op->state.load(memory_order_acquire) == DONE; }
+        bool await_suspend(coroutine_handle<> h) noexcept {
+            op->waiter = h;
+            int expected = SUBMITTED;
+            return op->state.compare_exchange_strong(expected, WAITING, memory_order_acq_rel);
+        }
+        long long await_resume() {
+            op->state.store(IDLE, memory_order_relaxed);
+            return op->result;
+        }
+    };
+
+    Awaiter operator co_await() { return Awaiter{ this }; }
+};
+
+class IoExecutor {
+public:
+    virtual ~IoExecutor() {}
+    // ops must stay alive until they complete
+    virtual void submit(IoOp* const* ops, size_t count) = 0;
+    virtual const char* name() const = 0;
+    // submit blocks once more ops than this are in flight; awaiters resume on
+    // the executor's thread, so a coroutine must never go past it
+    virtual size_t capacity() const = 0;
+
+    void submit(IoOp* op) { submit(&op, 1); }
+};
+
+class IoThreadPool : public IoExecutor {
+private:
+    mpmcQueue<IoOp*> queue;
+    vector<thread> workers;
+
+    void work() {
+        IoOp* op;
+        while (queue.dequeue(op) == QueueStatus::OK) {
+            ssize_t n = op->write
+                ? pwrite(op->fd, op->buffer, op->size, static_cast<off_t>(op->offset))
+                : pread(op->fd, op->buffer, op->size, static_cast<off_t>(op->offset));
+            op->complete(n < 0 ? -errno : static_cast<long long>(n));
+        }
+    }
+
+public:
+    explicit IoThreadPool(int threads = 4) : queue(1024) {
+        for (int i = 0; i < (threads > 0 ? threads : 1); i++)
+            workers.emplace_back(&IoThreadPool::work, this);
+    }
+
+    ~IoThreadPool() override {
+        queue.close();
+        for (thread& t : workers) t.join();
+    }
+
+    void submit(IoOp* const* ops, size_t count) override {
+        for (size_t i = 0; i < count; i++) queue.enqueue(ops[i]);
+    }
+
+    const char* name() const override { return "thread pool"; }
+    size_t capacity() const override { return queue.capacity(); }
+};
+
+#ifdef TRACKER_HAS_IO_URING
+// raw io_uring (no liburing): one submission lock, one reaper thread that
+// waits for completions; READV/WRITEV keep it working on 5.1+ kernels
+class IoUringExecutor : public IoExecutor {
+private:
+    int ringFd;
+    unsigned entries;
+    void* sqMap;
+    size_t sqMapBytes;
+    void* cqMap;
+    size_t cqMapBytes;
+    io_uring_sqe* sqes;
+    size_t sqesBytes;
+
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned sqMask;
+    unsigned* sqArray;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned cqMask;
+    io_uring_cqe* cqes;
+
+    mutex submitLock;
+    condition_variable hasRoom;
+    unsigned inFlight;           // guarded by submitLock; kept <= entries so the CQ never overflows
+    thread reaper;
+
+    static int enter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+    }
+
+    // call with submitLock held
+    void push(uint8_t opcode, IoOp* op) {
+        unsigned tail = *sqTail;
+        unsigned index = tail & sqMask;
+        io_uring_sqe& sqe = sqes[index];
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = opcode;
+        if (op != nullptr) {
+            op->vec.iov_base = op->buffer;
+            op->vec.iov_len = op->size;
+            sqe.fd = op->fd;
+            sqe.addr = reinterpret_cast<uint64_t>(&op->vec);
+            sqe.len = 1;
+            sqe.off = static_cast<uint64_t>(op->offset);
+        }
+        sqe.user_data = reinterpret_cast<uint64_t>(op);
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    void submitPending(unsigned count) {
+        while (count > 0) {
+            int n = enter(ringFd, count, 0, 0);
+            if (n < 0) {
+                if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+                throw runtime_error("io_uring_enter failed");
+            }
+            count -= static_cast<unsigned>(n);
+        }
+    }
+
+    void reap() {
+        for (;;) {
+            if (enter(ringFd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) return;
+
+            unsigned head = *cqHead;
+            unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+            bool stopping = false;
+            unsigned finished = 0;
+            while (head != tail) {
+                io_uring_cqe cqe = cqes[head & cqMask];
+                head++;
+                if (cqe.user_data == 0) {
+                    stopping = true;
+                    continue;
+                }
+                finished++;
+                __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+                {
+                    lock_guard<mutex> lock(submitLock);
+                    inFlight--;
+                }
+                hasRoom.notify_all();
+                reinterpret_cast<IoOp*>(cqe.user_data)->complete(cqe.res);
+            }
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+            if (stopping) return;
+        }
+    }
+
+public:
+    explicit IoUringExecutor(unsigned queueDepth = 64)
+        : ringFd(-1), entries(0), sqMap(MAP_FAILED), sqMapBytes(0), cqMap(MAP_FAILED), cqMapBytes(0),
+        sqes(nullptr), sqesBytes(0), inFlight(0) {
+        io_uring_params params{};
+        ringFd = static_cast<int>(syscall(__NR_io_uring_setup, queueDepth, &params));
+        if (ringFd < 0) throw runtime_error("io_uring is not available");
+
+        entries = params.sq_entries;
+        sqMapBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqMapBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) sqMapBytes = cqMapBytes = (sqMapBytes > cqMapBytes ? sqMapBytes : cqMapBytes);
+
+        sqMap = mmap(nullptr, sqMapBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        cqMap = single ? sqMap
+            : mmap(nullptr, cqMapBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+        sqesBytes = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqeMap = mmap(nullptr, sqesBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+        if (sqMap == MAP_FAILED || cqMap == MAP_FAILED || sqeMap == MAP_FAILED) {
+            if (sqeMap != MAP_FAILED) munmap(sqeMap, sqesBytes);
+            if (cqMap != MAP_FAILED && cqMap != sqMap) munmap(cqMap, cqMapBytes);
+            if (sqMap != MAP_FAILED) munmap(sqMap, sqMapBytes);
+            close(ringFd);
+            throw runtime_error("io_uring rings could not be mapped");
+        }
+        sqes = static_cast<io_uring_sqe*>(sqeMap);
+
+        char* sq = static_cast<char*>(sqMap);
+        sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        char* cq = static_cast<char*>(cqMap);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        reaper = thread(&IoUringExecutor::reap, this);
+    }
+
+    ~IoUringExecutor() override {
+        {
+            unique_lock<mutex> lock(submitLock);
+            hasRoom.wait(lock, [this] { return inFlight < entries; });
+            push(IORING_OP_NOP, nullptr);   // user_data 0 stops the reaper
+            submitPending(1);
+        }
+        reaper.join();
+        munmap(sqes, sqesBytes);
+        if (cqMap != sqMap) munmap(cqMap, cqMapBytes);
+        munmap(sqMap, sqMapBytes);
+        close(ringFd);
+    }
+
+    // one io_uring_enter per call, however many ops
+    void submit(IoOp* const* ops, size_t count) override {
+        unique_lock<mutex> lock(submitLock);
+        size_t i = 0;
+        while (i < count) {
+            hasRoom.wait(lock, [this] { return inFlight < entries; });
+            unsigned batch = 0;
+            while (i < count && inFlight < entries) {
+                push(ops[i]->write ? IORING_OP_WRITEV : IORING_OP_READV, ops[i]);
+                inFlight++;
+                batch++;
+                i++;
+            }
+            submitPending(batch);
+        }
+    }
+
+    const char* name() const override { return "io_uring"; }
+    size_t capacity() const override { return entries; }
+};
+#endif
+
+// io_uring when the kernel allows it, otherwise the thread pool
+inline IoExecutor* makeIoExecutor(bool preferUring = true, int threads = 4, unsigned queueDepth = 64) {
+#ifdef TRACKER_HAS_IO_URING
+    if (preferUring) {
+        try {
+            return new IoUringExecutor(queueDepth);
+        }
+        catch (const runtime_error&) {
+        }
+    }
+#endif
+    (void)preferUring;
+    return new IoThreadPool(threads);
+}
+
+// ==========================
+// ASYNC IMPORT / EXPORT
+// up to depth chunks are in flight while the previous chunk is parsed
+// and inserted, so reading overlaps with the tracker work
+// ==========================
+inline Task<ImportResult> importCommandsAsync(IoExecutor& io, string path, ClimbingTracker& tracker,
+    int depth = 4, size_t chunkSize = IO_CHUNK_BYTES) {
+    auto start = chrono::steady_clock::now();
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw runtime_error("Cannot open " + path);
+    struct stat info {};
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw runtime_error("Cannot stat " + path);
+    }
+    long long fileSize = static_cast<long long>(info.st_size);
+    // never more chunks in flight than the executor can queue
+    depth = max(1, min<int>(depth, static_cast<int>(io.capacity())));
+
+    vector<vector<char>> buffers(depth, vector<char>(chunkSize));
+    vector<IoOp> ops(depth);
+    long long nextOffset = 0;
+    auto prepareNext = [&](int slot) {
+        size_t bytes = static_cast<size_t>(min<long long>(static_cast<long long>(chunkSize), fileSize - nextOffset));
+        ops[slot].prepare(false, fd, buffers[slot].data(), bytes, nextOffset);
+        nextOffset += static_cast<long long>(bytes);
+    };
+
+    vector<IoOp*> first;
+    for (int slot = 0; slot < depth && nextOffset < fileSize; slot++) {
+        prepareNext(slot);
+        first.push_back(&ops[slot]);
+    }
+    io.submit(first.data(), first.size());
+
+    CommandStream stream(tracker);
+    bool failed = false;
+    long long consumed = 0;
+    // every submitted read is awaited, even after a failure, before the buffers go away
+    for (int slot = 0; consumed < fileSize; slot = (slot + 1) % depth) {
+        size_t expected = ops[slot].size;
+        long long n = co_await ops[slot];
+        if (n != static_cast<long long>(expected)) {
+            failed = true;
+            break;
+        }
+        stream.feed(buffers[slot].data(), expected);
+        consumed += static_cast<long long>(expected);
+        if (nextOffset < fileSize) {
+            prepareNext(slot);
+            io.submit(&ops[slot]);
+        }
+    }
+    for (IoOp& op : ops)
+        if (op.inFlight()) co_await op;
+    close(fd);
+    if (failed) throw runtime_error("Read failed on " + path);
+    stream.finish();
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    co_return ImportResult{ stream.getCommands(), stream.getFailures(), fileSize, seconds };
+}
+
+// formats the next chunk while up to depth earlier chunks are being written
+inline Task<long long> exportCommandsAsync(IoExecutor& io, string path, const ActivityManager& mgr,
+    int depth = 4, size_t chunkSize = IO_CHUNK_BYTES) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) throw runtime_error("Cannot create " + path);
+    depth = max(1, min<int>(depth, static_cast<int>(io.capacity())));
+
+    vector<string> buffers(depth);
+    vector<IoOp> ops(depth);
+    long long offset = 0;
+    bool failed = false;
+    int slot = 0;
+
+    vector<const Activity*> all = mgr.select(mgr.allActivities());
+    size_t next = 0;
+    while (next < all.size()) {
+        if (ops[slot].inFlight()) {
+            size_t expected = ops[slot].size;
+            if (co_await ops[slot] != static_cast<long long>(expected)) failed = true;
+        }
+        string& buffer = buffers[slot];
+        buffer.clear();
+        while (next < all.size() && buffer.size() < chunkSize)
+            CommandProcessor::appendCommand(buffer, *all[next++]);
+        if (failed) break;
+
+        ops[slot].prepare(true, fd, &buffer[0], buffer.size(), offset);
+        offset += static_cast<long long>(buffer.size());
+        io.submit(&ops[slot]);
+        slot = (slot + 1) % depth;
+    }
+    for (IoOp& op : ops) {
+        if (!op.inFlight()) continue;
+        size_t expected = op.size;
+        if (co_await op != static_cast<long long>(expected)) failed = true;
+    }
+    close(fd);
+    if (failed) throw runtime_error("Write failed on " + path);
+    co_return offset;
+}
+
+// submits the writes in batches of up to batchSize (capped at the executor's
+// capacity), one executor call each; returns how many came back short or
+// failed and adds the bytes of the complete ones to written
+inline Task<int> writeFilesAsync(IoExecutor& io, const int* fds, const string_view* texts, size_t count,
+    long long& written, size_t batchSize = 256) {
+    batchSize = max<size_t>(1, min(batchSize, io.capacity()));
+    vector<IoOp> ops(batchSize);
+    vector<IoOp*> batch;
+    batch.reserve(batchSize);
+    int failures = 0;
+
+    for (size_t first = 0; first < count; first += batchSize) {
+        size_t size = min(batchSize, count - first);
+        batch.clear();
+        for (size_t i = 0; i < size; i++) {
+            if (fds[first + i] < 0) continue;   // the caller counts failed opens
+            const string_view& text = texts[first + i];
+            ops[i].prepare(true, fds[first + i], const_cast<char*>(text.data()), text.size(), 0);
+            batch.push_back(&ops[i]);
+        }
+        io.submit(batch.data(), batch.size());
+        for (IoOp* op : batch) {
+            long long expected = static_cast<long long>(op->size);
+            if (co_await *op == expected) written += expected;
+            else failures++;
+        }
+    }
+    co_return failures;
+}
+#endif
+
+// ==========================
+// BATCH REPORTS
+// every registry member's report, rendered in parallel into one
+// preallocated arena (a fixed slot per member), then written as
+// <directory>/<index>_<name>.txt. Files are opened and closed on
+// worker threads, a window at a time sized from the descriptor limit;
+// the writes go through the executor in batches when one is given
+// (io_uring), otherwise each worker pwrites and closes its share.
+// ==========================
+#ifndef TRACKER_HAS_COROUTINES
+class IoExecutor;   // batched async writes need C++20; pass nullptr
+#endif
+
+const size_t REPORT_OPEN_WINDOW = 4096;   // most report files open at once
+const size_t REPORT_FD_HEADROOM = 64;     // descriptors left for everything else
+
+// raises the process's soft descriptor limit toward what a batch of
+// `files` reports needs (up to the hard limit). The change lasts for
+// the rest of the process, so only the --report-batch mode calls it.
+inline void raiseReportDescriptorLimit(size_t files) {
+    size_t wanted = min(files, REPORT_OPEN_WINDOW) + REPORT_FD_HEADROOM;
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0) return;
+    if (limit.rlim_cur == RLIM_INFINITY || limit.rlim_cur >= wanted) return;
+    rlimit raised = limit;
+    raised.rlim_cur = (limit.rlim_max == RLIM_INFINITY || limit.rlim_max > wanted) ? wanted : limit.rlim_max;
+    if (raised.rlim_cur > limit.rlim_cur) setrlimit(RLIMIT_NOFILE, &raised);
+}
+
+// files open at once under the current soft descriptor limit, keeping
+// REPORT_FD_HEADROOM of it spare; the limit itself is left alone
+inline size_t reportOpenWindow(size_t files) {
+    rlimit limit{ 1024, 1024 };   // the usual default if the query fails
+    getrlimit(RLIMIT_NOFILE, &limit);
+    size_t soft = limit.rlim_cur == RLIM_INFINITY ? SIZE_MAX : static_cast<size_t>(limit.rlim_cur);
+    size_t window = soft > REPORT_FD_HEADROOM ? soft - REPORT_FD_HEADROOM : 1;
+    return max<size_t>(1, min({ window, files, REPORT_OPEN_WINDOW }));
+}
+
+struct ReportBatchResult {
+    int reports;
+    int failures;
+    long long bytes;
+    double renderSeconds;
+    double writeSeconds;
+};
+
+inline string reportFileName(const string& directory, int index, const string& name) {
+    string path = directory;
+    path += '/';
+    path += to_string(index);
+    path += '_';
+    for (char c : name)
+        path += isalnum(static_cast<unsigned char>(c)) || c == '-' ? c : '_';
+    path += ".txt";
+    return path;
+}
+
+inline ReportBatchResult writeClimberReports(const ClimberRegistry& registry, const string& directory,
+    IoExecutor* io = nullptr, unsigned threads = thread::hardware_concurrency()) {
+    ReportBatchResult result{ registry.getSize(), 0, 0, 0.0, 0.0 };
+    size_t n = static_cast<size_t>(registry.getSize());
+    if (threads == 0) threads = 1;
+    if (n < threads) threads = n > 0 ? static_cast<unsigned>(n) : 1;
+    auto range = [n, threads](size_t part, size_t& begin, size_t& end) {
+        begin = n * part / threads;
+        end = n * (part + 1) / threads;
+    };
+
+    auto start = chrono::steady_clock::now();
+    size_t slotBytes = REPORT_FIXED_BYTES;
+    for (size_t i = 0; i < n; i++)
+        slotBytes = max(slotBytes, REPORT_FIXED_BYTES + registry[static_cast<int>(i)].climberName.size());
+
+    vector<char> arena(n * slotBytes);
+    vector<string_view> texts(n);
+    runParallel(threads, [&](size_t part) {
+        TRACE_SPAN("render reports");
+        size_t begin, end;
+        range(part, begin, end);
+        for (size_t i = begin; i < end; i++) {
+            char* slot = arena.data() + i * slotBytes;
+            texts[i] = string_view(slot, renderReport(registry[static_cast<int>(i)], slot, slotBytes));
+        }
+    });
+    auto rendered = chrono::steady_clock::now();
+    result.renderSeconds = chrono::duration<double>(rendered - start).count();
+
+    size_t openWindow = reportOpenWindow(n);
+    vector<int> fds(openWindow, -1);
+    atomic<int> failures{ 0 };
+    atomic<long long> written{ 0 };
+    for (size_t first = 0; first < n; first += openWindow) {
+        size_t count = min(openWindow, n - first);
+        auto window = [&](size_t part, size_t& begin, size_t& end) {
+            begin = count * part / threads;
+            end = count * (part + 1) / threads;
+        };
+        runParallel(threads, [&](size_t part) {
+            TRACE_SPAN("open and write reports");
+            size_t begin, end;
+            window(part, begin, end);
+            for (size_t i = begin; i < end; i++) {
+                int member = static_cast<int>(first + i);
+                string path = reportFileName(directory, member, registry[member].climberName);
+                fds[i] = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+                if (fds[i] < 0) {
+                    failures++;
+                    continue;
+                }
+                if (io != nullptr) continue;
+                const string_view& text = texts[first + i];
+                if (pwrite(fds[i], text.data(), text.size(), 0) == static_cast<ssize_t>(text.size()))
+                    written += static_cast<long long>(text.size());
+                else
+                    failures++;
+                if (close(fds[i]) != 0) failures++;
+                fds[i] = -1;
+            }
+        });
+#ifdef TRACKER_HAS_COROUTINES
+        if (io != nullptr) {
+            TRACE_SPAN("async report writes");
+            long long batchBytes = 0;
+            failures += syncWait(writeFilesAsync(*io, fds.data(), texts.data() + first, count, batchBytes));
+            written += batchBytes;
+        }
+#endif
+        if (io == nullptr) continue;   // the pwrite path closed its files already
+        runParallel(threads, [&](size_t part) {
+            TRACE_SPAN("close reports");
+            size_t begin, end;
+            window(part, begin, end);
+            for (size_t i = begin; i < end; i++)
+                if (fds[i] >= 0 && close(fds[i]) != 0) failures++;
+        });
+    }
+
+    result.bytes = written.load();
+    result.failures = failures.load();
+    result.writeSeconds = chrono::duration<double>(chrono::steady_clock::now() - rendered).count();
+    return result;
+}
+
+// ==========================
+// SERVICE MODE (Linux)
+// endpoints: "unix:<path>" or "tcp:<port>" (bound to 127.0.0.1 only).
+// An epoll loop owns the sockets; complete lines from a connection are
+// handed to a worker pool as one batch, at most one batch in flight per
+// connection so responses keep request order.
+// ==========================
+inline sockaddr_storage endpointAddress(const string& endpoint, socklen_t& length) {
+    sockaddr_storage storage{};
+    if (endpoint.compare(0, 5, "unix:") == 0) {
+        sockaddr_un* addr = reinterpret_cast<sockaddr_un*>(&storage);
+        string path = endpoint.substr(5);
+        if (path.empty() || path.size() >= sizeof(addr->sun_path))
+            throw runtime_error("bad unix socket path: " + path);
+        addr->sun_family = AF_UNIX;
+        copy(path.begin(), path.end(), addr->sun_path);
+        length = static_cast<socklen_t>(sizeof(sockaddr_un));
+    }
+    else if (endpoint.compare(0, 4, "tcp:") == 0) {
+        sockaddr_in* addr = reinterpret_cast<sockaddr_in*>(&storage);
+        int port = atoi(endpoint.c_str() + 4);
+        if (port <= 0 || port > 65535)
+            throw runtime_error("bad tcp port: " + endpoint);
+        addr->sin_family = AF_INET;
+        addr->sin_port = htons(static_cast<uint16_t>(port));
+        addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        length = static_cast<socklen_t>(sizeof(sockaddr_in));
+    }
+    else {
+        throw runtime_error("endpoint must be unix:<path> or tcp:<port>");
+    }
+    return storage;
+}
+
+inline int connectEndpoint(const string& endpoint) {
+    socklen_t length = 0;
+    sockaddr_storage addr = endpointAddress(endpoint, length);
+    int fd = socket(addr.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), length) != 0) {
+        if (fd >= 0) close(fd);
+        throw runtime_error("cannot connect to " + endpoint);
+    }
+    if (addr.ss_family == AF_INET) {
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+    return fd;
+}
+
+// per-connection cap on buffered requests and unread responses; past it
+// the server stops reading until the client catches up
+const size_t SERVICE_BUFFER_LIMIT = 1 << 20;
+
+class TrackerServer {
+private:
+    static const uint64_t LISTENER_ID = 0;
+    static const uint64_t WAKE_ID = 1;
+
+    struct Connection {
+        int fd;
+        string in;          // bytes after the last complete line
+        string pending;     // complete lines waiting for a worker
+        string out;         // responses not yet written
+        bool busy = false;
+        bool closing = false;       // no more requests will be read
+        bool peerGone = false;      // hung up: responses are dropped
+        uint32_t interest = 0;      // epoll events registered, 0 when not registered
+
+        size_t buffered() const { return in.size() + pending.size() + out.size(); }
+    };
+
+    struct Batch {
+        uint64_t conn;
+        string text;        // requests going in, responses coming back
+    };
+
+    ClimbingTracker& tracker;
+    mutex trackerLock;
+    CommandProcessor processor;
+    string endpoint;
+
+    int listenFd = -1;
+    int epollFd = -1;
+    int wakeFd = -1;
+    atomic<bool> stopping{ false };
+
+    unordered_map<uint64_t, Connection> conns;
+    uint64_t nextId = 2;
+
+    vector<thread> workers;
+    mutex queueLock;
+    condition_variable queueReady;
+    deque<Batch> queue;
+    bool shuttingDown = false;
+
+    mutex doneLock;
+    vector<Batch> done;
+
+    void wake() {
+        uint64_t one = 1;
+        ssize_t ignored = write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    void workerLoop() {
+        for (;;) {
+            Batch batch;
+            {
+                unique_lock<mutex> lock(queueLock);
+                queueReady.wait(lock, [this] { return shuttingDown || !queue.empty(); });
+                if (queue.empty()) return;
+                batch = std::move(queue.front());
+                queue.pop_front();
+            }
+
+            string response;
+            {
+                lock_guard<mutex> lock(trackerLock);
+                processor.executeAll(batch.text, response);
+            }
+            batch.text.swap(response);
+
+            {
+                lock_guard<mutex> lock(doneLock);
+                done.push_back(std::move(batch));
+            }
+            wake();
+        }
+    }
+
+    void watch(uint64_t id, int fd, uint32_t events, int op) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.u64 = id;
+        epoll_ctl(epollFd, op, fd, &ev);
+    }
+
+    // reads only while under the buffer cap and not closing; a connection
+    // with nothing to wait for is taken out of the set so level-triggered
+    // hang-ups do not spin the loop while a worker holds its batch
+    void updateInterest(uint64_t id, Connection& c) {
+        uint32_t want = 0;
+        if (!c.closing && c.buffered() < SERVICE_BUFFER_LIMIT) want |= EPOLLIN | EPOLLRDHUP;
+        if (!c.out.empty()) want |= EPOLLOUT;
+        if (want == c.interest) return;
+        if (want == 0) epoll_ctl(epollFd, EPOLL_CTL_DEL, c.fd, nullptr);
+        else watch(id, c.fd, want, c.interest == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD);
+        c.interest = want;
+    }
+
+    // held back while the client has a full buffer of unread responses
+    void dispatch(uint64_t id, Connection& c) {
+        if (c.busy || c.pending.empty() || c.out.size() >= SERVICE_BUFFER_LIMIT) return;
+        c.busy = true;
+        {
+            lock_guard<mutex> lock(queueLock);
+            queue.push_back(Batch{ id, std::move(c.pending) });
+        }
+        c.pending.clear();
+        queueReady.notify_one();
+    }
+
+    void closeConnection(uint64_t id) {
+        auto found = conns.find(id);
+        if (found == conns.end()) return;
+        if (found->second.interest != 0) epoll_ctl(epollFd, EPOLL_CTL_DEL, found->second.fd, nullptr);
+        close(found->second.fd);
+        conns.erase(found);
+    }
+
+    // sends what the socket takes, hands pending lines to a worker and
+    // updates the interest set; returns false if the connection was closed
+    bool pump(uint64_t id, Connection& c) {
+        if (c.peerGone) c.out.clear();
+        while (!c.out.empty()) {
+            ssize_t n = send(c.fd, c.out.data(), c.out.size(), MSG_NOSIGNAL);
+            if (n > 0) {
+                c.out.erase(0, static_cast<size_t>(n));
+            }
+            else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            else if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            else {
+                closeConnection(id);
+                return false;
+            }
+        }
+
+        dispatch(id, c);
+        if (c.closing && !c.busy && c.pending.empty() && c.out.empty()) {
+            closeConnection(id);
+            return false;
+        }
+        updateInterest(id, c);
+        return true;
+    }
+
+    void acceptAll() {
+        for (;;) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;
+            uint64_t id = nextId++;
+            Connection c;
+            c.fd = fd;
+            updateInterest(id, conns.emplace(id, std::move(c)).first->second);
+        }
+    }
+
+    void readFrom(uint64_t id, Connection& c) {
+        char buffer[65536];
+        while (!c.closing && c.buffered() < SERVICE_BUFFER_LIMIT) {
+            ssize_t n = read(c.fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                c.in.append(buffer, static_cast<size_t>(n));
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) c.closing = true;
+            break;
+        }
+
+        size_t lastNewline = c.in.rfind('\n');
+        if (lastNewline != string::npos) {
+            c.pending.append(c.in, 0, lastNewline + 1);
+            c.in.erase(0, lastNewline + 1);
+        }
+        if (c.closing && !c.in.empty()) {          // last command had no newline
+            c.pending += c.in;
+            c.pending += '\n';
+            c.in.clear();
+        }
+        else if (c.in.size() >= SERVICE_BUFFER_LIMIT) {
+            c.out += "ERR line too long\n";
+            c.in.clear();
+            c.closing = true;
+        }
+        pump(id, c);
+    }
+
+    void completeBatches() {
+        uint64_t counter = 0;
+        ssize_t ignored = read(wakeFd, &counter, sizeof(counter));
+        (void)ignored;
+
+        vector<Batch> finished;
+        {
+            lock_guard<mutex> lock(doneLock);
+            finished.swap(done);
+        }
+        for (Batch& batch : finished) {
+            auto found = conns.find(batch.conn);
+            if (found == conns.end()) continue;
+            Connection& c = found->second;
+            c.out += batch.text;
+            c.busy = false;
+            pump(batch.conn, c);
+        }
+    }
+
+public:
+    TrackerServer(ClimbingTracker& t, const string& ep, int workerCount = 4)
+        : tracker(t), processor(t, false, true), endpoint(ep) {
+        socklen_t length = 0;
+        sockaddr_storage addr = endpointAddress(endpoint, length);
+        if (addr.ss_family == AF_UNIX) unlink(endpoint.c_str() + 5);
+
+        listenFd = socket(addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int on = 1;
+        if (listenFd < 0 || setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0 || ::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), length) != 0
+            || listen(listenFd, 512) != 0) {
+            if (listenFd >= 0) close(listenFd);
+            throw runtime_error("cannot listen on " + endpoint);
+        }
+
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        watch(LISTENER_ID, listenFd, EPOLLIN, EPOLL_CTL_ADD);
+        watch(WAKE_ID, wakeFd, EPOLLIN, EPOLL_CTL_ADD);
+
+        for (int i = 0; i < (workerCount > 0 ? workerCount : 1); i++)
+            workers.emplace_back(&TrackerServer::workerLoop, this);
+    }
+
+    TrackerServer(const TrackerServer&) = delete;
+    TrackerServer& operator=(const TrackerServer&) = delete;
+
+    ~TrackerServer() {
+        {
+            lock_guard<mutex> lock(queueLock);
+            shuttingDown = true;
+        }
+        queueReady.notify_all();
+        for (thread& w : workers) w.join();
+
+        for (auto& entry : conns) close(entry.second.fd);
+        close(listenFd);
+        close(epollFd);
+        close(wakeFd);
+        if (endpoint.compare(0, 5, "unix:") == 0) unlink(endpoint.c_str() + 5);
+    }
+
+    // blocks until stop(); safe to call stop() from any thread or a signal handler
+    void run() {
+        epoll_event events[64];
+        while (!stopping.load()) {
+            int n = epoll_wait(epollFd, events, 64, -1);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            for (int i = 0; i < n && !stopping.load(); i++) {
+                uint64_t id = events[i].data.u64;
+                if (id == LISTENER_ID) {
+                    acceptAll();
+                }
+                else if (id == WAKE_ID) {
+                    completeBatches();
+                }
+                else {
+                    auto found = conns.find(id);
+                    if (found == conns.end()) continue;
+                    Connection& c = found->second;
+                    if (events[i].events & (EPOLLHUP | EPOLLERR)) c.peerGone = true;
+                    if (!c.closing && (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)))
+                        readFrom(id, c);
+                    else
+                        pump(id, c);
+                }
+            }
+        }
+    }
+
+    void stop() {
+        stopping.store(true);
+        wake();
+    }
+};
+
+// ==========================
+// LOAD GENERATOR
+// each client pipelines `depth` add-climb requests, then reads the replies
+// ==========================
+struct LoadResult {
+    long long requests;
+    long long errors;
+    double seconds;
+};
+
+inline LoadResult runLoadGenerator(const string& endpoint, int clients, int requestsPerClient, int depth = 32) {
+    atomic<long long> errors{ 0 };
+    atomic<long long> completed{ 0 };
+    if (depth < 1) depth = 1;
+
+    auto client = [&](int clientId) {
+        int fd = -1;
+        try {
+            fd = connectEndpoint(endpoint);
+        }
+        catch (const std::exception&) {
+            errors += requestsPerClient;
+            return;
+        }
+        string batch;
+        char buffer[65536];
+
+        for (int sent = 0; sent < requestsPerClient;) {
+            int window = min(depth, requestsPerClient - sent);
+            batch.clear();
+            for (int k = 0; k < window; k++) {
+                int i = sent + k;
+                batch += "add-climb Load-" + to_string(clientId) + "-" + to_string(i)
+                    + "|1.5|" + to_string(1 + i % 4) + "|Wall " + to_string(clientId % 4)
+                    + (i % 2 ? "|indoor\n" : "|outdoor\n");
+            }
+            if (send(fd, batch.data(), batch.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(batch.size()))
+                break;
+
+            int replies = 0;
+            bool lineStart = true;
+            while (replies < window) {
+                ssize_t n = read(fd, buffer, sizeof(buffer));
+                if (n <= 0) break;
+                for (ssize_t b = 0; b < n; b++) {
+                    if (lineStart && buffer[b] == 'E') errors++;
+                    lineStart = buffer[b] == '\n';
+                    if (lineStart) replies++;
+                }
+            }
+            completed += replies;
+            if (replies < window) break;
+            sent += window;
+        }
+        close(fd);
+    };
+
+    auto start = chrono::steady_clock::now();
+    vector<thread> pool;
+    for (int c = 0; c < clients; c++)
+        pool.emplace_back(client, c);
+    for (thread& t : pool) t.join();
+
+    return LoadResult{ completed.load(), errors.load(),
+        chrono::duration<double>(chrono::steady_clock::now() - start).count() };
+}
+#endif
+
+// ==========================
+// WORKLOAD GENERATOR
+// seeded synthetic climbers for load tests. Each climber draws from its
+// own splitmix64 stream, so a seed and profile give the same activities
+// on every platform, climber by climber in any order: skews are whole
+// powers taken in 32-bit fixed point and hours are counted in quarters,
+// so no draw goes through pow() or rounding. Command files use the text
+// CommandProcessor::appendCommand writes, one file per climber.
+// ==========================
+inline uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+struct WorkloadProfile {
+    uint64_t seed = 1;
+    int climbers = 1;
+    int activitiesPerClimber = 1000;
+    double climbShare = 0.75;               // the rest are training sessions
+    double indoorShare = 0.6;
+    double gradedShare = 0.5;               // outdoor climbs with a YDS grade
+    double minHours = 0.5;                  // climbs last whole quarter hours
+    double maxHours = 4.0;
+    int hoursSkew = 2;                      // above 1 favours short climbs
+    int difficultyWeights[4] = { 40, 30, 20, 10 };   // EASY..EXTREME
+    int placeCount = 40;
+    int placeSkew = 2;                      // above 1 a few places get most visits
+    int minReps = 5;
+    int maxReps = 60;
+    long long startTimestamp = 1704067200;  // 2024-01-01 00:00 UTC
+    int days = 365;                         // activities spread evenly over these
+};
+
+const char* const WORKLOAD_PLACES[] = { "Red River Gorge", "Boulder Barn", "Granite Peak", "Summit Gym",
+    "Cedar Crag", "Eagle Bluff", "Old Quarry", "Box Canyon", "Vertical World", "Sandstone Ridge" };
+const char* const WORKLOAD_ROUTES[] = { "Arete", "Crimp Line", "Dihedral", "Slab", "Roof",
+    "Chimney", "Traverse", "Overhang" };
+const char* const WORKLOAD_DRILLS[] = { "Hangboard", "Campus Board", "Pull-ups", "Core", "Antagonists",
+    "Repeaters" };
+
+inline void appendDecimal(string& out, long long value) {
+    char digits[24];
+    to_chars_result r = to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, r.ptr);
+}
+
+inline string workloadClimberName(int climber) {
+    string name = "Climber ";
+    appendDecimal(name, climber + 1);
+    return name;
+}
+
+class WorkloadGenerator {
+private:
+    WorkloadProfile profile;
+    vector<string> places;
+    int difficultyTotal;
+    int minQuarters;
+    int maxQuarters;
+    uint64_t state;
+    int produced;
+
+    double uniform() { return static_cast<double>(splitMix64(state) >> 11) * 0x1.0p-53; }
+
+    // low..high inclusive
+    int between(int low, int high) {
+        if (high <= low) return low;
+        return low + static_cast<int>(splitMix64(state) % static_cast<uint64_t>(high - low + 1));
+    }
+
+    // a uniform 32-bit fraction raised to power, in 0..2^32-1
+    uint64_t skewedFraction(int power) {
+        uint64_t x = splitMix64(state) >> 32;
+        uint64_t f = x;
+        for (int p = 1; p < power; p++) f = (f * x) >> 32;
+        return f;
+    }
+
+    // 0..count-1, weighted towards 0 when skew > 1
+    int skewed(int count, int skew) {
+        return static_cast<int>((static_cast<uint64_t>(count) * skewedFraction(skew)) >> 32);
+    }
+
+    void appendNamed(string& out, const char* stem) {
+        out.assign(stem);
+        out += ' ';
+        appendDecimal(out, between(1, 99));
+    }
+
+public:
+    WorkloadGenerator(const WorkloadProfile& p, int climber)
+        : profile(p), difficultyTotal(0), minQuarters(0), maxQuarters(0),
+        state(p.seed ^ (0x9E3779B97F4A7C15ULL * (climber + 1ULL))), produced(0) {
+        if (profile.placeCount < 1) profile.placeCount = 1;
+        if (profile.days < 1) profile.days = 1;
+        minQuarters = max(1, static_cast<int>(llround(profile.minHours * 4.0)));
+        maxQuarters = max(minQuarters, static_cast<int>(llround(profile.maxHours * 4.0)));
+        for (int w : profile.difficultyWeights) difficultyTotal += max(w, 0);
+
+        const int stems = static_cast<int>(sizeof(WORKLOAD_PLACES) / sizeof(WORKLOAD_PLACES[0]));
+        places.resize(profile.placeCount);
+        for (int i = 0; i < profile.placeCount; i++) {
+            places[i] = WORKLOAD_PLACES[i % stems];
+            if (i >= stems) {
+                places[i] += ' ';
+                appendDecimal(places[i], i / stems + 1);
+            }
+        }
+        splitMix64(state);   // separate neighbouring climbers before the first draw
+    }
+
+    bool done() const { return produced >= profile.activitiesPerClimber; }
+    int getProduced() const { return produced; }
+
+    // the next activity; reuses the record's string buffers
+    void next(ActivityRecord& out) {
+        long long day = static_cast<long long>(produced) * profile.days / max(profile.activitiesPerClimber, 1);
+        out.timestamp = profile.startTimestamp + day * SECONDS_PER_DAY + between(7 * 3600, 21 * 3600);
+        out.duration = 0;
+
+        int pick = between(0, max(difficultyTotal, 1) - 1);
+        int d = 0;
+        while (d < 3 && pick >= max(profile.difficultyWeights[d], 0)) pick -= max(profile.difficultyWeights[d++], 0);
+        out.difficulty = static_cast<ClimbDifficulty>(EASY + d);
+
+        if (uniform() < profile.climbShare) {
+            out.kind = ActivityKind::CLIMB;
+            appendNamed(out.name, WORKLOAD_ROUTES[between(0, sizeof(WORKLOAD_ROUTES) / sizeof(WORKLOAD_ROUTES[0]) - 1)]);
+            out.place = places[skewed(profile.placeCount, profile.placeSkew)];
+            out.indoor = uniform() < profile.indoorShare;
+            uint64_t span = static_cast<uint64_t>(maxQuarters - minQuarters);
+            int quarters = minQuarters + static_cast<int>((span * skewedFraction(profile.hoursSkew) + (1ULL << 31)) >> 32);
+            out.hours = quarters / 4.0;
+            out.reps = 0;
+            out.grade = Grade();
+            if (!out.indoor && uniform() < profile.gradedShare)   // six YDS grades per difficulty step
+                out.grade = Grade(4 + d * 6 + between(0, 5), YDS);
+        }
+        else {
+            out.kind = ActivityKind::TRAINING;
+            appendNamed(out.name, WORKLOAD_DRILLS[between(0, sizeof(WORKLOAD_DRILLS) / sizeof(WORKLOAD_DRILLS[0]) - 1)]);
+            out.place.clear();
+            out.indoor = false;
+            out.hours = 0.0;
+            out.reps = between(profile.minReps, profile.maxReps);
+            out.grade = Grade();
+        }
+        produced++;
+    }
+};
+
+inline Activity* activityFromRecord(const ActivityRecord& r) {
+    Activity* act;
+    if (r.kind == ActivityKind::CLIMB) {
+        ClimbSession* climb = new ClimbSession(r.name, r.duration, r.difficulty, r.hours, Location(r.place, r.indoor));
+        climb->setGrade(r.grade);
+        act = climb;
+    }
+    else {
+        act = new TrainingSession(r.name, r.duration, r.difficulty, r.reps);
+    }
+    act->setTimestamp(r.timestamp);
+    return act;
+}
+
+// same text as CommandProcessor::appendCommand, without building an
+// Activity; hours are whole quarters, so no general float formatting
+inline void appendRecordCommand(string& out, const ActivityRecord& r) {
+    if (r.kind == ActivityKind::CLIMB) {
+        out += "add-climb ";
+        out += r.name;
+        out += '|';
+        long long quarters = llround(r.hours * 4.0);
+        appendDecimal(out, quarters / 4);
+        static const char* const FRACTIONS[] = { "", ".25", ".5", ".75" };
+        out += FRACTIONS[quarters % 4];
+        out += '|';
+        out += static_cast<char>('0' + r.difficulty);
+        out += '|';
+        out += r.place;
+        out += r.indoor ? "|indoor|" : "|outdoor|";
+        if (r.grade.isValid()) out += gradeLabel(r.grade.ordinal(), r.grade.system());
+    }
+    else {
+        out += "add-training ";
+        out += r.name;
+        out += '|';
+        out += static_cast<char>('0' + r.difficulty);
+        out += '|';
+        appendDecimal(out, r.reps);
+    }
+    out += '|';
+    appendDecimal(out, r.timestamp);
+    out += '\n';
+}
+
+// one climber's activities, appended to mgr
+inline void generateActivities(const WorkloadProfile& profile, int climber, ActivityManager& mgr) {
+    WorkloadGenerator gen(profile, climber);
+    ActivityRecord record;
+    while (!gen.done()) {
+        gen.next(record);
+        mgr.add(activityFromRecord(record));
+    }
+}
+
+// one climber as an import script: a name line, then one line per activity
+inline void appendWorkloadCommands(string& out, const WorkloadProfile& profile, int climber) {
+    WorkloadGenerator gen(profile, climber);
+    ActivityRecord record;
+    out += "name ";
+    out += workloadClimberName(climber);
+    out += '\n';
+    while (!gen.done()) {
+        gen.next(record);
+        appendRecordCommand(out, record);
+    }
+}
+
+struct WorkloadResult {
+    long long records;
+    long long bytes;
+    int failures;       // files that could not be written
+    double seconds;
+};
+
+const size_t WORKLOAD_FLUSH_BYTES = 1 << 20;
+
+// <directory>/climber-<n>.txt for every climber in the profile
+inline WorkloadResult writeWorkloadFiles(const string& directory, const WorkloadProfile& profile) {
+    WorkloadResult result{ 0, 0, 0, 0.0 };
+    auto start = chrono::steady_clock::now();
+    string buffer;
+    buffer.reserve(WORKLOAD_FLUSH_BYTES + 512);
+    ActivityRecord record;
+
+    for (int c = 0; c < profile.climbers; c++) {
+        string path = directory + "/climber-";
+        appendDecimal(path, c + 1);
+        path += ".txt";
+        FILE* file = fopen(path.c_str(), "wb");
+        if (file == nullptr) {
+            result.failures++;
+            continue;
+        }
+
+        bool ok = true;
+        auto flush = [&]() {
+            if (ok && !buffer.empty()) ok = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+            result.bytes += static_cast<long long>(buffer.size());
+            buffer.clear();
+        };
+        buffer += "name ";
+        buffer += workloadClimberName(c);
+        buffer += '\n';
+        WorkloadGenerator gen(profile, c);
+        while (!gen.done()) {
+            gen.next(record);
+            appendRecordCommand(buffer, record);
+            if (buffer.size() >= WORKLOAD_FLUSH_BYTES) flush();
+        }
+        flush();
+        if (fclose(file) != 0) ok = false;
+        if (!ok) result.failures++;
+        result.records += gen.getProduced();
+    }
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+// ==========================
+// MICROBENCHMARKS
+// each result is one timed loop over a container of `size` elements;
+// operations that walk the list are sampled so every size finishes in
+// roughly the same time. countTypeRecursive recurses once per element,
+// so its sizes stop at BENCH_RECURSION_LIMIT. The concurrent scans run
+// the same per-thread work on 1, 2 and 4 threads; ns/op is wall time
+// over all scans, so it halves when doubling the threads scales.
+// ==========================
+struct BenchResult {
+    string name;
+    int size;
+    long long ops;
+    double nsPerOp;
+    double allocationsPerOp;
+    double bytesPerOp;
+};
+
+const long long BENCH_WALK_BUDGET = 1LL << 24;   // list nodes visited per sampled benchmark
+const int BENCH_RECURSION_LIMIT = 10000;
+
+// how many O(size) operations fit in the walk budget
+inline long long benchSamples(long long size) {
+    long long samples = BENCH_WALK_BUDGET / (size > 0 ? size : 1);
+    return max(8LL, min(size, samples));
+}
+
+// the k-th sampled position, spread over [0, size)
+inline int benchPosition(long long k, long long size) {
+    return static_cast<int>((static_cast<unsigned long long>(k) * 2654435761ULL) % static_cast<unsigned long long>(size));
+}
+
+class BenchTimer {
+private:
+    chrono::steady_clock::time_point start;
+    AllocationCount before;
+
+public:
+    BenchTimer() : start(chrono::steady_clock::now()), before(allocationsSoFar()) {}
+
+    // name is a C string so building it is not counted
+    BenchResult stop(const char* name, int size, long long ops) const {
+        double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        AllocationCount after = allocationsSoFar();
+        double n = ops > 0 ? static_cast<double>(ops) : 1.0;
+        return BenchResult{ name, size, ops, ns / n,
+            static_cast<double>(after.allocations - before.allocations) / n,
+            static_cast<double>(after.bytes - before.bytes) / n };
+    }
+};
+
+inline vector<Activity*> benchActivities(int size) {
+    vector<Activity*> acts(size);
+    for (int i = 0; i < size; i++) {
+        if (i % 2 == 0) acts[i] = new ClimbSession("b" + to_string(i), 0, HARD, 1.5, Location("Gym", true));
+        else acts[i] = new TrainingSession("b" + to_string(i), 0, MODERATE, 10);
+    }
+    return acts;
+}
+
+inline void benchLinkedList(int size, vector<BenchResult>& out) {
+    vector<Activity*> acts = benchActivities(size);
+    ActivityLinkedList list;
+    BenchTimer back;
+    for (Activity* act : acts) list.insertBack(act);
+    out.push_back(back.stop("ActivityLinkedList::insertBack", size, size));
+
+    long long samples = benchSamples(size);
+    volatile long long sink = 0;
+    BenchTimer get;
+    for (long long k = 0; k < samples; k++)
+        sink = sink + list.getAtPosition(benchPosition(k, size))->getDuration();
+    out.push_back(get.stop("ActivityLinkedList::getAtPosition", size, samples));
+
+    vector<string> targets(samples);
+    for (long long k = 0; k < samples; k++) targets[k] = "b" + to_string(benchPosition(k, size));
+    BenchTimer search;
+    for (const string& target : targets) sink = sink + list.searchByName(target);
+    out.push_back(search.stop("ActivityLinkedList::searchByName", size, samples));
+
+    long long deletes = min<long long>(samples, size);
+    BenchTimer erase;
+    for (long long k = 0; k < deletes; k++)
+        list.deleteAtPosition(benchPosition(k, size - k));
+    out.push_back(erase.stop("ActivityLinkedList::deleteAtPosition", size, deletes));
+    list.clear();
+
+    acts = benchActivities(size);
+    BenchTimer front;
+    for (Activity* act : acts) list.insertFront(act);
+    out.push_back(front.stop("ActivityLinkedList::insertFront", size, size));
+}
+
+inline void benchDynamicArray(int size, vector<BenchResult>& out) {
+    {
+        DynamicArray<int> arr;
+        BenchTimer add;
+        for (int i = 0; i < size; i++) arr.add(i);
+        out.push_back(add.stop("DynamicArray::add", size, size));
+
+        long long removes = min<long long>(benchSamples(size), size);
+        BenchTimer remove;
+        for (long long k = 0; k < removes; k++) arr.remove(benchPosition(k, size - k));
+        out.push_back(remove.stop("DynamicArray::remove", size, removes));
+    }
+
+    // only the adds that find the array full (capacity 5, doubling)
+    DynamicArray<int> arr;
+    double ns = 0.0;
+    AllocationCount allocated = { 0, 0, 0, 0 };
+    long long resizes = 0;
+    int capacity = 5;
+    for (int i = 0; i < size; i++) {
+        if (i < capacity) {
+            arr.add(i);
+            continue;
+        }
+        BenchTimer one;
+        arr.add(i);
+        BenchResult r = one.stop("", size, 1);
+        ns += r.nsPerOp;
+        allocated.allocations += static_cast<unsigned long long>(r.allocationsPerOp);
+        allocated.bytes += static_cast<unsigned long long>(r.bytesPerOp);
+        resizes++;
+        capacity *= 2;
+    }
+    double n = resizes > 0 ? static_cast<double>(resizes) : 1.0;
+    out.push_back(BenchResult{ "DynamicArray::resize", size, resizes, ns / n,
+        static_cast<double>(allocated.allocations) / n, static_cast<double>(allocated.bytes) / n });
+}
+
+inline void benchStackQueue(int size, vector<BenchResult>& out) {
+    volatile long long sink = 0;
+    arrayStack<int> stack(size);
+    BenchTimer push;
+    for (int i = 0; i < size; i++) stack.push(i);
+    out.push_back(push.stop("arrayStack::push", size, size));
+    BenchTimer pop;
+    for (int i = 0; i < size; i++) {
+        sink = sink + stack.top();
+        stack.pop();
+    }
+    out.push_back(pop.stop("arrayStack::top+pop", size, size));
+
+    arrayQueue<int> queue(size);
+    BenchTimer add;
+    for (int i = 0; i < size; i++) queue.addQueue(i);
+    out.push_back(add.stop("arrayQueue::addQueue", size, size));
+    BenchTimer remove;
+    for (int i = 0; i < size; i++) {
+        sink = sink + queue.front();
+        queue.deleteQueue();
+    }
+    out.push_back(remove.stop("arrayQueue::front+deleteQueue", size, size));
+}
+
+inline void benchCountType(int size, vector<BenchResult>& out) {
+    ActivityManager mgr;
+    for (Activity* act : benchActivities(size)) mgr.add(act);
+    // each call visits size*(size+1)/2 nodes
+    long long calls = max(1LL, BENCH_WALK_BUDGET / (static_cast<long long>(size) * size / 2 + 1));
+    volatile int sink = 0;
+    BenchTimer count;
+    for (long long k = 0; k < calls; k++) sink = sink + mgr.countTypeRecursive("Climb Session");
+    out.push_back(count.stop("ActivityManager::countTypeRecursive", size, calls));
+}
+
+inline void benchConcurrentScan(int size, vector<BenchResult>& out) {
+    static const char* const NAMES[] = { "ConcurrentActivityManager::summarize x1",
+        "ConcurrentActivityManager::summarize x2", "ConcurrentActivityManager::summarize x4" };
+    ConcurrentActivityManager mgr(size);
+    for (Activity* act : benchActivities(size)) mgr.add(act);
+    long long scans = max(8LL, BENCH_WALK_BUDGET / 4 / size);
+
+    for (int t = 0; t < 3; t++) {
+        int threads = 1 << t;
+        vector<thread> pool;
+        BenchTimer scan;
+        for (int i = 0; i < threads; i++) {
+            pool.emplace_back([&mgr, scans]() {
+                volatile double sink = 0.0;
+                for (long long k = 0; k < scans; k++) sink = sink + mgr.summarize().totalHours;
+            });
+        }
+        for (thread& th : pool) th.join();
+        out.push_back(scan.stop(NAMES[t], size, scans * threads));
+    }
+}
+
+// sizes 100, 1000, ... up to maxSize
+inline vector<BenchResult> runBenchmarks(int maxSize) {
+    vector<BenchResult> results;
+    for (long long size = 100; size <= maxSize; size *= 10) {
+        int n = static_cast<int>(size);
+        benchLinkedList(n, results);
+        benchDynamicArray(n, results);
+        benchStackQueue(n, results);
+        if (n <= BENCH_RECURSION_LIMIT) benchCountType(n, results);
+        benchConcurrentScan(n, results);
+    }
+    return results;
+}
+
+inline string benchResultsJson(const vector<BenchResult>& results) {
+    string json = "{\n  \"benchmarks\": [";
+    char line[256];
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        snprintf(line, sizeof(line),
+            "%s\n    {\"name\": \"%s\", \"size\": %d, \"ops\": %lld, \"ns_per_op\": %.2f, "
+            "\"allocations_per_op\": %.4f, \"bytes_per_op\": %.2f}",
+            i > 0 ? "," : "", r.name.c_str(), r.size, r.ops, r.nsPerOp, r.allocationsPerOp, r.bytesPerOp);
+        json += line;
+    }
+    json += "\n  ]\n}\n";
+    return json;
+}
+
+// ==========================
+// PERFORMANCE GATES
+// fixed-size scenarios on generated data, compared with a baseline file
+// of lines scenario|size|ns per op|allocations per op|time tolerance|
+// allocation tolerance. A scenario regresses when either measurement
+// exceeds its baseline by more than the tolerance (0.3 = 30%); one with
+// no baseline at its size fails too. Each runs PERF_REPEATS times and
+// keeps the fastest run. Timings only mean something in release builds.
+// The committed baseline is PERF_BASELINE_FILE next to this source; run
+// from this folder, "--perf-gate" checks against it and
+// "--perf-gate --update" records this machine's numbers into it.
+// ==========================
+const char* const PERF_BASELINE_FILE = "perf-baseline.txt";
+const int PERF_REPEATS = 3;
+const double PERF_TIME_TOLERANCE = 0.30;
+const double PERF_ALLOCATION_TOLERANCE = 0.02;
+const int PERF_REPORT_SESSIONS = 100000;
+const int PERF_BULK_ADD_SESSIONS = 1000000;
+const int PERF_SEARCH_SESSIONS = 100000;
+const int PERF_SEARCHES = 2000;
+
+// swallows output, so display code can be timed without a terminal
+class DiscardBuffer : public streambuf {
+private:
+    char scratch[4096];
+
+protected:
+    int_type overflow(int_type ch) override {
+        setp(scratch, scratch + sizeof(scratch));
+        return traits_type::not_eof(ch);
+    }
+    streamsize xsputn(const char*, streamsize n) override { return n; }
+
+public:
+    DiscardBuffer() { setp(scratch, scratch + sizeof(scratch)); }
+};
+
+inline vector<Activity*> perfActivities(int sessions) {
+    WorkloadProfile profile;
+    profile.seed = 2024;
+    profile.activitiesPerClimber = sessions;
+    WorkloadGenerator gen(profile, 0);
+    ActivityRecord record;
+    vector<Activity*> acts;
+    acts.reserve(sessions);
+    while (!gen.done()) {
+        gen.next(record);
+        acts.push_back(activityFromRecord(record));
+    }
+    return acts;
+}
+
+inline void perfFill(ClimbingTracker& tracker, int sessions) {
+    tracker.setClimberName("Perf");
+    tracker.setClimbingDays(200);
+    for (Activity* act : perfActivities(sessions)) tracker.addSession(act);
+}
+
+// the summary plus the full activity listing, as the menu prints them
+inline BenchResult perfReport(int sessions) {
+    ClimbingTracker tracker;
+    perfFill(tracker, sessions);
+    DiscardBuffer sink;
+    streambuf* original = cout.rdbuf(&sink);
+    bool hadColor = Terminal::instance().colorEnabled();
+    Terminal::instance().setColorEnabled(false);
+
+    BenchTimer timer;
+    tracker.generateReport();
+    tracker.displayActivities();
+    BenchResult result = timer.stop("report", sessions, sessions);
+
+    cout.rdbuf(original);
+    Terminal::instance().setColorEnabled(hadColor);
+    return result;
+}
+
+inline BenchResult perfBulkAdd(int sessions) {
+    vector<Activity*> acts = perfActivities(sessions);
+    ClimbingTracker tracker;
+    BenchTimer timer;
+    for (Activity* act : acts) tracker.addSession(act);
+    return timer.stop("bulk-add", sessions, sessions);
+}
+
+inline BenchResult perfNameSearch(int sessions) {
+    vector<Activity*> acts = perfActivities(sessions);
+    vector<string> targets;
+    for (int k = 0; k < PERF_SEARCHES - 1; k++)
+        targets.push_back(acts[benchPosition(k, sessions)]->getName());
+    targets.push_back("No Such Route");   // a full scan
+    ClimbingTracker tracker;
+    for (Activity* act : acts) tracker.addSession(act);
+
+    volatile long long sink = 0;
+    BenchTimer timer;
+    for (const string& target : targets) sink = sink + tracker.findActivity(target);
+    return timer.stop("name-search", sessions, PERF_SEARCHES);
+}
+
+// sizes are divided by divisor, for quick runs
+inline vector<BenchResult> runPerfScenarios(int divisor = 1) {
+    if (divisor < 1) divisor = 1;
+    BenchResult (*const scenarios[])(int) = { perfReport, perfBulkAdd, perfNameSearch };
+    const int sizes[] = { PERF_REPORT_SESSIONS, PERF_BULK_ADD_SESSIONS, PERF_SEARCH_SESSIONS };
+
+    vector<BenchResult> results;
+    for (int s = 0; s < 3; s++) {
+        int size = max(sizes[s] / divisor, 1);
+        BenchResult best = scenarios[s](size);
+        for (int r = 1; r < PERF_REPEATS; r++) {
+            BenchResult next = scenarios[s](size);
+            if (next.nsPerOp < best.nsPerOp) best = next;
+        }
+        results.push_back(best);
+    }
+    return results;
+}
+
+struct PerfBaseline {
+    string name;
+    int size;
+    double nsPerOp;
+    double allocationsPerOp;
+    double timeTolerance;
+    double allocationTolerance;
+};
+
+inline string perfBaselineText(const vector<BenchResult>& results) {
+    string text = "# scenario|size|ns per op|allocations per op|time tolerance|allocation tolerance\n";
+    char line[256];
+    for (const BenchResult& r : results) {
+        snprintf(line, sizeof(line), "%s|%d|%.2f|%.6f|%.2f|%.2f\n", r.name.c_str(), r.size, r.nsPerOp,
+            r.allocationsPerOp, PERF_TIME_TOLERANCE, PERF_ALLOCATION_TOLERANCE);
+        text += line;
+    }
+    return text;
+}
+
+// blank lines and '#' comments are skipped; returns false on the first bad line
+inline bool parsePerfBaseline(const string& text, vector<PerfBaseline>& out, string& error) {
+    istringstream in(text);
+    string line;
+    for (int number = 1; getline(in, line); number++) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+
+        char name[64];
+        PerfBaseline b;
+        if (sscanf(line.c_str(), "%63[^|]|%d|%lf|%lf|%lf|%lf", name, &b.size, &b.nsPerOp,
+            &b.allocationsPerOp, &b.timeTolerance, &b.allocationTolerance) != 6) {
+            error = "line " + to_string(number) + ": expected scenario|size|ns|allocations|tolerance|tolerance";
+            return false;
+        }
+        b.name = name;
+        out.push_back(b);
+    }
+    return true;
+}
+
+struct PerfCheck {
+    BenchResult measured;
+    const PerfBaseline* baseline;   // nullptr when none matches name and size
+    double nsLimit;
+    double allocationLimit;
+
+    bool timeOk() const { return baseline != nullptr && measured.nsPerOp <= nsLimit; }
+    bool allocationsOk() const { return baseline != nullptr && measured.allocationsPerOp <= allocationLimit + 1e-9; }
+    bool passed() const { return timeOk() && allocationsOk(); }
+};
+
+inline vector<PerfCheck> comparePerf(const vector<BenchResult>& results, const vector<PerfBaseline>& baselines) {
+    vector<PerfCheck> checks;
+    for (const BenchResult& r : results) {
+        PerfCheck check{ r, nullptr, 0.0, 0.0 };
+        for (const PerfBaseline& b : baselines) {
+            if (b.name != r.name || b.size != r.size) continue;
+            check.baseline = &b;
+            check.nsLimit = b.nsPerOp * (1.0 + b.timeTolerance);
+            check.allocationLimit = b.allocationsPerOp * (1.0 + b.allocationTolerance);
+        }
+        checks.push_back(check);
+    }
+    return checks;
+}
+
+#ifdef _DEBUG
+// =======================================================
+// DOCTEST UNIT TESTS 
+// =======================================================
+
+// per test case: allocations, bytes, peak and blocks still live at
+// the end, on stderr when TRACKER_ALLOC_REPORT is set; a test that
+// leaves blocks behind is always named
+struct AllocationListener : doctest::IReporter {
+    bool verbose;
+    const doctest::TestCaseData* current = nullptr;
+    AllocationTotals start{};
+
+    explicit AllocationListener(const doctest::ContextOptions&)
+        : verbose(getenv("TRACKER_ALLOC_REPORT") != nullptr) {
+    }
+
+    void test_case_start(const doctest::TestCaseData& data) override {
+        current = &data;
+        resetAllocationPeak();
+        start = allocationTotals();
+    }
+
+    void test_case_end(const doctest::CurrentTestCaseStats&) override {
+        EpochDomain::global().trim();   // deferred frees are not leaks
+        AllocationTotals end = allocationTotals();
+        long long left = end.liveBlocks - start.liveBlocks;
+        if (!verbose && left <= 0) return;
+        cerr << (left > 0 ? "[leak] " : "[alloc] ") << current->m_name << ": "
+            << end.allocations - start.allocations << " allocations, " << end.bytes - start.bytes
+            << " bytes, peak " << end.peakBytes - start.liveBytes << " bytes, "
+            << left << " block(s) still live\n";
+    }
+
+    // doctest keeps a per-thread stream for messages and stringified
+    // values; grow it now so its first use is not blamed on a test.
+    // tlssPush/tlssPop are internals of the bundled doctest.h, so this
+    // is pinned to that version: recheck it when upgrading doctest
+    static_assert(DOCTEST_VERSION == 20412, "AllocationListener warm-up relies on doctest 2.4.12 internals");
+    void test_run_start() override {
+        for (int depth = 0; depth < 4; depth++) *doctest::detail::tlssPush() << string(4096, ' ');
+        for (int depth = 0; depth < 4; depth++) doctest::detail::tlssPop();
+    }
+
+    void report_query(const doctest::QueryData&) override {}
+    void test_run_end(const doctest::TestRunStats&) override {}
+    void test_case_reenter(const doctest::TestCaseData&) override {}
+    void test_case_exception(const doctest::TestCaseException&) override {}
+    void subcase_start(const doctest::SubcaseSignature&) override {}
+    void subcase_end() override {}
+    void log_assert(const doctest::AssertData&) override {}
+    void log_message(const doctest::MessageData&) override {}
+    void test_case_skipped(const doctest::TestCaseData&) override {}
+};
+
+DOCTEST_REGISTER_LISTENER("allocations", 1, AllocationListener);
+
+TEST_CASE("Base class constructor initializes correctly") {
+    ClimbSession a("Warmup", 30, EASY, 1.0, Location("Gym", true));
+    CHECK(a.getName() == "Warmup");
+    CHECK(a.getDuration() == 30);
+    CHECK(a.getDifficulty() == EASY);
+}
+
+TEST_CASE("Composition class Location works correctly") {
+    Location loc("indoor", true);
+
+    CHECK(loc.getPlace() == "indoor");
+    CHECK(loc.isIndoor() == true);
+    CHECK(loc.formattedLocation() == "indoor (Indoor)");
+}
+
+TEST_CASE("Derived class ClimbSession initializes base and derived data correctly") {
+    Location loc("Outdoor", false);
+    ClimbSession cs("Lead Route", 0, HARD, 2.5, loc);
+
+    CHECK(cs.getName() == "Lead Route");
+    CHECK(cs.getDifficulty() == HARD);
+    CHECK(cs.getHours() == doctest::Approx(2.5));
+    CHECK(cs.getLocation().isIndoor() == false);
+}
+
+TEST_CASE("Derived class TrainingSession initializes correctly") {
+    TrainingSession ts("Hangboard", 0, MODERATE, 6);
+
+    CHECK(ts.getName() == "Hangboard");
+    CHECK(ts.getDifficulty() == MODERATE);
+    CHECK(ts.getReps() == 6);
+}
+
+TEST_CASE("Tracker adds sessions correctly") {
+    ClimbingTracker tracker;
+    tracker.setClimberName("Alex");
+    tracker.setClimbingDays(20);
+
+    Location loc("Indoor", true);
+
+    tracker.addSession(
+        new ClimbSession("Indoor", 0, MODERATE, 1.0, loc)
+    );
+
+    CHECK(tracker.getActivityCount() == 1);
+
+    
+    tracker.removeActivity(0);
+}
+
+TEST_CASE("Activity setters update fields correctly (via derived class)") {
+    Location loc("Gym", true);
+    ClimbSession cs("Temp", 10, EASY, 1.0, loc);
+
+    cs.setName("Cooldown");
+    cs.setDuration(15);
+    cs.setDifficulty(MODERATE);
+
+    CHECK(cs.getName() == "Cooldown");
+    CHECK(cs.getDuration() == 15);
+    CHECK(cs.getDifficulty() == MODERATE);
+}
+
+TEST_CASE("Derived class setters work correctly") {
+    Location loc("Indoor", true);
+    ClimbSession cs("Bouldering", 0, EASY, 1.0, loc);
+
+    cs.setHours(2.0);
+    Location newLoc("Outdoor", false);
+    cs.setLocation(newLoc);
+
+    CHECK(cs.getHours() == doctest::Approx(2.0));
+    CHECK(cs.getLocation().isIndoor() == false);
+}
+
+// ===== MANAGER TESTS 
+TEST_CASE("Manager adds and removes activities") {
+    ActivityManager mgr;
+
+    Location loc("Inside", true);
+
+    mgr.add(new ClimbSession("Route", 0, EASY, 1.0, loc));
+    mgr.add(new TrainingSession("Hangboard", 1, MODERATE, 5));
+
+    CHECK(mgr.getSize() == 2);
+
+    mgr.remove(0);
+    CHECK(mgr.getSize() == 1);
+
+   
+    mgr.clear();
+}
+
+TEST_CASE("Polymorphic getType works") {
+    Location loc("Inside", true);
+
+    Activity* a1 = new ClimbSession("Route", 0, EASY, 1.0, loc);
+    Activity* a2 = new TrainingSession("Hangboard", 1, HARD, 5);
+
+    CHECK(a1->getType() == "Climb Session");
+    CHECK(a2->getType() == "Training Session");
+
+    delete a1;
+    delete a2;
+}
+
+TEST_CASE("ClimbSession equality works") {
+    Location loc("Gym", true);
+
+    ClimbSession a("Route", 0, EASY, 1.0, loc);
+    ClimbSession b("Route", 0, EASY, 1.0, loc);
+    ClimbSession c("Different", 0, EASY, 1.0, loc);
+
+    CHECK(a == b);
+    CHECK_FALSE(a == c);
+}
+
+TEST_CASE("operator<< outputs correct string") {
+    Location loc("Gym", true);
+    ClimbSession cs("Route", 0, EASY, 1.5, loc);
+
+    std::ostringstream out;
+    out << cs;
+
+    CHECK(out.str().find("Route") != std::string::npos);
+}
+
+TEST_CASE("Manager operator[] valid index returns correct item") {
+    ActivityManager mgr;
+    Location loc("Gym", true);
+
+    mgr += new ClimbSession("A", 0, EASY, 1.0, loc);
+
+    CHECK(mgr[0] != nullptr);
+
+    mgr.clear();
+}
+
+TEST_CASE("Manager operator[] invalid index throws") {
+    ActivityManager mgr;
+    Location loc("Gym", true);
+
+    mgr += new ClimbSession("A", 0, EASY, 1.0, loc);
+
+    CHECK_THROWS_AS(mgr[5], IndexOutOfRange);
+    CHECK_THROWS_AS(mgr[-1], IndexOutOfRange);
+
+    mgr.clear();
+}
+TEST_CASE("Manager operator-= invalid removal throws") {
+    ActivityManager mgr;
+
+    CHECK_THROWS_AS(mgr -= 0, IndexOutOfRange);
+
+    Location loc("Gym", true);
+    mgr += new ClimbSession("A", 0, EASY, 1.0, loc);
+
+    CHECK_THROWS_AS(mgr -= 5, IndexOutOfRange);
+
+    mgr.clear();
+}
+TEST_CASE("Manager += and -= works") {
+    ActivityManager mgr;
+    Location loc("Gym", true);
+
+    mgr += new ClimbSession("A", 0, EASY, 1.0, loc);
+    mgr += new TrainingSession("B", 0, MODERATE, 5);
+
+    CHECK(mgr.getSize() == 2);
+
+    mgr -= 0;
+
+    CHECK(mgr.getSize() == 1);
+
+
+    mgr.clear();
+}
+
+TEST_CASE("Function template maxValue works") {
+    ClimbingTracker tracker;
+
+    CHECK(tracker.maxValue(5, 10) == 10);
+    CHECK(tracker.maxValue(2.5, 1.1) == doctest::Approx(2.5));
+}
+
+TEST_CASE("DynamicArray template works") {
+    DynamicArray<int> arr;
+
+    arr.add(1);
+    arr.add(2);
+
+    CHECK(arr.getSize() == 2);
+
+    arr.remove(0);
+    CHECK(arr.getSize() == 1);
+}
+TEST_CASE("DynamicArray resizes when capacity exceeded") {
+    DynamicArray<int> arr(2); // small capacity to force resize fast
+
+    arr.add(10);
+    arr.add(20);
+    arr.add(30); // should trigger resize
+
+    CHECK(arr.getSize() == 3);
+    CHECK(arr[0] == 10);
+    CHECK(arr[1] == 20);
+    CHECK(arr[2] == 30);
+
+    arr.remove(1); // remove middle, should shift
+    CHECK(arr.getSize() == 2);
+    CHECK(arr[0] == 10);
+    CHECK(arr[1] == 30);
+}
+TEST_CASE("DynamicArray throws on invalid index") {
+    DynamicArray<int> arr;
+    arr.add(1);
+
+    CHECK_THROWS_AS(arr[-1], IndexOutOfRange);
+    CHECK_THROWS_AS(arr[1], IndexOutOfRange);
+}
+
+TEST_CASE("DynamicArray throws on invalid remove") {
+    DynamicArray<int> arr;
+    arr.add(1);
+
+    CHECK_THROWS_AS(arr.remove(-1), IndexOutOfRange);
+    CHECK_THROWS_AS(arr.remove(5), IndexOutOfRange);
+}
+TEST_CASE("operator<< outputs correct string for TrainingSession") {
+    TrainingSession ts("Hangboard", 0, HARD, 12);
+
+    std::ostringstream out;
+    out << ts;
+
+    // should include key identity fields from TrainingSession::toStream
+    CHECK(out.str().find("Hangboard") != std::string::npos);
+    CHECK(out.str().find("12") != std::string::npos);
+}
+TEST_CASE("ActivityManager recursive count returns correct number of climb sessions") {
+    ActivityManager mgr;
+    Location loc("Gym", true);
+
+    mgr.add(new ClimbSession("Route 1", 0, EASY, 1.0, loc));
+    mgr.add(new TrainingSession("Hangboard", 0, MODERATE, 10));
+    mgr.add(new ClimbSession("Route 2", 0, HARD, 2.0, loc));
+
+    CHECK(mgr.countTypeRecursive("Climb Session") == 2);
+    CHECK(mgr.countTypeRecursive("Training Session") == 1);
+
+    mgr.clear();
+}
+
+TEST_CASE("ActivityManager recursive count returns 0 when empty") {
+    ActivityManager mgr;
+
+    CHECK(mgr.countTypeRecursive("Climb Session") == 0);
+}
+
+TEST_CASE("ActivityManager recursive count returns 0 for type not found") {
+    ActivityManager mgr;
+    Location loc("Gym", true);
+
+    mgr.add(new ClimbSession("Route 1", 0, EASY, 1.0, loc));
+
+    CHECK(mgr.countTypeRecursive("Training Session") == 0);
+
+    mgr.clear();
+}
+//New
+TEST_CASE("Linked list insert back into empty manager works") {
+    ActivityManager mgr;
+    Location loc("Gym", true);
+
+    mgr.add(new ClimbSession("A", 0, EASY, 1.0, loc));
+
+    CHECK(mgr.getSize() == 1);
+    CHECK(mgr[0]->getName() == "A");
+
+    mgr.clear();
+}
 
-    // ==========================
-    // NON-INTERACTIVE ADD (FOR TESTS)
-    // ==========================
-    void addSession(Activity* activity) {
-        manager.add(activity);  // manager takes ownership
-        if (ClimbSession* cs = dynamic_cast<ClimbSession*>(activity))
-            totalHours += static_cast<int>(cs->getHours());
-    }
+TEST_CASE("Linked list insert front works") {
+    ActivityManager mgr;
+    Location loc("Gym", true);
 
-    int getActivityCount() const { return manager.getSize(); }
+    mgr.add(new ClimbSession("B", 0, EASY, 1.0, loc));
+    mgr.addToFront(new ClimbSession("A", 0, EASY, 1.0, loc));
 
-    // ==========================
-    // INTERACTIVE ADD CLIMB SESSION
-    // ==========================
-    void addClimbSession() {
-        cin.ignore(1000, '\n');
-        string name;
-        cout << "Enter climbing style: ";
-        getline(cin, name);
+    CHECK(mgr.getSize() == 2);
+    CHECK(mgr[0]->getName() == "A");
+    CHECK(mgr[1]->getName() == "B");
 
-        bool indoor = getYesNo("Is this climb indoor or outdoor? (Y=Indoor, N=Outdoor)");
-        ClimbDifficulty diff = promptDifficulty();
-        double hours = getValidatedDouble("Hours climbed this session: ", 0.1, 24.0);
+    mgr.clear();
+}
 
-        // Allocate and immediately give to manager
-        manager.add(new ClimbSession(name, 0, diff, hours, Location(name, indoor)));
+TEST_CASE("Linked list delete removes existing node") {
+    ActivityManager mgr;
+    Location loc("Gym", true);
 
-        totalHours += static_cast<int>(hours);
-    }
+    mgr.add(new ClimbSession("A", 0, EASY, 1.0, loc));
+    mgr.add(new ClimbSession("B", 0, EASY, 1.0, loc));
 
-    // ==========================
-    // INTERACTIVE ADD TRAINING SESSION
-    // ==========================
-    void addTrainingSession() {
-        cin.ignore(1000, '\n');
-        string name;
-        cout << "Enter training name: ";
-        getline(cin, name);
+    mgr.remove(0);
 
-        ClimbDifficulty diff = promptDifficulty();
-        int reps = getValidatedInt("Enter reps: ", 1, 100);
+    CHECK(mgr.getSize() == 1);
+    CHECK(mgr[0]->getName() == "B");
 
-        manager.add(new TrainingSession(name, 0, diff, reps));
+    mgr.clear();
+}
 
-        setColor(10);
-        cout << "Training session added.\n";
-        setColor(7);
-    }
+TEST_CASE("Linked list delete node that does not exist throws") {
+    ActivityManager mgr;
 
-    // ==========================
-    // DISPLAY ACTIVITIES
-    // ==========================
-    void displayActivities() const {
-        if (manager.getSize() == 0) {
-            cout << "No activities recorded.\n";
-            return;
-        }
+    CHECK_THROWS_AS(mgr.remove(0), IndexOutOfRange);
+}
 
-        for (int i = 0; i < manager.getSize(); i++) {
-            cout << "-----------------------------\n";
-            manager.get(i)->print();
-        }
-    }
+TEST_CASE("Linked list search finds node") {
+    ActivityManager mgr;
+    Location loc("Gym", true);
 
-    // ==========================
-    // REMOVE ACTIVITY
-    // ==========================
-    void removeActivity(int index) { manager.remove(index); }
-    int getManagerSize() const { return manager.getSize(); }
+    mgr.add(new ClimbSession("Boulder", 0, EASY, 1.0, loc));
+    mgr.add(new TrainingSession("Hangboard", 0, MODERATE, 10));
 
-    // ==========================
-    // REPORT GENERATION
-    // ==========================
-    void generateReport() const {
-        double avgHours = (climbingDays > 0) ? static_cast<double>(totalHours) / climbingDays : 0.0;
+    CHECK(mgr.sequentialSearchByName("Hangboard") == 1);
 
-        string level = determineExperienceLevel(totalHours);
-        string frequency = determineClimberType(climbingDays);
-        string rating = performanceRating(avgHours);
-        // Generate a table
-        setColor(11);
-        cout << "\n=================================\n";
-        cout << "       CLIMBING SUMMARY\n";
-        cout << "=================================\n";
-        setColor(7);
+    mgr.clear();
+}
 
-        cout << left << setw(25) << "Name:" << climberName << endl;
-        cout << left << setw(25) << "Total Hours:" << totalHours << endl;
-        cout << left << setw(25) << "Climbing Days:" << climbingDays << endl;
-        cout << left << setw(25) << "Avg Hours / Session:" << fixed << setprecision(1) << avgHours << endl;
-        cout << left << setw(25) << "Experience Level:" << level << endl;
-        cout << left << setw(25) << "Climber Type:" << frequency << endl;
-        cout << left << setw(25) << "Performance Rating:" << rating << endl;
+TEST_CASE("Linked list search returns -1 when not found") {
+    ActivityManager mgr;
+    Location loc("Gym", true);
 
-        cout << left << setw(25) << "Climb Sessions:"
-            << manager.countTypeRecursive("Climb Session") << endl;
+    mgr.add(new ClimbSession("Boulder", 0, EASY, 1.0, loc));
 
-        cout << left << setw(25) << "Training Sessions:"
-            << manager.countTypeRecursive("Training Session") << endl;
+    CHECK(mgr.sequentialSearchByName("Campus") == -1);
 
-        cout << "=================================\n";
-    }
-    // ==========================
-    // SAVE / LOAD
-    // ==========================
-    void saveToFile() const {
-        string filename;
-        cout << "Enter filename to save report: ";
-        cin >> filename;
+    mgr.clear();
+}
 
-        ofstream outFile(filename);
-        if (!outFile) {
-            cout << "Error saving report.\n";
-            return;
-        }
+TEST_CASE("Traversing empty linked list is safe") {
+    ActivityManager mgr;
 
-        double avgHours = (climbingDays > 0) ? static_cast<double>(totalHours) / climbingDays : 0.0;
+    CHECK(mgr.getSize() == 0);
+    CHECK(mgr.sequentialSearchByName("Anything") == -1);
+}
 
-        outFile << "Name: " << climberName << "\n";
-        outFile << "Total Hours: " << totalHours << "\n";
-        outFile << "Climbing Days: " << climbingDays << "\n";
-        outFile << fixed << setprecision(1);
-        outFile << "Avg Hours / Session: " << avgHours << "\n";
-        outFile << "Experience Level: " << determineExperienceLevel(totalHours) << "\n";
-        outFile << "Climber Type: " << determineClimberType(climbingDays) << "\n";
-        outFile << "Performance Rating: " << performanceRating(avgHours) << "\n";
+TEST_CASE("Iterator starts at front and advances correctly") {
+    ActivityLinkedList list;
+    Location loc("Gym", true);
 
-        outFile.close();
-        cout << "Report saved to " << filename << endl;
-    }
+    list.insertBack(new ClimbSession("A", 0, EASY, 1.0, loc));
+    list.insertBack(new ClimbSession("B", 0, EASY, 1.0, loc));
 
-    void loadFromFile() const {
-        string filename;
-        cout << "Enter filename to load report: ";
-        cin >> filename;
+    ActivityLinkedList::Iterator it = list.begin();
 
-        string report = loadReport(filename);
-        cout << "\n----- LOADED REPORT -----\n";
-        cout << report << endl;
-    }
+    REQUIRE(it.hasCurrent());
+    CHECK(it.getData()->getName() == "A");
 
-    // ==========================
-    // UTILITY TEMPLATE
-    // ==========================
-    template <typename T>
-    T maxValue(T a, T b) {
-        return (a > b) ? a : b;
-    }
-};
-#ifdef _DEBUG
-// =======================================================
-// DOCTEST UNIT TESTS 
-// =======================================================
+    it.next();
+    REQUIRE(it.hasCurrent());
+    CHECK(it.getData()->getName() == "B");
 
-TEST_CASE("Base class constructor initializes correctly") {
-    ClimbSession a("Warmup", 30, EASY, 1.0, Location("Gym", true));
-    CHECK(a.getName() == "Warmup");
-    CHECK(a.getDuration() == 30);
-    CHECK(a.getDifficulty() == EASY);
+    it.next();
+    CHECK_FALSE(it.hasCurrent());
 }
+TEST_CASE("Recursive count still works with linked list storage") {
+    ActivityManager mgr;
+    Location loc("Gym", true);
 
-TEST_CASE("Composition class Location works correctly") {
-    Location loc("indoor", true);
+    mgr.add(new ClimbSession("Route 1", 0, EASY, 1.0, loc));
+    mgr.add(new TrainingSession("Hangboard", 0, MODERATE, 10));
+    mgr.add(new ClimbSession("Route 2", 0, HARD, 2.0, loc));
 
-    CHECK(loc.getPlace() == "indoor");
-    CHECK(loc.isIndoor() == true);
-    CHECK(loc.formattedLocation() == "indoor (Indoor)");
+    CHECK(mgr.countTypeRecursive("Climb Session") == 2);
+    CHECK(mgr.countTypeRecursive("Training Session") == 1);
+
+    mgr.clear();
+}
+TEST_CASE("Printing empty linked list is safe") {
+    ActivityManager mgr;
+    CHECK_NOTHROW(mgr.displayAll());
 }
 
-TEST_CASE("Derived class ClimbSession initializes base and derived data correctly") {
-    Location loc("Outdoor", false);
-    ClimbSession cs("Lead Route", 0, HARD, 2.5, loc);
+//Doctests added by Chris Noonan as part of the Week 11 assignment
+TEST_CASE("arrayStack basic operations")
+{
+    arrayStack<int> s(5);
 
-    CHECK(cs.getName() == "Lead Route");
-    CHECK(cs.getDifficulty() == HARD);
-    CHECK(cs.getHours() == doctest::Approx(2.5));
-    CHECK(cs.getLocation().isIndoor() == false);
-}
+    CHECK(s.isEmptyStack() == true);
 
-TEST_CASE("Derived class TrainingSession initializes correctly") {
-    TrainingSession ts("Hangboard", 0, MODERATE, 6);
+    s.push(10);
+    s.push(20);
+    s.push(30);
 
-    CHECK(ts.getName() == "Hangboard");
-    CHECK(ts.getDifficulty() == MODERATE);
-    CHECK(ts.getReps() == 6);
+    CHECK(s.isEmptyStack() == false);
+    CHECK(s.top() == 30);
+
+    s.pop();
+    CHECK(s.top() == 20);
+
+    s.pop();
+    s.pop();
+
+    CHECK(s.isEmptyStack() == true);
 }
 
-TEST_CASE("Tracker adds sessions correctly") {
-    ClimbingTracker tracker;
-    tracker.setClimberName("Alex");
-    tracker.setClimbingDays(20);
+TEST_CASE("arrayQueue basic operations")
+{
+    arrayQueue<int> q(5);
 
-    Location loc("Indoor", true);
+    CHECK(q.isEmptyQueue() == true);
 
-    tracker.addSession(
-        new ClimbSession("Indoor", 0, MODERATE, 1.0, loc)
-    );
+    q.addQueue(10);
+    q.addQueue(20);
+    q.addQueue(30);
 
-    CHECK(tracker.getActivityCount() == 1);
+    CHECK(q.front() == 10);
+    CHECK(q.back() == 30);
 
-    
-    tracker.removeActivity(0);
+    q.deleteQueue();
+
+    CHECK(q.front() == 20);
+
+    q.deleteQueue();
+    q.deleteQueue();
+
+    CHECK(q.isEmptyQueue() == true);
 }
 
-TEST_CASE("Activity setters update fields correctly (via derived class)") {
-    Location loc("Gym", true);
-    ClimbSession cs("Temp", 10, EASY, 1.0, loc);
+// ===== FILTER QUERY TESTS
+TEST_CASE("Bitmap insert and erase shift rows across word boundaries") {
+    ActivityBitmap bits;
 
-    cs.setName("Cooldown");
-    cs.setDuration(15);
-    cs.setDifficulty(MODERATE);
+    for (int i = 0; i < 130; i++)
+        bits.insert(i, i % 3 == 0);
 
-    CHECK(cs.getName() == "Cooldown");
-    CHECK(cs.getDuration() == 15);
-    CHECK(cs.getDifficulty() == MODERATE);
+    CHECK(bits.getSize() == 130);
+    CHECK(bits.count() == 44);
+
+    bits.insert(0, true);   // every row moves up by one
+    CHECK(bits.test(0));
+    CHECK(bits.test(64));   // old row 63
+    CHECK_FALSE(bits.test(65));
+
+    bits.erase(0);
+    bits.erase(63);         // old row 63 gone, 64 slides down
+    CHECK(bits.getSize() == 129);
+    CHECK_FALSE(bits.test(63));
+    CHECK(bits.test(65));   // old row 66
+    CHECK((~bits).count() == 129 - bits.count());
 }
 
-TEST_CASE("Derived class setters work correctly") {
-    Location loc("Indoor", true);
-    ClimbSession cs("Bouldering", 0, EASY, 1.0, loc);
+TEST_CASE("Manager filter combines difficulty, location, indoor and hours") {
+    ActivityManager mgr;
+
+    mgr.add(new ClimbSession("Arete", 0, HARD, 3.0, Location("Red Rocks", false)));
+    mgr.add(new ClimbSession("Slab", 0, EASY, 4.0, Location("Red Rocks", false)));
+    mgr.add(new ClimbSession("Roof", 0, EXTREME, 2.5, Location("Red Rocks", false)));
+    mgr.add(new ClimbSession("Gym Lead", 0, HARD, 3.0, Location("Red Rocks", true)));
+    mgr.add(new ClimbSession("Crack", 0, HARD, 1.5, Location("Red Rocks", false)));
+    mgr.add(new ClimbSession("Corner", 0, HARD, 5.0, Location("Yosemite", false)));
+    mgr.add(new TrainingSession("Hangboard", 0, HARD, 10));
+
+    ActivityBitmap rows = mgr.whereIndoor(false)
+        & (mgr.whereDifficulty(HARD) | mgr.whereDifficulty(EXTREME))
+        & mgr.whereHoursBetween(2.0, 24.0)
+        & mgr.whereLocation("Red Rocks");
 
-    cs.setHours(2.0);
-    Location newLoc("Outdoor", false);
-    cs.setLocation(newLoc);
+    vector<const Activity*> found = mgr.select(rows);
+    REQUIRE(found.size() == 2);
+    CHECK(found[0]->getName() == "Arete");
+    CHECK(found[1]->getName() == "Roof");
 
-    CHECK(cs.getHours() == doctest::Approx(2.0));
-    CHECK(cs.getLocation().isIndoor() == false);
+    CHECK(mgr.whereType("Training Session").count() == 1);
+    CHECK((mgr.allActivities().andNot(mgr.whereType("Climb Session"))).count() == 1);
+    CHECK(mgr.whereLocation("Nowhere").count() == 0);
+
+    mgr.clear();
 }
 
-// ===== MANAGER TESTS 
-TEST_CASE("Manager adds and removes activities") {
+TEST_CASE("Manager filter stays aligned after remove, front insert and reindex") {
     ActivityManager mgr;
+    Location crag("Crag", false);
 
-    Location loc("Inside", true);
+    mgr.add(new ClimbSession("A", 0, EASY, 1.0, crag));
+    mgr.add(new ClimbSession("B", 0, HARD, 2.0, crag));
+    mgr.addToFront(new ClimbSession("C", 0, HARD, 3.0, Location("Gym", true)));
+    mgr.remove(1);   // drops "A"
 
-    mgr.add(new ClimbSession("Route", 0, EASY, 1.0, loc));
-    mgr.add(new TrainingSession("Hangboard", 1, MODERATE, 5));
+    vector<const Activity*> hard = mgr.select(mgr.whereDifficulty(HARD));
+    REQUIRE(hard.size() == 2);
+    CHECK(hard[0]->getName() == "C");
+    CHECK(hard[1]->getName() == "B");
 
-    CHECK(mgr.getSize() == 2);
+    CHECK(mgr.sortedBy(SortKey::DIFFICULTY)[0]->getName() == "C");
+    mgr.update(1, [](Activity& act) { act.setDifficulty(EASY); });
+    CHECK(mgr.whereDifficulty(HARD).count() == 1);
+    CHECK(mgr.sortedBy(SortKey::DIFFICULTY)[0]->getName() == "B");
 
-    mgr.remove(0);
-    CHECK(mgr.getSize() == 1);
+    ActivityManager copy(mgr);
+    CHECK(copy.select(copy.whereLocation("Gym"))[0]->getName() == "C");
 
-   
     mgr.clear();
 }
 
-TEST_CASE("Polymorphic getType works") {
-    Location loc("Inside", true);
+TEST_CASE("Manager lookups by position read the index rows in list order") {
+    ActivityManager mgr;
+    for (int i = 0; i < 6; i++) mgr.add(new TrainingSession("T" + to_string(i), 0, EASY, i));
+    mgr.addToFront(new TrainingSession("Front", 0, EASY, 1));
+    mgr.remove(3);        // drops "T2"
+    mgr.remove(mgr.getSize() - 1);
+
+    const char* expected[] = { "Front", "T0", "T1", "T3", "T4" };
+    REQUIRE(mgr.getSize() == 5);
+    for (int i = 0; i < mgr.getSize(); i++) CHECK(mgr.get(i)->getName() == expected[i]);
+    CHECK(mgr.get(-1) == nullptr);
+    CHECK(mgr.get(5) == nullptr);
+    CHECK_THROWS_AS(mgr[5], IndexOutOfRange);
+}
 
-    Activity* a1 = new ClimbSession("Route", 0, EASY, 1.0, loc);
-    Activity* a2 = new TrainingSession("Hangboard", 1, HARD, 5);
+TEST_CASE("Batch classification matches the single-value functions") {
+    vector<int> hours, days;
+    vector<double> averages;
+    for (int v = -5; v < 200; v++) {      // 205 values: SIMD blocks plus a tail
+        hours.push_back(v);
+        days.push_back(v);
+        averages.push_back(v / 50.0);
+    }
 
-    CHECK(a1->getType() == "Climb Session");
-    CHECK(a2->getType() == "Training Session");
+    size_t n = hours.size();
+    vector<uint8_t> levels(n), types(n), ratings(n);
+    classifyExperienceLevels(hours.data(), levels.data(), n);
+    classifyClimberTypes(days.data(), types.data(), n);
+    classifyPerformanceRatings(averages.data(), ratings.data(), n);
 
-    delete a1;
-    delete a2;
+    for (size_t i = 0; i < n; i++) {
+        CHECK(EXPERIENCE_LABELS[levels[i]] == determineExperienceLevel(hours[i]));
+        CHECK(FREQUENCY_LABELS[types[i]] == determineClimberType(days[i]));
+        CHECK(DEDICATION_LABELS[ratings[i]] == performanceRating(averages[i]));
+    }
 }
 
-TEST_CASE("ClimbSession equality works") {
-    Location loc("Gym", true);
+TEST_CASE("Classification codes land on the threshold boundaries") {
+    CHECK(experienceCode(INTERMEDIATE_HOURS - 1) == BEGINNER);
+    CHECK(experienceCode(INTERMEDIATE_HOURS) == INTERMEDIATE);
+    CHECK(experienceCode(ADVANCED_HOURS) == ADVANCED);
+    CHECK(climberTypeCode(FREQUENT_CLIMBER_DAYS) == FREQUENT_CLIMBER);
+    CHECK(performanceCode(DEDICATED_SESSION_HOURS) == HIGHLY_DEDICATED);
+    CHECK(determineClimberType(NEW_CLIMBER_DAYS) == "Regular Climber");
+}
 
-    ClimbSession a("Route", 0, EASY, 1.0, loc);
-    ClimbSession b("Route", 0, EASY, 1.0, loc);
-    ClimbSession c("Different", 0, EASY, 1.0, loc);
+// ===== TRAINING LOAD TESTS
+TEST_CASE("Session load uses duration, difficulty and reps") {
+    ClimbSession timed("Lead", 90, HARD, 2.0, Location("Gym", true));
+    ClimbSession untimed("Lead", 0, HARD, 2.0, Location("Gym", true));
+    TrainingSession hang("Hangboard", 20, MODERATE, 10);
 
-    CHECK(a == b);
-    CHECK_FALSE(a == c);
+    CHECK(timed.trainingLoad() == doctest::Approx(270.0));
+    CHECK(untimed.trainingLoad() == doctest::Approx(360.0));
+    CHECK(hang.trainingLoad() == doctest::Approx(20 * 2 + 10 * LOAD_PER_REP * 2));
 }
 
-TEST_CASE("operator<< outputs correct string") {
-    Location loc("Gym", true);
-    ClimbSession cs("Route", 0, EASY, 1.5, loc);
+TEST_CASE("Incremental training load matches a day-by-day recomputation") {
+    TrainingLoadModel model;
+    double loads[40] = {};
+    loads[0] = 100; loads[3] = 250; loads[10] = 80; loads[24] = 400; loads[39] = 120;
 
-    std::ostringstream out;
-    out << cs;
+    for (int day = 0; day < 40; day++)
+        if (loads[day] > 0) model.addLoad(day, loads[day]);
 
-    CHECK(out.str().find("Route") != std::string::npos);
+    double acute = 0, chronic = 0;
+    for (int day = 0; day < 40; day++) {
+        acute = TrainingLoadModel::ACUTE_ALPHA * loads[day] + (1 - TrainingLoadModel::ACUTE_ALPHA) * acute;
+        chronic = TrainingLoadModel::CHRONIC_ALPHA * loads[day] + (1 - TrainingLoadModel::CHRONIC_ALPHA) * chronic;
+    }
+    CHECK(model.acuteLoad(39) == doctest::Approx(acute));
+    CHECK(model.chronicLoad(39) == doctest::Approx(chronic));
+    CHECK(model.ratio(39) == doctest::Approx(acute / chronic));
+
+    // a late entry and its removal leave the model where it was
+    model.addLoad(5, 300);
+    CHECK(model.acuteLoad(39) > acute);
+    model.removeLoad(5, 300);
+    CHECK(model.acuteLoad(39) == doctest::Approx(acute));
 }
 
-TEST_CASE("Manager operator[] valid index returns correct item") {
-    ActivityManager mgr;
-    Location loc("Gym", true);
+TEST_CASE("Removing every session leaves no training load") {
+    TrainingLoadModel model;
+    vector<pair<int, double>> sessions;
+    for (int i = 0; i < 60; i++) sessions.push_back({ (i * 7) % 45, 50.0 + (i * 37) % 400 });
+    for (const auto& s : sessions) model.addLoad(s.first, s.second);
+
+    // out of order, so every removal goes back through pow()
+    for (size_t i = 0; i < sessions.size(); i++) swap(sessions[i], sessions[(i * 13 + 5) % sessions.size()]);
+    for (size_t i = 0; i + 1 < sessions.size(); i++) model.removeLoad(sessions[i].first, sessions[i].second);
+    CHECK(model.getSessionCount() == 1);
+    CHECK(model.ratio(45) > 0.0);
+
+    model.removeLoad(sessions.back().first, sessions.back().second);
+    CHECK(model.getSessionCount() == 0);
+    CHECK(model.acuteLoad(45) == 0.0);
+    CHECK(model.chronicLoad(45) == 0.0);
+    CHECK(model.ratio(45) == 0.0);
+
+    GymTrainingLoad gym;
+    TrainingSession hard("Campus", 120, EXTREME, 50);
+    hard.setTimestamp(10 * SECONDS_PER_DAY);
+    gym.addSession("Gone", hard);
+    gym.removeSession("Gone", hard);
+    CHECK(gym.climbersAbove(1.5, 10).empty());
+}
 
-    mgr += new ClimbSession("A", 0, EASY, 1.0, loc);
+TEST_CASE("Gym training load flags climbers with a load spike") {
+    GymTrainingLoad gym;
+    for (int day = 0; day < 28; day++) {
+        ClimbSession steady("Routine", 60, MODERATE, 1.0, Location("Gym", true));
+        steady.setTimestamp(day * SECONDS_PER_DAY);
+        gym.addSession("Steady", steady);
+        gym.addSession("Spike", steady);
+    }
+    for (int day = 24; day < 28; day++) {
+        TrainingSession hard("Campus", 120, EXTREME, 50);
+        hard.setTimestamp(day * SECONDS_PER_DAY);
+        gym.addSession("Spike", hard);
+    }
 
-    CHECK(mgr[0] != nullptr);
+    CHECK(gym.getClimberCount() == 2);
+    CHECK(gym.ratio("Steady", 27) < 1.5);
+    vector<string> risky = gym.climbersAbove(1.5, 27);
+    REQUIRE(risky.size() == 1);
+    CHECK(risky[0] == "Spike");
+    CHECK(gym.ratio("Nobody", 27) == 0.0);
+}
 
-    mgr.clear();
+// ===== GRADE TESTS
+TEST_CASE("Grades parse in each system and share one ordinal scale") {
+    Grade v = Grade::parse("V4");
+    Grade yds = Grade::parse("5.12a");
+    Grade french = Grade::parse("7a+");
+
+    REQUIRE(v.isValid());
+    CHECK(v.system() == V_SCALE);
+    CHECK(yds.system() == YDS);
+    CHECK(french.system() == FRENCH);
+    CHECK(v.ordinal() == yds.ordinal());
+    CHECK(yds.ordinal() == french.ordinal());
+    CHECK(sizeof(Grade) == 1);
+
+    CHECK(Grade::parse("v10").toString() == "V10");
+    CHECK(Grade::parse("6a+").toString() == "6a+");
+    CHECK_FALSE(Grade::parse("V99").isValid());
+    CHECK_FALSE(Grade().isValid());
+
+    // out-of-range ordinals and systems do not alias onto real grades
+    CHECK_FALSE(Grade(40, V_SCALE).isValid());
+    CHECK_FALSE(Grade(-1, YDS).isValid());
+    CHECK_FALSE(Grade::fromEncoded(0xC5).isValid());
+    CHECK_FALSE(Grade::fromEncoded(0x3F).isValid());
+    CHECK(Grade::fromEncoded(v.encoded()).ordinal() == v.ordinal());
+
+    // 6a+ has no V equivalent of its own, so it renders as the grade below
+    CHECK(gradeLabel(Grade::parse("6a+").ordinal(), V_SCALE) == "V0");
 }
 
-TEST_CASE("Manager operator[] invalid index throws") {
-    ActivityManager mgr;
-    Location loc("Gym", true);
+TEST_CASE("Grade pyramid tracks sends, recent hardest and merges") {
+    GradePyramid alex, sam;
+    alex.addSend(Grade::parse("V3"), 10);
+    alex.addSend(Grade::parse("V3"), 12);
+    alex.addSend(Grade::parse("V6"), 20);
+    sam.addSend(Grade::parse("5.13b"), 200);
+
+    CHECK(alex.getTotal() == 3);
+    CHECK(alex.sendsAt(Grade::parse("V3").ordinal()) == 2);
+    CHECK(gradeLabel(alex.hardestSince(15), V_SCALE) == "V6");
+    CHECK(alex.hardestSince(21) == -1);
+
+    alex.merge(sam);
+    CHECK(alex.getTotal() == 4);
+    CHECK(gradeLabel(alex.hardestSince(110), YDS) == "5.13b");
+    CHECK(alex.preferredSystem() == V_SCALE);
+
+    alex.removeSend(Grade::parse("V6"), 20);
+    CHECK(gradeLabel(alex.hardestSince(15), V_SCALE) == "V9");
+
+    // dropping the recent V3 leaves only the older one
+    alex.removeSend(Grade::parse("V3"), 12);
+    alex.removeSend(Grade::parse("V3"), 99);     // never sent that day
+    CHECK(alex.sendsAt(Grade::parse("V3").ordinal()) == 1);
+    CHECK(alex.hardestSince(11) == Grade::parse("5.13b").ordinal());
+    alex.removeSend(Grade::parse("5.13b"), 200);
+    CHECK(alex.hardestSince(11) == -1);
+    CHECK(gradeLabel(alex.hardestSince(10), V_SCALE) == "V3");
 
-    mgr += new ClimbSession("A", 0, EASY, 1.0, loc);
+    std::ostringstream out;
+    alex.render(out, V_SCALE);
+    CHECK(out.str().find("V3") != std::string::npos);
+}
 
-    CHECK_THROWS_AS(mgr[5], IndexOutOfRange);
-    CHECK_THROWS_AS(mgr[-1], IndexOutOfRange);
+TEST_CASE("Tracker keeps its pyramid in step with graded climbs") {
+    ClimbingTracker tracker;
+    ClimbSession* climb = new ClimbSession("Project", 0, HARD, 2.0, Location("Crag", false));
+    climb->setGrade(Grade::parse("7b"));
+    tracker.addSession(climb);
+    tracker.addSession(new ClimbSession("Warmup", 0, EASY, 1.0, Location("Crag", false)));
 
-    mgr.clear();
-}
-TEST_CASE("Manager operator-= invalid removal throws") {
-    ActivityManager mgr;
+    CHECK(tracker.getPyramid().getTotal() == 1);
+    CHECK(gradeLabel(tracker.getPyramid().hardest(), FRENCH) == "7b");
 
-    CHECK_THROWS_AS(mgr -= 0, IndexOutOfRange);
+    tracker.removeActivity(0);
+    CHECK(tracker.getPyramid().getTotal() == 0);
+}
 
-    Location loc("Gym", true);
-    mgr += new ClimbSession("A", 0, EASY, 1.0, loc);
+// ===== LOCATION GROUP-BY TESTS
+TEST_CASE("Location group-by aggregates per place and indoor flag") {
+    LocationGroupBy groups(2);   // small table so it has to grow
+    Location crag("Crag", false), gym("Crag", true);
 
-    CHECK_THROWS_AS(mgr -= 5, IndexOutOfRange);
+    for (int i = 0; i < 50; i++) {
+        Location other("Spot " + to_string(i), i % 2 == 0);
+        groups.add(ClimbSession("Route", 0, EASY, 1.0, other));
+    }
+    groups.add(ClimbSession("A", 0, HARD, 2.0, crag));
+    groups.add(ClimbSession("B", 0, EXTREME, 3.5, crag));
+    groups.add(ClimbSession("C", 0, EASY, 1.0, gym));
+
+    const LocationStats* outdoor = groups.find("Crag", false);
+    REQUIRE(outdoor != nullptr);
+    CHECK(outdoor->sessions == 2);
+    CHECK(outdoor->totalHours == doctest::Approx(5.5));
+    CHECK(outdoor->difficultyCounts[HARD - 1] == 1);
+    CHECK(outdoor->difficultyCounts[EXTREME - 1] == 1);
+    CHECK(groups.find("Crag", true)->sessions == 1);
+    CHECK(groups.getGroupCount() == 52);
+
+    groups.remove(ClimbSession("C", 0, EASY, 1.0, gym));
+    CHECK(groups.find("Crag", true) == nullptr);
+    CHECK(groups.find("Unknown", true) == nullptr);
+
+    // removing what was never added leaves no negative groups behind
+    groups.remove(ClimbSession("C", 0, EASY, 1.0, gym));
+    groups.remove(ClimbSession("D", 0, EASY, 1.0, Location("Unknown", false)));
+    CHECK(groups.getGroupCount() == 51);
+    groups.add(ClimbSession("E", 0, EASY, 2.0, gym));
+    CHECK(groups.find("Crag", true)->sessions == 1);
+    CHECK(groups.find("Unknown", false) == nullptr);
 
-    mgr.clear();
+    std::ostringstream out;
+    out << 2.25;
+    groups.print(out);
+    out << ' ' << 2.25;
+    CHECK(out.str().compare(0, 4, "2.25") == 0);
+    CHECK(out.str().substr(out.str().size() - 5) == " 2.25");
 }
-TEST_CASE("Manager += and -= works") {
-    ActivityManager mgr;
-    Location loc("Gym", true);
-
-    mgr += new ClimbSession("A", 0, EASY, 1.0, loc);
-    mgr += new TrainingSession("B", 0, MODERATE, 5);
 
-    CHECK(mgr.getSize() == 2);
+TEST_CASE("Location group-by merges climbers and follows the tracker") {
+    ClimbingTracker alex;
+    alex.addSession(new ClimbSession("A", 0, HARD, 2.0, Location("Crag", false)));
+    alex.addSession(new TrainingSession("Hangboard", 0, HARD, 5));
 
-    mgr -= 0;
+    ActivityManager sam;
+    sam.add(new ClimbSession("B", 0, EASY, 1.5, Location("Crag", false)));
+    sam.add(new ClimbSession("C", 0, EASY, 1.0, Location("Boulders", false)));
 
-    CHECK(mgr.getSize() == 1);
+    LocationGroupBy gym;
+    gym.merge(alex.getLocationStats());
+    gym.addAll(sam);
 
+    CHECK(gym.getGroupCount() == 2);
+    CHECK(gym.find("Crag", false)->sessions == 2);
+    CHECK(gym.find("Crag", false)->totalHours == doctest::Approx(3.5));
 
-    mgr.clear();
+    alex.removeActivity(0);
+    CHECK(alex.getLocationStats().getGroupCount() == 0);
 }
 
-TEST_CASE("Function template maxValue works") {
-    ClimbingTracker tracker;
+// ===== CONCURRENT MANAGER TESTS
+TEST_CASE("Concurrent manager adds, removes and searches like the list manager") {
+    ConcurrentActivityManager mgr(2);
+    Location loc("Gym", true);
 
-    CHECK(tracker.maxValue(5, 10) == 10);
-    CHECK(tracker.maxValue(2.5, 1.1) == doctest::Approx(2.5));
-}
+    mgr.add(new ClimbSession("A", 0, EASY, 1.5, loc));
+    mgr.add(new TrainingSession("B", 0, HARD, 5));
+    mgr.add(new ClimbSession("C", 0, HARD, 2.0, loc));   // grows past capacity
 
-TEST_CASE("DynamicArray template works") {
-    DynamicArray<int> arr;
+    CHECK(mgr.getSize() == 3);
+    CHECK(mgr.sequentialSearchByName("C") == 2);
+    CHECK(mgr.countType("Climb Session") == 2);
 
-    arr.add(1);
-    arr.add(2);
+    mgr.remove(0);
+    CHECK(mgr.sequentialSearchByName("C") == 1);
+    CHECK_THROWS_AS(mgr.remove(7), IndexOutOfRange);
 
-    CHECK(arr.getSize() == 2);
+    ActivitySummary summary = mgr.summarize();
+    CHECK(summary.climbSessions == 1);
+    CHECK(summary.trainingSessions == 1);
+    CHECK(summary.totalHours == doctest::Approx(2.0));
 
-    arr.remove(0);
-    CHECK(arr.getSize() == 1);
+    mgr.clear();
+    CHECK(mgr.getSize() == 0);
 }
-TEST_CASE("DynamicArray resizes when capacity exceeded") {
-    DynamicArray<int> arr(2); // small capacity to force resize fast
 
-    arr.add(10);
-    arr.add(20);
-    arr.add(30); // should trigger resize
+TEST_CASE("Concurrent manager readers see consistent data while a writer runs") {
+    ConcurrentActivityManager mgr;
+    Location loc("Gym", true);
+    atomic<bool> done{ false };
+    atomic<int> badReads{ 0 };
+
+    // the writer only ever stores climbs, so any other type is a torn read
+    auto reader = [&](long long& reads) {
+        while (!done.load()) {
+            mgr.forEach([&](const Activity& act) {
+                if (act.getType() != "Climb Session") badReads++;
+            });
+            ActivitySummary s = mgr.summarize();
+            if (s.trainingSessions != 0) badReads++;
+            reads++;
+        }
+    };
 
-    CHECK(arr.getSize() == 3);
-    CHECK(arr[0] == 10);
-    CHECK(arr[1] == 20);
-    CHECK(arr[2] == 30);
+    unsigned hardware = thread::hardware_concurrency();
+    int maxReaders = static_cast<int>(hardware == 0 ? 2 : (hardware > 4 ? 4 : hardware));
+    double singleRate = 0.0;
+    for (int readers = 1; readers <= maxReaders; readers *= 2) {
+        done = false;
+        vector<long long> reads(readers, 0);
+        vector<thread> pool;
+        for (int r = 0; r < readers; r++)
+            pool.emplace_back(reader, std::ref(reads[r]));
+
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < 2000; i++) {
+            mgr.add(new ClimbSession("R" + to_string(i), 0, EASY, 1.0, loc));
+            if (i % 10 == 9) mgr.remove(0);
+        }
+        this_thread::sleep_for(chrono::milliseconds(20));
+        done = true;
+        for (thread& t : pool) t.join();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        long long total = 0;
+        for (long long r : reads) total += r;
+        double rate = total / seconds;
+        if (readers == 1) singleRate = rate;
+        char line[128];
+        snprintf(line, sizeof(line), "%d reader thread(s): %.0f scans/s, %.0f per reader, %.2fx one reader",
+            readers, rate, rate / readers, singleRate > 0.0 ? rate / singleRate : 0.0);
+        MESSAGE(line);
+        mgr.clear();
+    }
 
-    arr.remove(1); // remove middle, should shift
-    CHECK(arr.getSize() == 2);
-    CHECK(arr[0] == 10);
-    CHECK(arr[1] == 30);
+    CHECK(badReads.load() == 0);
+    CHECK(mgr.getSize() == 0);
 }
-TEST_CASE("DynamicArray throws on invalid index") {
-    DynamicArray<int> arr;
-    arr.add(1);
 
-    CHECK_THROWS_AS(arr[-1], IndexOutOfRange);
-    CHECK_THROWS_AS(arr[1], IndexOutOfRange);
+// ===== COMMAND AND SERVICE TESTS
+TEST_CASE("Command processor applies commands and reports errors") {
+    ClimbingTracker tracker;
+    tracker.setClimberName("Alex");
+    tracker.setClimbingDays(10);
+    CommandProcessor commands(tracker);
+    string out;
+
+    CHECK(commands.execute("add-climb Arete|2.5|hard|Red Rocks|outdoor|5.11a", out));
+    CHECK(commands.execute("add-training Hangboard|2|12", out));
+    CHECK(commands.execute("# comment lines are skipped", out));
+    CHECK(commands.execute("query Hangboard", out));
+    CHECK_FALSE(commands.execute("add-climb Bad|lots|hard|Gym|indoor", out));
+    CHECK_FALSE(commands.execute("delete 9", out));
+    CHECK_FALSE(commands.execute("fly away", out));
+    CHECK(out == "OK 0\nOK 1\nOK 1\nERR bad hours\nERR invalid index\nERR unknown command\n");
+
+    // out-of-range numbers are refused instead of overflowing the aggregates
+    out.clear();
+    const char* refused[] = {
+        "add-climb Nan|nan|hard|Gym|indoor", "add-climb Inf|inf|hard|Gym|indoor",
+        "add-climb Huge|1e300|hard|Gym|indoor", "add-climb Zero|0|hard|Gym|indoor",
+        "add-climb Day|25|hard|Gym|indoor", "add-climb Old|2|hard|Gym|indoor||-5",
+        "add-training Many|2|101", "add-training None|2|0",
+        "add-training Wide|2|99999999999", "delete 999999999999999999999",
+        "days 999999999999999999"
+    };
+    int failures = 0;
+    for (const char* line : refused) failures += commands.execute(line, out) ? 0 : 1;
+    CHECK(failures == 11);
+    CHECK(tracker.getActivityCount() == 2);
+    CHECK(tracker.getTotalHours() == 2);
+
+    out.clear();
+    CHECK(commands.execute("report", out));
+    CHECK(out.find("name=Alex|total_hours=2|days=10") == 3);
+    CHECK(out.find("climbs=1|training=1") != string::npos);
+
+    out.clear();
+    CHECK(commands.executeAll("delete 0\nquery Arete\n", out) == 0);
+    CHECK(out == "OK\nOK -1\n");
+    CHECK(tracker.getPyramid().getTotal() == 0);
 }
 
-TEST_CASE("DynamicArray throws on invalid remove") {
-    DynamicArray<int> arr;
-    arr.add(1);
+TEST_CASE("Batch script replays commands quietly and numbers failures") {
+    ClimbingTracker tracker;
+    string script =
+        "# replay\n"
+        "name Sam\n"
+        "days 12\n"
+        "add-climb Slab|1.0|easy|Gym|indoor\n"
+        "add-climb Roof|2.0|4|Crag|outdoor|V5|86400\n"
+        "add-training Campus|hard|8\n"
+        "  \t\r\n"
+        "  # indented comment\r\n"
+        "delete 0\n"
+        "delete 5\n"
+        "query Roof\n"
+        "report";
+    string out;
+    BatchResult result = runBatchScript(script, tracker, out);
+
+    CHECK(result.commands == 9);
+    CHECK(result.failures == 1);
+    CHECK(tracker.getActivityCount() == 2);
+    CHECK(out.find("line 10: ERR invalid index\n") == 0);
+    CHECK(out.find("OK 0\nOK name=Sam|") != string::npos);
+    CHECK(out.find("|days=12|") != string::npos);
+    CHECK(out.find("\x1b") == string::npos);
+}
 
-    CHECK_THROWS_AS(arr.remove(-1), IndexOutOfRange);
-    CHECK_THROWS_AS(arr.remove(5), IndexOutOfRange);
+#ifdef __linux__
+TEST_CASE("Service mode serves concurrent clients over a unix socket") {
+    ClimbingTracker tracker;
+    string endpoint = "unix:/tmp/tracker-test-" + to_string(getpid()) + ".sock";
+    TrackerServer server(tracker, endpoint, 2);
+    thread loop([&server] { server.run(); });
+
+    LoadResult result = runLoadGenerator(endpoint, 4, 250, 16);
+    CHECK(result.requests == 1000);
+    CHECK(result.errors == 0);
+    CHECK(tracker.getActivityCount() == 1000);
+
+    int fd = connectEndpoint(endpoint);
+    string request = "query Load-2-7\nreport\n";
+    CHECK(send(fd, request.data(), request.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(request.size()));
+    string reply;
+    char buffer[512];
+    while (count(reply.begin(), reply.end(), '\n') < 2) {
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n <= 0) break;
+        reply.append(buffer, static_cast<size_t>(n));
+    }
+    close(fd);
+    CHECK(reply.compare(0, 3, "OK ") == 0);
+    CHECK(reply.find("climbs=1000") != string::npos);
+
+    // the last command needs no newline, and clients cannot write files
+    string saved = "/tmp/tracker-service-save-" + to_string(getpid()) + ".txt";
+    fd = connectEndpoint(endpoint);
+    request = "save " + saved + "\ntrace on\ntrace " + saved + "\nquery Load-2-7";
+    CHECK(send(fd, request.data(), request.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(request.size()));
+    shutdown(fd, SHUT_WR);
+    reply.clear();
+    for (ssize_t n; (n = read(fd, buffer, sizeof(buffer))) > 0;) reply.append(buffer, static_cast<size_t>(n));
+    close(fd);
+    CHECK(reply.rfind("ERR save is not available to service clients\n"
+        "ERR trace is not available to service clients\n"
+        "ERR trace is not available to service clients\nOK ", 0) == 0);
+    CHECK(count(reply.begin(), reply.end(), '\n') == 4);
+    CHECK(access(saved.c_str(), F_OK) != 0);
+    CHECK_FALSE(tracingEnabled());
+
+    // a client that never reads stalls once the server's buffers are full
+    fd = connectEndpoint(endpoint);
+    string flood;
+    while (flood.size() < 65536) flood += "days 5\n";
+    size_t accepted = 0;
+    for (int idle = 0; idle < 5 && accepted < (size_t(16) << 20);) {
+        ssize_t n = send(fd, flood.data(), flood.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n > 0) {
+            accepted += static_cast<size_t>(n);
+            idle = 0;
+        }
+        else {
+            idle++;
+            this_thread::sleep_for(chrono::milliseconds(50));
+        }
+    }
+    close(fd);
+    CHECK(accepted < (size_t(8) << 20));
+
+    server.stop();
+    loop.join();
 }
-TEST_CASE("operator<< outputs correct string for TrainingSession") {
-    TrainingSession ts("Hangboard", 0, HARD, 12);
+#endif
 
-    std::ostringstream out;
-    out << ts;
+// ===== VERSIONED STATE TESTS
+TEST_CASE("Summary snapshots stay fixed while the tracker changes") {
+    ClimbingTracker tracker;
+    tracker.setClimberName("Alex");
+    tracker.setClimbingDays(20);
+    tracker.addSession(new ClimbSession("Slab", 0, EASY, 2.0, Location("Gym", true)));
 
-    // should include key identity fields from TrainingSession::toStream
-    CHECK(out.str().find("Hangboard") != std::string::npos);
-    CHECK(out.str().find("12") != std::string::npos);
+    auto before = tracker.readSummary();
+    tracker.addSession(new ClimbSession("Roof", 0, HARD, 3.0, Location("Crag", false)));
+    tracker.addSession(new TrainingSession("Hangboard", 0, MODERATE, 10));
+    tracker.setClimberName("Sam");
+
+    CHECK(before->climberName == "Alex");
+    CHECK(before->totalHours == 2);
+    CHECK(before->climbSessions == 1);
+    CHECK(before->trainingSessions == 0);
+
+    auto after = tracker.readSummary();
+    CHECK(after.version() == before.version() + 3);
+    tracker.setClimberName("Sam");          // no change, no new version
+    tracker.setClimbingDays(20);
+    CHECK(tracker.getVersion() == after.version());
+
+    // load and grade figures travel with the version they belong to
+    ClimbSession* project = new ClimbSession("Project", 0, EXTREME, 3.0, Location("Crag", false));
+    project->setGrade(Grade::parse("V8"));
+    project->setTimestamp(400 * SECONDS_PER_DAY);
+    tracker.addSession(project);
+    auto graded = tracker.readSummary();
+    CHECK(after->grades.hardestSince(0) == -1);
+    CHECK(graded->grades.hardestSince(310) == Grade::parse("V8").ordinal());
+    CHECK(graded->trainingLoad.ratio(400) > after->trainingLoad.ratio(400));
+    CHECK(after->climberName == "Sam");
+    CHECK(after->totalHours == 5);
+    CHECK(after->climbSessions == 2);
+    CHECK(after->trainingSessions == 1);
+
+    VersionedState<int> state(0);
+    {
+        auto pinned = state.read();
+        state.publish(1);
+        state.publish(2);
+        CHECK(*pinned == 0);
+        CHECK(state.retainedVersions() == 1);
+    }
+    state.collect();
+    CHECK(state.retainedVersions() == 0);
+    CHECK(*state.read() == 2);
 }
-TEST_CASE("ActivityManager recursive count returns correct number of climb sessions") {
-    ActivityManager mgr;
-    Location loc("Gym", true);
 
-    mgr.add(new ClimbSession("Route 1", 0, EASY, 1.0, loc));
-    mgr.add(new TrainingSession("Hangboard", 0, MODERATE, 10));
-    mgr.add(new ClimbSession("Route 2", 0, HARD, 2.0, loc));
+TEST_CASE("Readers never see a half-applied update") {
+    ClimbingTracker tracker;
+    atomic<bool> done{ false };
+    atomic<int> torn{ 0 };
+    atomic<int> reads{ 0 };
+
+    // each step adds a one-hour climb, then bumps the climbing days
+    vector<thread> readers;
+    for (int r = 0; r < 3; r++) {
+        readers.emplace_back([&] {
+            uint64_t lastVersion = 0;
+            while (!done.load()) {
+                auto snap = tracker.readSummary();
+                int lag = snap->climbSessions - snap->climbingDays;
+                if (snap->totalHours != snap->climbSessions || lag < 0 || lag > 1)
+                    torn++;
+                if (snap.version() < lastVersion) torn++;
+                lastVersion = snap.version();
+                reads++;
+            }
+        });
+    }
 
-    CHECK(mgr.countTypeRecursive("Climb Session") == 2);
-    CHECK(mgr.countTypeRecursive("Training Session") == 1);
+    while (reads.load() == 0) this_thread::yield();
+    for (int i = 1; i <= 2000; i++) {
+        tracker.addSession(new ClimbSession("Lap", 0, EASY, 1.0, Location("Gym", true)));
+        tracker.setClimbingDays(i);
+    }
+    done = true;
+    for (thread& t : readers) t.join();
 
-    mgr.clear();
+    CHECK(torn.load() == 0);
+    CHECK(reads.load() > 0);
 }
 
-TEST_CASE("ActivityManager recursive count returns 0 when empty") {
+// ===== EVENT BUS TESTS
+struct EventTally : EventSubscriber {
+    int added = 0, removed = 0, updated = 0, cleared = 0, batches = 0;
+    uint64_t nextSequence = 0;
+    bool ordered = true;
+
+    void onEvents(const ActivityEvent* events, size_t count) override {
+        batches++;
+        for (size_t i = 0; i < count; i++) {
+            if (events[i].sequence != nextSequence++) ordered = false;
+            switch (events[i].type) {
+            case ActivityEventType::ADDED: added++; break;
+            case ActivityEventType::REMOVED: removed++; break;
+            case ActivityEventType::UPDATED: updated++; break;
+            case ActivityEventType::CLEARED: cleared++; break;
+            }
+        }
+    }
+};
+
+TEST_CASE("Event bus keeps subscribers in step with the manager") {
+    ActivityEventBus bus(16);
     ActivityManager mgr;
+    mgr.attachEventBus(&bus);
+    LocationGroupBy byPlace;
+    EventTally tally;
+    bus.subscribe(&byPlace);
+    bus.subscribe(&tally);
+
+    for (int i = 0; i < 40; i++)   // wraps the ring twice
+        mgr.add(new ClimbSession("R" + to_string(i), 0, EASY, 1.0, Location(i % 2 ? "Gym" : "Crag", i % 2 == 1)));
+    mgr.add(new TrainingSession("Hangboard", 0, HARD, 6));
+    mgr.update(0, [](Activity& act) { act.setDifficulty(HARD); });
+    mgr.remove(1);
+    bus.flush();
+
+    CHECK(tally.added == 41);
+    CHECK(tally.updated == 1);
+    CHECK(tally.removed == 1);
+    CHECK(tally.ordered);
+    CHECK(tally.batches < 41);
+    CHECK(byPlace.find("Gym", true)->sessions == 19);
+    CHECK(byPlace.find("Crag", false)->sessions == 20);
+    CHECK(byPlace.find("Crag", false)->difficultyCounts[HARD - 1] == 1);
+    CHECK(mgr.whereDifficulty(HARD).count() == 2);
 
-    CHECK(mgr.countTypeRecursive("Climb Session") == 0);
+    mgr.clear();
+    bus.flush();
+    CHECK(tally.cleared == 1);
+    CHECK(byPlace.getGroupCount() == 0);
+
+    ClimbingTracker tracker;
+    tracker.addSession(new ClimbSession("Arete", 0, MODERATE, 2.0, Location("Crag", false)));
+    CHECK(tracker.getLocationStats().find("Crag", false)->totalHours == doctest::Approx(2.0));
 }
 
-TEST_CASE("ActivityManager recursive count returns 0 for type not found") {
+TEST_CASE("Polled subscriber consumes on its own thread") {
+    ActivityEventBus bus(64);
     ActivityManager mgr;
-    Location loc("Gym", true);
+    mgr.attachEventBus(&bus);
+    EventTally tally;
+    int id = bus.subscribe(&tally, false);
+    atomic<bool> done{ false };
+
+    thread consumer([&] {
+        while (!done.load() || bus.pending(id) > 0) {
+            if (bus.poll(id, 32) == 0) this_thread::yield();
+        }
+    });
+
+    Location gym("Gym", true);
+    for (int i = 0; i < 5000; i++)
+        mgr.add(new ClimbSession("Lap", 0, EASY, 1.0, gym));
+    for (int i = 0; i < 1000; i++)
+        mgr.remove(0);
+    done = true;
+    consumer.join();
+
+    CHECK(tally.added == 5000);
+    CHECK(tally.removed == 1000);
+    CHECK(tally.ordered);
+    CHECK(bus.published() == 6000);
+}
 
-    mgr.add(new ClimbSession("Route 1", 0, EASY, 1.0, loc));
+TEST_CASE("Event bus grows for pollers and detaches stalled ones") {
+    ActivityEventBus bus(256);
+    ActivityManager mgr;
+    mgr.attachEventBus(&bus);
+    EventTally tally;
+    bus.subscribe(&tally);
+    CHECK(bus.ringSize() == ActivityEventBus::BATCH);
+
+    Location gym("Gym", true);
+    for (int i = 0; i < 100; i++)   // leaves events pending across the wrap
+        mgr.add(new ClimbSession("Lap", 0, EASY, 1.0, gym));
+    REQUIRE(bus.pending(0) > 0);
+
+    EventTally polled;
+    int id = bus.subscribe(&polled, false);
+    CHECK(bus.ringSize() == 256);
+    bus.flush();
+    CHECK(tally.added == 100);
+    CHECK(tally.ordered);
+
+    // the poller never polls: the producer detaches it instead of waiting forever
+    bus.setStallTimeout(chrono::milliseconds(10));
+    for (int i = 0; i < 400; i++)
+        mgr.add(new ClimbSession("Lap", 0, EASY, 1.0, gym));
+    bus.flush();
+    CHECK(tally.added == 500);
+    CHECK(tally.ordered);
+    CHECK_FALSE(bus.attached(id));
+    CHECK(bus.poll(id) == 0);
+    CHECK(polled.added == 0);
+}
 
-    CHECK(mgr.countTypeRecursive("Training Session") == 0);
+TEST_CASE("Training load and grade pyramid follow manager events") {
+    ActivityEventBus bus;
+    ActivityManager mgr;
+    mgr.attachEventBus(&bus);
+    TrainingLoadModel load;
+    GradePyramid pyramid;
+    SessionAggregates aggregates(load, pyramid);
+    bus.subscribe(&aggregates);
+
+    Grade v4 = Grade::parse("V4"), v6 = Grade::parse("V6");
+    ClimbSession* cs = new ClimbSession("Roof", 0, MODERATE, 2.0, Location("Crag", false));
+    cs->setTimestamp(100 * SECONDS_PER_DAY);
+    cs->setGrade(v4);
+    mgr.add(cs);
+    mgr.update(0, [&](Activity& act) {
+        static_cast<ClimbSession&>(act).setGrade(v6);
+        act.setDifficulty(HARD);
+    });
+    bus.flush();
+
+    TrainingLoadModel expected;
+    expected.addSession(*mgr.get(0));
+    CHECK(pyramid.sendsAt(v4.ordinal()) == 0);
+    CHECK(pyramid.sendsAt(v6.ordinal()) == 1);
+    CHECK(load.acuteLoad(100) == doctest::Approx(expected.acuteLoad(100)));
 
     mgr.clear();
+    bus.flush();
+    CHECK(pyramid.getTotal() == 0);
+    CHECK(load.acuteLoad(100) == doctest::Approx(0.0));
+
+    ClimbingTracker tracker;
+    tracker.addSession(new TrainingSession("Hangboard", 30, HARD, 6));
+    CHECK(tracker.readSummary()->trainingLoad.getLastDay() == tracker.getTrainingLoad().getLastDay());
+    CHECK(tracker.getTrainingLoad().acuteLoad(0) > 0.0);
+    tracker.removeActivity(0);
+    CHECK(tracker.getTrainingLoad().acuteLoad(0) == doctest::Approx(0.0));
 }
-//New
-TEST_CASE("Linked list insert back into empty manager works") {
-    ActivityManager mgr;
-    Location loc("Gym", true);
 
-    mgr.add(new ClimbSession("A", 0, EASY, 1.0, loc));
+// ===== MPMC QUEUE TESTS
+TEST_CASE("mpmcQueue reports backpressure instead of dropping") {
+    mpmcQueue<int> q(3);
+    CHECK(q.capacity() == 4);
+
+    for (int i = 0; i < 4; i++)
+        CHECK(q.tryEnqueue(i) == QueueStatus::OK);
+    CHECK(q.tryEnqueue(99) == QueueStatus::FULL);
+
+    int item = -1;
+    CHECK(q.tryDequeue(item) == QueueStatus::OK);
+    CHECK(item == 0);
+    CHECK(q.tryEnqueue(4) == QueueStatus::OK);
+
+    int batch[8];
+    CHECK(q.tryDequeueBatch(batch, 8) == 4);
+    CHECK(batch[0] == 1);
+    CHECK(batch[3] == 4);
+    CHECK(q.tryDequeue(item) == QueueStatus::EMPTY);
+
+    q.tryEnqueue(5);
+    q.close();
+    CHECK(q.tryEnqueue(6) == QueueStatus::CLOSED);
+    CHECK(q.dequeue(item) == QueueStatus::OK);
+    CHECK(item == 5);
+    CHECK(q.dequeue(item) == QueueStatus::CLOSED);
+}
 
-    CHECK(mgr.getSize() == 1);
-    CHECK(mgr[0]->getName() == "A");
+TEST_CASE("mpmcQueue fans many ingest threads into one store") {
+    mpmcQueue<Activity*> q(64);
+    const int PRODUCERS = 4;
+    const int PER_PRODUCER = 2000;
+
+    vector<thread> producers;
+    for (int p = 0; p < PRODUCERS; p++) {
+        producers.emplace_back([&q, p] {
+            Location gym("Gym", true);
+            for (int i = 0; i < PER_PRODUCER; i++)
+                q.enqueue(new ClimbSession("P" + to_string(p), 0, EASY, 1.0, gym));
+        });
+    }
 
-    mgr.clear();
+    ActivityManager store;
+    thread consumer([&] {
+        Activity* batch[32];
+        size_t n;
+        while ((n = q.dequeueBatch(batch, 32)) > 0)
+            for (size_t i = 0; i < n; i++) store.add(batch[i]);
+    });
+
+    for (thread& t : producers) t.join();
+    q.close();
+    consumer.join();
+
+    CHECK(store.getSize() == PRODUCERS * PER_PRODUCER);
+    CHECK(store.whereLocation("Gym").count() == PRODUCERS * PER_PRODUCER);
+    CHECK(q.size() == 0);
 }
 
-TEST_CASE("Linked list insert front works") {
-    ActivityManager mgr;
-    Location loc("Gym", true);
+// ===== ORDERED VIEW TESTS
+TEST_CASE("Parallel merge sort is stable across chunk boundaries") {
+    const int N = 100000;
+    vector<int> keys(N);
+    uint32_t x = 12345;
+    for (int i = 0; i < N; i++) {
+        x = x * 1664525u + 1013904223u;
+        keys[i] = static_cast<int>(x >> 24);   // many ties
+    }
 
-    mgr.add(new ClimbSession("B", 0, EASY, 1.0, loc));
-    mgr.addToFront(new ClimbSession("A", 0, EASY, 1.0, loc));
+    vector<int> order(N);
+    for (int i = 0; i < N; i++) order[i] = i;
+    parallelMergeSort(order, [&keys](int a, int b) { return keys[a] < keys[b]; }, 4);
 
-    CHECK(mgr.getSize() == 2);
-    CHECK(mgr[0]->getName() == "A");
-    CHECK(mgr[1]->getName() == "B");
+    bool sorted = true;
+    for (int i = 1; i < N; i++) {
+        int a = order[i - 1], b = order[i];
+        if (keys[a] > keys[b] || (keys[a] == keys[b] && a > b)) sorted = false;
+    }
+    CHECK(sorted);
+}
 
+TEST_CASE("Ordered views follow mutations and back binary search") {
+    ActivityManager mgr;
+    Location gym("Gym", true);
+    ClimbSession* slab = new ClimbSession("Slab", 0, EASY, 3.0, gym);
+    slab->setTimestamp(300);
+    mgr.add(slab);
+    mgr.add(new ClimbSession("Arete", 0, HARD, 1.0, gym));
+    mgr.add(new TrainingSession("Hangboard", 0, MODERATE, 10));
+    mgr.add(new ClimbSession("Arete", 0, EASY, 2.0, gym));
+
+    vector<const Activity*> byName = mgr.sortedBy(SortKey::NAME);
+    CHECK(byName[0]->getName() == "Arete");
+    CHECK(byName[0]->getDifficulty() == HARD);   // ties keep list order
+    CHECK(byName[3]->getName() == "Slab");
+    CHECK(mgr.binarySearchByName("Arete") == 1);
+    CHECK(mgr.binarySearchByName("Hangboard") == 2);
+    CHECK(mgr.binarySearchByName("Crimp") == -1);
+
+    const vector<int>& byHours = mgr.orderedPositions(SortKey::HOURS);
+    CHECK(byHours == vector<int>{ 2, 1, 3, 0 });   // training has no hours
+    CHECK(mgr.sortedBy(SortKey::TIMESTAMP).back() == slab);
+    CHECK(mgr.sortedBy(SortKey::DIFFICULTY).back()->getDifficulty() == HARD);
+
+    mgr.remove(1);
+    mgr.addToFront(new ClimbSession("Bulge", 0, EXTREME, 0.5, gym));
+    CHECK(mgr.orderedPositions(SortKey::HOURS) == vector<int>{ 2, 0, 3, 1 });
+    CHECK(mgr.binarySearchByName("Arete") == 3);
+    CHECK(mgr.binarySearchByName("Bulge") == 0);
+
+    mgr.update(0, [](Activity& act) { act.setName("Zawn"); });
+    CHECK(mgr.sortedBy(SortKey::NAME).back()->getName() == "Zawn");
     mgr.clear();
 }
 
-TEST_CASE("Linked list delete removes existing node") {
-    ActivityManager mgr;
-    Location loc("Gym", true);
+#if defined(__linux__) && defined(TRACKER_HAS_COROUTINES)
+// ===== ASYNC IMPORT / EXPORT TESTS
+TEST_CASE("syncWait returns values and rethrows for void and non-void tasks") {
+    int ran = 0;
+    auto count = [&ran]() -> Task<void> { ran++; co_return; };
+    auto answer = []() -> Task<int> { co_return 42; };
+    auto fail = []() -> Task<void> {
+        throw runtime_error("task failed");
+        co_return;
+    };
 
-    mgr.add(new ClimbSession("A", 0, EASY, 1.0, loc));
-    mgr.add(new ClimbSession("B", 0, EASY, 1.0, loc));
+    syncWait(count());
+    CHECK(ran == 1);
+    CHECK(syncWait(answer()) == 42);
+    CHECK_THROWS_AS(syncWait(fail()), runtime_error);
+}
 
-    mgr.remove(0);
+TEST_CASE("Async import and export match the synchronous versions") {
+    ClimbingTracker source;
+    for (int i = 0; i < 3000; i++) {
+        if (i % 3 == 0) {
+            source.addSession(new TrainingSession("Board-" + to_string(i), 0, HARD, 1 + i % 20));
+            continue;
+        }
+        ClimbSession* cs = new ClimbSession("Route-" + to_string(i), 0, static_cast<ClimbDifficulty>(1 + i % 4),
+            0.5 + (i % 7) * 0.25, Location(i % 2 ? "Gym" : "Crag", i % 2 == 1));
+        if (i % 5 == 0) cs->setGrade(Grade(i % 12, V_SCALE));
+        cs->setTimestamp(1700000000LL + i);
+        source.addSession(cs);
+    }
 
-    CHECK(mgr.getSize() == 1);
-    CHECK(mgr[0]->getName() == "B");
+    string base = "/tmp/tracker-io-" + to_string(getpid());
+    long long bytes = exportCommandsSync(base + ".sync", source.getActivities());
+    string expected;
+    REQUIRE(readWholeFile(base + ".sync", expected));
+    CHECK(static_cast<long long>(expected.size()) == bytes);
+
+    ClimbingTracker syncCopy;
+    ImportResult syncResult = importCommandsSync(base + ".sync", syncCopy, 4096);
+    CHECK(syncResult.commands == 3000);
+    CHECK(syncResult.failures == 0);
+
+    for (bool uring : { false, true }) {
+        IoExecutor* io = makeIoExecutor(uring, 2);
+        ClimbingTracker copy;
+        ImportResult result = syncWait(importCommandsAsync(*io, base + ".sync", copy, 4, 4096));
+        CHECK(result.commands == 3000);
+        CHECK(result.failures == 0);
+        CHECK(result.bytes == bytes);
+        CHECK(copy.getTotalHours() == syncCopy.getTotalHours());
+        CHECK(copy.getClimbSessionCount() == 2000);
+        CHECK(copy.getPyramid().getTotal() == source.getPyramid().getTotal());
+
+        CHECK(syncWait(exportCommandsAsync(*io, base + ".async", copy.getActivities(), 3, 4096)) == bytes);
+        string written;
+        REQUIRE(readWholeFile(base + ".async", written));
+        CHECK(written == expected);
+
+        CHECK_THROWS_AS(syncWait(importCommandsAsync(*io, base + ".missing", copy)), runtime_error);
+        delete io;
+
+        // a depth past the executor's queue is clamped to it
+        IoExecutor* small = makeIoExecutor(uring, 1, 4);
+        ClimbingTracker deep;
+        CHECK(syncWait(importCommandsAsync(*small, base + ".sync", deep, 1000, 4096)).commands == 3000);
+        CHECK(syncWait(exportCommandsAsync(*small, base + ".async", deep.getActivities(), 1000, 4096)) == bytes);
+        delete small;
+    }
 
-    mgr.clear();
+    // blank, CRLF and indented comment lines are not counted as commands
+    {
+        ofstream noisy(base + ".noisy", ios::binary);
+        noisy << "\r\n\n  # indented comment\r\nadd-training Board|2|10\r\n\t# tabbed\n   \nadd-training Board|1|5\n";
+    }
+    ClimbingTracker noisySync;
+    ImportResult noisyResult = importCommandsSync(base + ".noisy", noisySync, 8);
+    CHECK(noisyResult.commands == 2);
+    CHECK(noisyResult.failures == 0);
+    IoExecutor* noisyIo = makeIoExecutor(false, 2);
+    ClimbingTracker noisyAsync;
+    ImportResult noisyAsyncResult = syncWait(importCommandsAsync(*noisyIo, base + ".noisy", noisyAsync, 2, 8));
+    CHECK(noisyAsyncResult.commands == 2);
+    CHECK(noisyAsyncResult.failures == 0);
+    CHECK(noisyAsync.getActivities().getSize() == 2);
+    delete noisyIo;
+
+    remove((base + ".sync").c_str());
+    remove((base + ".async").c_str());
+    remove((base + ".noisy").c_str());
 }
+#endif
 
-TEST_CASE("Linked list delete node that does not exist throws") {
-    ActivityManager mgr;
+#ifdef __linux__
+// ===== BATCH REPORT TESTS
+TEST_CASE("Batch reports match the single-tracker report file") {
+    ClimbingTracker tracker;
+    tracker.setClimberName("Alex Honnold");
+    tracker.setClimbingDays(90);
+    tracker.addSession(new ClimbSession("Arete", 0, HARD, 200.0, Location("Crag", false)));
+
+    string dir = "/tmp/tracker-reports-" + to_string(getpid());
+    REQUIRE(mkdir(dir.c_str(), 0755) == 0);
+    REQUIRE(tracker.writeReportFile(dir + "/single.txt"));
+    string single;
+    REQUIRE(readWholeFile(dir + "/single.txt", single));
+    CHECK(single.find("Experience Level: Advanced\nClimber Type: Frequent Climber\n") != string::npos);
+
+    ClimberRegistry registry;
+    registry.addTracker(tracker);
+    for (int i = 1; i < 300; i++) {
+        TrackerSummary member;
+        member.climberName = "Member/" + to_string(i);
+        member.totalHours = i;
+        member.climbingDays = i % 100;
+        registry.add(member);
+    }
+    CHECK_THROWS_AS(registry[300], IndexOutOfRange);
 
-    CHECK_THROWS_AS(mgr.remove(0), IndexOutOfRange);
+    vector<IoExecutor*> executors{ nullptr };
+#ifdef TRACKER_HAS_COROUTINES
+    executors.push_back(makeIoExecutor(true, 2, 32));
+#endif
+    for (IoExecutor* io : executors) {
+        ReportBatchResult result = writeClimberReports(registry, dir, io, 3);
+        CHECK(result.reports == 300);
+        CHECK(result.failures == 0);
+
+        string text;
+        REQUIRE(readWholeFile(reportFileName(dir, 0, "Alex Honnold"), text));
+        CHECK(text == single);
+        REQUIRE(readWholeFile(dir + "/299_Member_299.txt", text));
+        CHECK(text.compare(0, 17, "Name: Member/299\n") == 0);
+        CHECK(text.find("Climbing Days: 99\n") != string::npos);
+    }
+#ifdef TRACKER_HAS_COROUTINES
+    delete executors[1];
+#endif
+
+    ReportBatchResult missing = writeClimberReports(registry, dir + "/no-such-dir", nullptr, 2);
+    CHECK(missing.failures == 300);
+    CHECK(missing.bytes == 0);
+
+    // a low descriptor limit shrinks the window instead of failing opens
+    pid_t child = fork();
+    if (child == 0) {
+        rlimit low{ 128, 128 };
+        bool ok = setrlimit(RLIMIT_NOFILE, &low) == 0 && reportOpenWindow(300) == 128 - REPORT_FD_HEADROOM;
+        ReportBatchResult limited = writeClimberReports(registry, dir, nullptr, 3);
+        rlimit after{};
+        ok = ok && getrlimit(RLIMIT_NOFILE, &after) == 0 && after.rlim_cur == 128;   // left as it was
+
+        low.rlim_cur = 100;
+        ok = ok && setrlimit(RLIMIT_NOFILE, &low) == 0;
+        raiseReportDescriptorLimit(300);                                           // capped by the hard limit
+        ok = ok && getrlimit(RLIMIT_NOFILE, &after) == 0 && after.rlim_cur == 128;
+        _exit(ok && limited.failures == 0 && limited.bytes > 0 ? 0 : 1);
+    }
+    int status = -1;
+    waitpid(child, &status, 0);
+    CHECK(WIFEXITED(status));
+    CHECK(WEXITSTATUS(status) == 0);
+
+    for (int i = 0; i < registry.getSize(); i++)
+        remove(reportFileName(dir, i, registry[i].climberName).c_str());
+    remove((dir + "/single.txt").c_str());
+    CHECK(rmdir(dir.c_str()) == 0);
 }
+#endif
 
-TEST_CASE("Linked list search finds node") {
-    ActivityManager mgr;
-    Location loc("Gym", true);
+// ===== BENCHMARK TESTS
+TEST_CASE("Allocation counts follow DynamicArray doubling") {
+    AllocationCount before = allocationsSoFar();
+    {
+        DynamicArray<int> arr;              // capacity 5
+        for (int i = 0; i < 20; i++) arr.add(i);
+    }
+    AllocationCount after = allocationsSoFar();
+    CHECK(after.allocations - before.allocations == 3);   // 5, then 10 and 20
+    CHECK(after.bytes - before.bytes == (5 + 10 + 20) * sizeof(int));
+}
 
-    mgr.add(new ClimbSession("Boulder", 0, EASY, 1.0, loc));
-    mgr.add(new TrainingSession("Hangboard", 0, MODERATE, 10));
+TEST_CASE("Benchmarks cover every container and serialize to JSON") {
+    vector<BenchResult> results = runBenchmarks(100);
+    vector<string> names;
+    for (const BenchResult& r : results) {
+        CHECK(r.size == 100);
+        CHECK(r.ops > 0);
+        CHECK(r.nsPerOp >= 0.0);
+        names.push_back(r.name);
+    }
+    for (const char* name : { "ActivityLinkedList::insertBack", "ActivityLinkedList::deleteAtPosition",
+        "DynamicArray::resize", "arrayStack::push", "arrayQueue::addQueue", "ActivityManager::countTypeRecursive",
+        "ConcurrentActivityManager::summarize x1", "ConcurrentActivityManager::summarize x4" })
+        CHECK(find(names.begin(), names.end(), name) != names.end());
+
+    BenchResult* insert = &results[0];
+    CHECK(insert->allocationsPerOp == doctest::Approx(1.0));   // one node per insert
+    BenchResult* resize = nullptr;
+    for (BenchResult& r : results)
+        if (r.name == "DynamicArray::resize") resize = &r;
+    REQUIRE(resize != nullptr);
+    CHECK(resize->ops == 5);                                    // 5 -> 10 -> ... -> 160
+    CHECK(resize->allocationsPerOp == doctest::Approx(1.0));
+
+    string json = benchResultsJson(results);
+    CHECK(json.find("{\n  \"benchmarks\": [") == 0);
+    CHECK(json.find("{\"name\": \"arrayStack::push\", \"size\": 100, \"ops\": 100,") != string::npos);
+}
+
+// ===== STATISTICS TESTS
+TEST_CASE("Latency buckets are log-linear and percentiles stay inside them") {
+    for (uint64_t v = 0; v < 16; v++) CHECK(LatencyHistogram::bucketOf(v) == static_cast<int>(v));
+    CHECK(LatencyHistogram::bucketOf(16) == 16);
+    CHECK(LatencyHistogram::bucketOf(17) == 16);           // 16 and 17 share a bucket
+    CHECK(LatencyHistogram::bucketHigh(16) == 17);
+    for (uint64_t v = 8; v < 100000; v = v * 3 / 2 + 1) {
+        int b = LatencyHistogram::bucketOf(v);
+        CHECK(LatencyHistogram::bucketHigh(b) >= v);
+        CHECK(LatencyHistogram::bucketHigh(b - 1) < v);
+        CHECK(LatencyHistogram::bucketHigh(b) - v <= v / 8);
+    }
+    CHECK(LatencyHistogram::bucketOf(~0ULL) == LATENCY_BUCKETS - 1);
+
+    LatencyHistogram h;
+    CHECK(h.percentileNs(0.5) == 0);
+    for (uint64_t v = 1; v <= 1000; v++) h.record(v * 1000);
+    CHECK(h.getCount() == 1000);
+    CHECK(h.meanNs() == doctest::Approx(500500.0));
+    CHECK(h.getMaxNs() == 1000000);
+    CHECK(h.percentileNs(1.0) == 1000000);
+    uint64_t median = h.percentileNs(0.5);
+    CHECK(median >= 500000);
+    CHECK(median <= 500000 + 500000 / 8);
+}
 
-    CHECK(mgr.sequentialSearchByName("Hangboard") == 1);
+#ifndef TRACKER_NO_STATS
+TEST_CASE("Tracker operations are counted per operation, across threads") {
+    OpStatsSnapshot before = snapshotOpStats();
+    CHECK(before.enabled);
 
-    mgr.clear();
+    ClimbingTracker tracker;
+    CommandProcessor processor(tracker);
+    string out;
+    processor.executeAll("add-climb Arete|2|hard|Crag|outdoor\nadd-training Hangs|2|10\nquery Arete\nreport\n", out);
+    tracker.removeActivity(1);
+
+    // a finished thread's counts are kept
+    thread([&tracker] { tracker.findActivity("Hangs"); }).join();
+
+    OpStatsSnapshot after = snapshotOpStats();
+    auto delta = [&](TrackedOp op) { return after[op].getCount() - before[op].getCount(); };
+    CHECK(delta(TrackedOp::ADD) == 2);
+    CHECK(delta(TrackedOp::REMOVE) == 1);
+    CHECK(delta(TrackedOp::SEARCH) == 2);
+    CHECK(delta(TrackedOp::REPORT) == 1);
+    CHECK(after[TrackedOp::ADD].getTotalNs() > before[TrackedOp::ADD].getTotalNs());
+
+    out.clear();
+    CHECK(processor.execute("stats", out));
+    CHECK(out.find("OK {\"enabled\":true,") == 0);
+    CHECK(out.find("\"remove\":{\"count\":") != string::npos);
+    CHECK(out.back() == '\n');
 }
+#endif
 
-TEST_CASE("Linked list search returns -1 when not found") {
-    ActivityManager mgr;
-    Location loc("Gym", true);
+// ===== TERMINAL TESTS
+TEST_CASE("Console attributes map onto ANSI colors") {
+    CHECK(Terminal::ansiCode(7) == 0);
+    CHECK(Terminal::ansiCode(10) == 92);   // green
+    CHECK(Terminal::ansiCode(11) == 96);   // cyan
+    CHECK(Terminal::ansiCode(12) == 91);   // red
+    CHECK(Terminal::ansiCode(14) == 93);   // yellow
+    CHECK(Terminal::ansiCode(4) == 31);
+}
 
-    mgr.add(new ClimbSession("Boulder", 0, EASY, 1.0, loc));
+struct WriteCounter : streambuf {
+    string text;
+    int writes = 0;
 
-    CHECK(mgr.sequentialSearchByName("Campus") == -1);
+    int_type overflow(int_type ch) override {
+        text += traits_type::to_char_type(ch);
+        writes++;
+        return ch;
+    }
+    streamsize xsputn(const char* s, streamsize n) override {
+        text.append(s, static_cast<size_t>(n));
+        writes++;
+        return n;
+    }
+};
 
-    mgr.clear();
-}
+TEST_CASE("A screen is written once, when input is read") {
+    WriteCounter counter;
+    streambuf* original = cout.rdbuf(&counter);
+    bool hadColor = Terminal::instance().colorEnabled();
+    Terminal::instance().setColorEnabled(true);
+    {
+        ScreenOutput screen;
+        setColor(14);
+        cout << "====== MENU ======" << endl;
+        setColor(14);                          // unchanged, nothing sent
+        setColor(10);
+        cout << "1. Add Climb Session\n" << "Choice: " << flush;
+        CHECK(counter.writes == 0);
 
-TEST_CASE("Traversing empty linked list is safe") {
-    ActivityManager mgr;
+        cin.tie()->flush();                    // what cin >> does first
+        CHECK(counter.writes == 1);
+        CHECK(counter.text == "\033[93m====== MENU ======\n\033[92m1. Add Climb Session\nChoice: ");
 
-    CHECK(mgr.getSize() == 0);
-    CHECK(mgr.sequentialSearchByName("Anything") == -1);
+        cout << "Goodbye!\n";
+    }
+    CHECK(counter.writes == 2);
+    CHECK(counter.text.substr(counter.text.size() - 13) == "Goodbye!\n\033[0m");
+    CHECK(cout.rdbuf() == &counter);
+    CHECK(cin.tie() == &cout);
+
+    Terminal::instance().setColorEnabled(false);
+    setColor(12);
+    CHECK(counter.writes == 2);
+    cout.rdbuf(original);
+    Terminal::instance().setColorEnabled(hadColor);
 }
 
-TEST_CASE("Iterator starts at front and advances correctly") {
-    ActivityLinkedList list;
-    Location loc("Gym", true);
+#ifdef __linux__
+TEST_CASE("A screen on the real stdout reaches the descriptor only when presented") {
+    int pipeEnds[2];
+    REQUIRE(pipe(pipeEnds) == 0);
+    fcntl(pipeEnds[0], F_SETFL, O_NONBLOCK);
+    cout.flush();
+    fflush(stdout);
+    int savedStdout = dup(STDOUT_FILENO);
+    dup2(pipeEnds[1], STDOUT_FILENO);
+
+    char received[256];
+    ssize_t early, late;
+    {
+        ScreenOutput screen;
+        cout << "Choice: " << 'x' << endl;
+        early = read(pipeEnds[0], received, sizeof(received));
+        cin.tie()->flush();
+        late = read(pipeEnds[0], received, sizeof(received));
+    }
 
-    list.insertBack(new ClimbSession("A", 0, EASY, 1.0, loc));
-    list.insertBack(new ClimbSession("B", 0, EASY, 1.0, loc));
+    dup2(savedStdout, STDOUT_FILENO);
+    close(savedStdout);
+    close(pipeEnds[0]);
+    close(pipeEnds[1]);
+    CHECK(early < 0);
+    REQUIRE(late == 10);
+    CHECK(string(received, 10) == "Choice: x\n");
+}
+#endif
 
-    ActivityLinkedList::Iterator it = list.begin();
+// ===== ALLOCATION TESTS
+TEST_CASE("Allocation scopes see live bytes, peaks and frees") {
+    // read every counter before asserting: the assertions allocate too
+    unsigned long long innerAllocations, outerAllocations, outerFrees;
+    long long innerPeak, held, outerPeak, afterFree;
+    {
+        AllocationScope outer;
+        vector<char> kept(1000, 'k');
+        {
+            AllocationScope inner;
+            vector<int> temporary(10000, 1);
+            innerAllocations = inner.allocations();
+            innerPeak = inner.peakBytes();
+        }
+        outerAllocations = outer.allocations();
+        outerFrees = outer.deallocations();
+        held = outer.netBytes();
+        outerPeak = outer.peakBytes();
+        kept = vector<char>();
+        afterFree = outer.netBytes();
+    }
+    CHECK(innerAllocations == 1);
+    CHECK(innerPeak == static_cast<long long>(10000 * sizeof(int)));
+    CHECK(outerAllocations == 2);
+    CHECK(outerFrees == 1);
+    CHECK(held == 1000);
+    CHECK(outerPeak == static_cast<long long>(1000 + 10000 * sizeof(int)));   // the inner peak carries out
+    CHECK(afterFree == 0);
+}
 
-    REQUIRE(it.hasCurrent());
-    CHECK(it.getData()->getName() == "A");
+TEST_CASE("Tracker operations stay within their allocation budgets") {
+    ClimbingTracker tracker;
+    tracker.setClimberName("Alex");
+    // 65 adds: the 65th grows every 64-row index column, so the measured
+    // add is the 66th and lands between growths, at a place already known
+    for (int i = 0; i < 65; i++)
+        tracker.addSession(new ClimbSession("Warmup", 0, EASY, 1.0, Location("Gym", true)));
+
+    ClimbSession* session = new ClimbSession("Arete", 0, HARD, 2.0, Location("Gym", true));
+    unsigned long long addAllocations, searchAllocations;
+    int found;
+    {
+        AllocationScope add;
+        tracker.addSession(session);
+        addAllocations = add.allocations();
+    }
+    {
+        AllocationScope search;
+        found = tracker.findActivity("Arete");
+        searchAllocations = search.allocations();
+    }
+    CHECK(found == 65);
+    CHECK(addAllocations <= 2);           // list node and published summary
+    CHECK(searchAllocations == 0);
+}
 
-    it.next();
-    REQUIRE(it.hasCurrent());
-    CHECK(it.getData()->getName() == "B");
+#ifndef TRACKER_NO_TRACE
+// ===== TRACING TESTS
+TEST_CASE("Spans from worker threads export as Chrome trace events") {
+    clearTrace();
+    ClimbingTracker tracker;
+    tracker.addSession(new ClimbSession("Untraced", 0, EASY, 1.0, Location("Gym", true)));
+    CHECK(collectTrace().empty());
+
+    enableTracing(true);
+    CommandProcessor processor(tracker);
+    string response;
+    processor.execute("add-climb Arete|2|3|Crag|outdoor", response);
+    processor.execute("report", response);
+    vector<int> order(4 * PARALLEL_SORT_GRAIN);
+    for (size_t i = 0; i < order.size(); i++) order[i] = static_cast<int>(order.size() - i);
+    parallelMergeSort(order, [](int a, int b) { return a < b; }, 4);
+    enableTracing(false);
+
+    vector<TraceSpan> spans = collectTrace();
+    auto named = [&spans](const char* name) {
+        vector<TraceSpan> found;
+        for (const TraceSpan& s : spans) if (string(s.name) == name) found.push_back(s);
+        return found;
+    };
+    CHECK(named("add").size() == 1);
+    CHECK(named("report").size() == 1);
+    REQUIRE(named("sort").size() == 1);
+    vector<TraceSpan> chunks = named("sort chunk");
+    REQUIRE(chunks.size() == 4);
+    int otherThreads = 0;
+    for (const TraceSpan& c : chunks) {
+        if (c.thread != named("sort")[0].thread) otherThreads++;
+        CHECK(c.startNs >= named("sort")[0].startNs);           // nested inside the sort
+        CHECK(c.startNs + c.durationNs <= named("sort")[0].startNs + named("sort")[0].durationNs);
+    }
+    CHECK(otherThreads == 3);
+    CHECK(named("sort merge").size() == 3);
+
+    string json = chromeTraceJson(spans);
+    CHECK(json.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[") == 0);
+    CHECK(json.find("{\"name\":\"add\",\"cat\":\"tracker\",\"ph\":\"X\",\"pid\":1,\"tid\":") != string::npos);
+    clearTrace();
+    CHECK(collectTrace().empty());
+}
 
-    it.next();
-    CHECK_FALSE(it.hasCurrent());
+TEST_CASE("A thread's trace ring keeps its newest spans") {
+    clearTrace();
+    enableTracing(true);
+    thread([] {
+        for (int i = 0; i < TRACE_RING_SPANS + 10; i++) recordSpan(i < 10 ? "old" : "new", i, 1);
+    }).join();
+    enableTracing(false);
+
+    vector<TraceSpan> spans = collectTrace();
+    // the oldest slot of a full ring may be mid-overwrite, so it is skipped
+    REQUIRE(spans.size() == static_cast<size_t>(TRACE_RING_SPANS - 1));
+    CHECK(string(spans.front().name) == "new");
+    CHECK(spans.back().startNs == static_cast<uint64_t>(TRACE_RING_SPANS + 9));
+    clearTrace();
 }
-TEST_CASE("Recursive count still works with linked list storage") {
+#endif
+
+// ===== MEMORY FOOTPRINT TESTS
+TEST_CASE("Footprint breaks one activity down by payload, strings and nodes") {
     ActivityManager mgr;
-    Location loc("Gym", true);
+    MemoryFootprint empty = mgr.footprint();
+    CHECK(empty.payload == sizeof(ActivityManager));
+    CHECK(empty.strings == 0);
+
+    mgr.add(new ClimbSession("Slab", 0, EASY, 1.0, Location("Gym", true)));
+    MemoryFootprint one = mgr.footprint();
+    mgr.add(new ClimbSession("A name past the inline buffer", 0, HARD, 2.0, Location("Gym", true)));
+    MemoryFootprint two = mgr.footprint();
+    CHECK(two.payload - one.payload == sizeof(ClimbSession));
+    CHECK(two.nodes - one.nodes == 2 * sizeof(void*));        // data and next; "Gym" is already interned
+    CHECK(two.strings - one.strings == string("A name past the inline buffer").size() + 1);
+    CHECK(one.auxiliary > empty.auxiliary);                    // index row, hours column, bitmaps
+
+    mgr.add(new TrainingSession("Core", 0, EASY, 10));
+    CHECK(mgr.footprint().payload - two.payload == sizeof(TrainingSession));
+
+    DynamicArray<int> arr;                                     // capacity 5
+    arr.add(1);
+    arr.add(2);
+    CHECK(arr.footprint().payload == sizeof(arr) + 2 * sizeof(int));
+    CHECK(arr.footprint().slack == 3 * sizeof(int));
+}
 
-    mgr.add(new ClimbSession("Route 1", 0, EASY, 1.0, loc));
-    mgr.add(new TrainingSession("Hangboard", 0, MODERATE, 10));
-    mgr.add(new ClimbSession("Route 2", 0, HARD, 2.0, loc));
+#ifdef TRACKER_TRACK_ALLOCATIONS
+TEST_CASE("Tracker footprint matches the bytes it allocated") {
+    WorkloadProfile profile;
+    profile.activitiesPerClimber = 5000;
+    long long allocated;
+    MemoryFootprint f;
+    {
+        AllocationScope scope;
+        ClimbingTracker* tracker = new ClimbingTracker();
+        WorkloadGenerator gen(profile, 0);
+        ActivityRecord record;
+        while (!gen.done()) {
+            gen.next(record);
+            tracker->addSession(activityFromRecord(record));
+        }
+        f = tracker->footprint();
+        allocated = scope.netBytes();
+        delete tracker;
+    }
+    MESSAGE("footprint " << f.total() << " bytes, allocated " << allocated);
+    CHECK(static_cast<double>(f.total()) == doctest::Approx(static_cast<double>(allocated)).epsilon(0.05));
+}
+#endif
 
-    CHECK(mgr.countTypeRecursive("Climb Session") == 2);
-    CHECK(mgr.countTypeRecursive("Training Session") == 1);
+// ===== PERFORMANCE GATE TESTS
+TEST_CASE("Perf gate fails scenarios that regress past their tolerance") {
+    vector<BenchResult> baseline = {
+        { "report", 100, 100, 50.0, 2.0, 64.0 },
+        { "bulk-add", 1000, 1000, 400.0, 40.0, 3000.0 },
+        { "name-search", 100, 200, 900.0, 0.0, 0.0 } };
+    vector<PerfBaseline> parsed;
+    string error;
+    REQUIRE(parsePerfBaseline(perfBaselineText(baseline) + "\n# trailing comment\n", parsed, error));
+    REQUIRE(parsed.size() == 3);
+    CHECK(parsed[1].name == "bulk-add");
+    CHECK(parsed[1].allocationsPerOp == doctest::Approx(40.0));
+    CHECK(parsed[1].timeTolerance == doctest::Approx(PERF_TIME_TOLERANCE));
+
+    vector<BenchResult> measured = baseline;
+    measured[0].nsPerOp = 60.0;             // 20% slower, inside the tolerance
+    measured[1].allocationsPerOp = 41.0;    // 2.5% more allocations
+    measured[2].size = 1000;                // no baseline at this size
+    vector<PerfCheck> checks = comparePerf(measured, parsed);
+    CHECK(checks[0].passed());
+    CHECK_FALSE(checks[1].allocationsOk());
+    CHECK(checks[1].timeOk());
+    CHECK_FALSE(checks[2].passed());
+
+    measured[0].nsPerOp = 70.0;
+    CHECK_FALSE(comparePerf(measured, parsed)[0].timeOk());
+    CHECK_FALSE(parsePerfBaseline("report|100|fast|2|0.3|0.02\n", parsed, error));
+    CHECK(error.find("line 1") == 0);
+}
 
-    mgr.clear();
+TEST_CASE("Perf scenarios run at reduced sizes") {
+    vector<BenchResult> results = runPerfScenarios(1000);
+    REQUIRE(results.size() == 3);
+    CHECK(results[0].name == "report");
+    CHECK(results[0].size == PERF_REPORT_SESSIONS / 1000);
+    CHECK(results[1].size == PERF_BULK_ADD_SESSIONS / 1000);
+    CHECK(results[2].ops == PERF_SEARCHES);
+    CHECK(results[2].allocationsPerOp == 0.0);
+    CHECK(results[1].nsPerOp > 0.0);
 }
-TEST_CASE("Printing empty linked list is safe") {
+
+// ===== WORKLOAD GENERATOR TESTS
+TEST_CASE("Workload generator is seeded and writes the same text as the manager") {
+    WorkloadProfile profile;
+    profile.activitiesPerClimber = 2000;
+    profile.seed = 42;
+
     ActivityManager mgr;
-    CHECK_NOTHROW(mgr.displayAll());
-}
+    generateActivities(profile, 3, mgr);
+    REQUIRE(mgr.getSize() == 2000);
+    string fromManager = "name " + workloadClimberName(3) + "\n";
+    for (const Activity* act : mgr.select(mgr.allActivities()))
+        CommandProcessor::appendCommand(fromManager, *act);
+
+    string generated, again, otherClimber;
+    appendWorkloadCommands(generated, profile, 3);
+    appendWorkloadCommands(again, profile, 3);
+    appendWorkloadCommands(otherClimber, profile, 4);
+    CHECK(generated == fromManager);
+    CHECK(generated == again);
+    CHECK(generated != otherClimber);
 
-//Doctests added by Chris Noonan as part of the Week 11 assignment
-TEST_CASE("arrayStack basic operations")
-{
-    arrayStack<int> s(5);
+    ClimbingTracker tracker;
+    CommandProcessor processor(tracker, true);
+    string errors;
+    CHECK(processor.executeAll(generated, errors) == 0);
+    CHECK(tracker.getActivityCount() == 2000);
+    CHECK(tracker.getClimberName() == "Climber 4");
+}
 
-    CHECK(s.isEmptyStack() == true);
+// integer draws only, so these lines are the same on every platform
+TEST_CASE("Workload generator output is fixed by the seed") {
+    WorkloadProfile profile;
+    profile.seed = 42;
+    profile.activitiesPerClimber = 4;
+    string text;
+    appendWorkloadCommands(text, profile, 0);
+    CHECK(text == "name Climber 1\n"
+        "add-climb Traverse 74|1.75|2|Eagle Bluff 3|indoor||1704131826\n"
+        "add-climb Overhang 99|1.25|2|Boulder Barn|indoor||1711996096\n"
+        "add-training Campus Board 16|1|30|1719833457\n"
+        "add-climb Overhang 44|3|3|Sandstone Ridge 2|outdoor||1727703361\n");
+}
 
-    s.push(10);
-    s.push(20);
-    s.push(30);
+TEST_CASE("Workload generator follows its profile") {
+    WorkloadProfile profile;
+    profile.activitiesPerClimber = 20000;
+    profile.climbShare = 0.8;
+    profile.indoorShare = 0.25;
+    profile.placeCount = 5;
+    profile.minReps = 10;
+    profile.maxReps = 12;
+    profile.days = 30;
+
+    WorkloadGenerator gen(profile, 0);
+    ActivityRecord r;
+    int climbs = 0, indoor = 0, firstPlace = 0, unknownPlace = 0;
+    int difficulty[5] = { 0, 0, 0, 0, 0 };
+    long long lastDay = 0;
+    bool repsInRange = true, hoursInRange = true, ordered = true;
+    while (!gen.done()) {
+        gen.next(r);
+        difficulty[r.difficulty]++;
+        long long day = (r.timestamp - profile.startTimestamp) / SECONDS_PER_DAY;
+        ordered = ordered && day >= lastDay && day < profile.days;
+        lastDay = day;
+        if (r.kind == ActivityKind::TRAINING) {
+            repsInRange = repsInRange && r.reps >= 10 && r.reps <= 12;
+            continue;
+        }
+        climbs++;
+        if (r.indoor) indoor++;
+        hoursInRange = hoursInRange && r.hours >= 0.5 && r.hours <= 4.0 && r.hours * 4 == floor(r.hours * 4);
+        if (r.place == "Red River Gorge") firstPlace++;
+        if (r.place == "Eagle Bluff" || r.place == "Sandstone Ridge") unknownPlace++;   // past the first five
+    }
+    CHECK(climbs == doctest::Approx(16000).epsilon(0.03));
+    CHECK(indoor == doctest::Approx(climbs * 0.25).epsilon(0.05));
+    CHECK(difficulty[EASY] > difficulty[MODERATE]);
+    CHECK(difficulty[MODERATE] > difficulty[HARD]);
+    CHECK(difficulty[HARD] > difficulty[EXTREME]);
+    CHECK(firstPlace > climbs / 3);   // skew 2: the first of five places takes ~45%
+    CHECK(unknownPlace == 0);
+    CHECK(repsInRange);
+    CHECK(hoursInRange);
+    CHECK(ordered);
+}
 
-    CHECK(s.isEmptyStack() == false);
-    CHECK(s.top() == 30);
+// ===== PAGER TESTS
+TEST_CASE("Pager renders only the current page and jumps to any page") {
+    ClimbingTracker tracker;
+    for (int i = 0; i < 45; i++) {
+        if (i % 3 == 2) tracker.addSession(new TrainingSession("Core " + to_string(i), 0, MODERATE, 12));
+        else tracker.addSession(new ClimbSession("Route " + to_string(i), 0, HARD, 1.5, Location("Red River Gorge", false)));
+    }
+    ActivityPager pager(tracker);
+    CHECK(pager.getPageCount() == 3);
+
+    pager.goTo(2);
+    string page = pager.render();
+    CHECK(page.find("Activities 41-45 of 45 (page 3 of 3)") != string::npos);
+    CHECK(page.find("     40  Climb     Route 40                Hard       1.5 hrs, Red River Gorge (Outdoor)\n") != string::npos);
+    CHECK(page.find("     44  Training  Core 44                 Moderate   12 reps\n") != string::npos);
+    CHECK(page.find("Route 39") == string::npos);
+
+    pager.goTo(99);
+    CHECK(pager.getPage() == 2);
+    pager.first();
+    pager.previous();
+    CHECK(pager.getPage() == 0);
+
+    pager.render();                       // the buffer has grown to a full page
+    pager.next();
+    unsigned long long allocations;
+    {
+        AllocationScope scope;
+        pager.render();
+        allocations = scope.allocations();
+    }
+    CHECK(allocations == 0);
+
+#ifdef __linux__
+    // the page bypasses cout and lands on the stdout descriptor
+    int pipeEnds[2];
+    REQUIRE(pipe(pipeEnds) == 0);
+    cout.flush();
+    fflush(stdout);
+    int savedStdout = dup(STDOUT_FILENO);
+    dup2(pipeEnds[1], STDOUT_FILENO);
+    bool shown = pager.show();
+    dup2(savedStdout, STDOUT_FILENO);
+    close(savedStdout);
+    close(pipeEnds[1]);
+    string written;
+    char chunk[4096];
+    for (ssize_t n; (n = read(pipeEnds[0], chunk, sizeof(chunk))) > 0;) written.append(chunk, static_cast<size_t>(n));
+    close(pipeEnds[0]);
+    CHECK(shown);
+    CHECK(written == pager.render());
+    CHECK(written.find("(page 2 of 3)") != string::npos);
+#endif
 
-    s.pop();
-    CHECK(s.top() == 20);
+    for (int i = 0; i < 30; i++) tracker.removeActivity(0);
+    pager.last();
+    CHECK(pager.render().find("Activities 1-15 of 15 (page 1 of 1)") != string::npos);
+}
 
-    s.pop();
-    s.pop();
+// ===== REPORT TEMPLATE TESTS
+TEST_CASE("Compiled report templates reproduce the saved and screen layouts") {
+    TrackerSummary s;
+    s.climberName = "Alex Honnold";
+    s.totalHours = 127;
+    s.climbingDays = 38;
+    s.climbSessions = 30;
+    s.trainingSessions = 8;
+    double avg = static_cast<double>(s.totalHours) / s.climbingDays;
+    string_view level = EXPERIENCE_LABELS[experienceCode(s.totalHours)];
+    string_view type = FREQUENCY_LABELS[climberTypeCode(s.climbingDays)];
+    string_view rating = DEDICATION_LABELS[performanceCode(avg)];
+
+    char saved[REPORT_FIXED_BYTES];
+    string expected = "Name: Alex Honnold\nTotal Hours: 127\nClimbing Days: 38\nAvg Hours / Session: 3.3\n"
+        "Experience Level: " + string(level) + "\nClimber Type: " + string(type) +
+        "\nPerformance Rating: " + string(rating) + "\n";
+    CHECK(string(saved, renderReport(s, saved, sizeof(saved))) == expected);
+    CHECK(renderReport(s, saved, 10) == expected.size());
+    CHECK(string(saved, 10) == "Name: Alex");
+
+    ostringstream screen;
+    screen << left << setw(25) << "Name:" << s.climberName << "\n"
+        << setw(25) << "Total Hours:" << s.totalHours << "\n"
+        << setw(25) << "Climbing Days:" << s.climbingDays << "\n"
+        << setw(25) << "Avg Hours / Session:" << fixed << setprecision(1) << avg << "\n"
+        << setw(25) << "Experience Level:" << level << "\n"
+        << setw(25) << "Climber Type:" << type << "\n"
+        << setw(25) << "Performance Rating:" << rating << "\n"
+        << setw(25) << "Climb Sessions:" << s.climbSessions << "\n"
+        << setw(25) << "Training Sessions:" << s.trainingSessions << "\n";
+    string text;
+    reportTemplate(ReportLayout::SCREEN).render(s, text);
+    CHECK(text == screen.str());
+
+    ReportTemplate custom("[{name}] {climbs}/{training}");
+    CHECK(custom.instructionCount() == 6);
+    custom.render(s, text);
+    CHECK(text == "[Alex Honnold] 30/8");
+    CHECK_THROWS_AS(ReportTemplate("{hours}"), runtime_error);
+    CHECK_THROWS_AS(ReportTemplate("Name: {name"), runtime_error);
+}
 
-    CHECK(s.isEmptyStack() == true);
+TEST_CASE("Tracker reports are cached until the aggregates change") {
+    ClimbingTracker tracker;
+    tracker.setClimberName("Lynn Hill");
+    tracker.setClimbingDays(4);
+    tracker.addSession(new ClimbSession("Nose", 0, EXTREME, 6.0, Location("Yosemite", false)));
+
+    const string& saved = tracker.renderedReport(ReportLayout::SAVED);
+    CHECK(saved.find("Total Hours: 6\n") != string::npos);
+    const char* data = saved.data();
+    unsigned long long allocations;
+    {
+        AllocationScope scope;
+        for (int i = 0; i < 100; i++) tracker.renderedReport(ReportLayout::SAVED);
+        allocations = scope.allocations();
+    }
+    CHECK(allocations == 0);
+    CHECK(tracker.renderedReport(ReportLayout::SAVED).data() == data);
+
+    tracker.addSession(new ClimbSession("Dawn Wall", 0, EXTREME, 9.0, Location("Yosemite", false)));
+    CHECK(&tracker.renderedReport(ReportLayout::SAVED) == &saved);
+    CHECK(saved.find("Total Hours: 15\n") != string::npos);
+    tracker.setClimbingDays(5);
+    CHECK(tracker.renderedReport(ReportLayout::SAVED).find("Climbing Days: 5\n") != string::npos);
+    CHECK(tracker.renderedReport(ReportLayout::PROTOCOL).compare(0, 35, "OK name=Lynn Hill|total_hours=15|da") == 0);
 }
 
-TEST_CASE("arrayQueue basic operations")
-{
-    arrayQueue<int> q(5);
+#ifdef __linux__
+// ===== SHARED STORE TESTS
+TEST_CASE("Shared store keeps offset records readable from a second mapping") {
+    string segment = "/tracker-test-" + to_string(getpid());
+    SharedActivityStore writer(segment, 8, 64);
+    SharedActivityStore reader(segment);
+
+    ActivityRecord rec;
+    rec.assign(ClimbSession("Arete", 0, HARD, 2.5, Location("Red Rocks", false)));
+    CHECK(writer.append(rec));
+    rec.assign(TrainingSession("Hangboard", 0, EASY, 12));
+    CHECK(writer.insert(0, rec));
+
+    vector<ActivityRecord> seen = reader.snapshot();
+    REQUIRE(seen.size() == 2);
+    CHECK(seen[0].name == "Hangboard");
+    CHECK(seen[0].reps == 12);
+    CHECK(seen[1].place == "Red Rocks");
+    CHECK(seen[1].hours == doctest::Approx(2.5));
+    CHECK(seen[1].kind == ActivityKind::CLIMB);
+    CHECK(reader.getVersion() == 2);
+
+    // removed text is compacted away once the arena fills
+    for (int i = 0; i < 6; i++) {
+        rec.name = "Repeat-" + to_string(i);
+        CHECK(writer.replace(1, rec));
+    }
+    writer.remove(0);
+    CHECK(reader.snapshot()[0].name == "Repeat-5");
+    CHECK_THROWS_AS(reader.beginWrite(), runtime_error);
 
-    CHECK(q.isEmptyQueue() == true);
+    SharedActivityStore::unlink(segment);
+}
 
-    q.addQueue(10);
-    q.addQueue(20);
-    q.addQueue(30);
+TEST_CASE("Shared store readers give up on a write that never ends") {
+    string segment = "/tracker-test-stuck-" + to_string(getpid());
+    SharedActivityStore writer(segment, 8, 64);
+    SharedActivityStore reader(segment);
 
-    CHECK(q.front() == 10);
-    CHECK(q.back() == 30);
+    writer.beginWrite();   // as if the writer died here
+    int calls = 0;
+    CHECK_THROWS_AS(reader.read([&calls](const ShmView&) { calls++; }, chrono::milliseconds(20)), runtime_error);
+    CHECK(calls == 0);
+    writer.endWrite();
+    CHECK(reader.snapshot().empty());
 
-    q.deleteQueue();
+    SharedActivityStore::unlink(segment);
+}
 
-    CHECK(q.front() == 20);
+TEST_CASE("Another process reads what the tracker mirrors") {
+    string segment = "/tracker-test-mirror-" + to_string(getpid());
+    SharedActivityStore store(segment, 1024, 1 << 16);
+    SharedStoreMirror mirror(store);
 
-    q.deleteQueue();
-    q.deleteQueue();
+    ClimbingTracker tracker;
+    tracker.getEventBus().subscribe(&mirror);
+    for (int i = 0; i < 100; i++)
+        tracker.addSession(new ClimbSession("Lap", 0, EASY, 1.0, Location("Gym", true)));
+    tracker.removeActivity(0);
+    tracker.flushEvents();
+    CHECK(store.getSize() == 99);
+
+    pid_t child = fork();
+    if (child == 0) {
+        int ok = 0;
+        try {
+            SharedActivityStore view(segment);
+            double hours = 0.0;
+            view.read([&hours](const ShmView& v) {
+                hours = 0.0;
+                for (int i = 0; i < v.getSize(); i++) hours += v[i].hours;
+            });
+            ok = (view.getSize() == 99 && hours == 99.0) ? 1 : 0;
+        }
+        catch (...) {
+        }
+        _exit(ok ? 0 : 1);
+    }
+    int status = -1;
+    waitpid(child, &status, 0);
+    CHECK(WIFEXITED(status));
+    CHECK(WEXITSTATUS(status) == 0);
+    CHECK(mirror.getDropped() == 0);
 
-    CHECK(q.isEmptyQueue() == true);
+    SharedActivityStore::unlink(segment);
 }
+#endif
 
 #else
 // =======================================================
 // INTERACTIVE MAIN (NOT USED IN CI)
 // =======================================================
 
+// menu 10: the timing table, optionally dumped as JSON
+void displayStatistics(const ClimbingTracker& tracker) {
+    OpStatsSnapshot stats = snapshotOpStats();
+    setColor(11);
+    cout << "\n========= STATISTICS =========\n";
+    setColor(7);
+    printOpStats(cout, stats);
+    cout << "\nMemory held by this tracker:\n";
+    printFootprint(cout, tracker.footprint(), tracker.getActivityCount());
+    if (!stats.enabled || !getYesNo("Save statistics as JSON?")) return;
+
+    string filename;
+    cout << "Enter filename: ";
+    cin >> filename;
+    ofstream out(filename);
+    out << opStatsJson(stats) << '\n';
+    if (out) cout << "Statistics saved to " << filename << endl;
+    else cout << "Error saving statistics.\n";
+}
+
+// pages through the activities until the user quits
+void browseActivities(const ClimbingTracker& tracker) {
+    ActivityPager pager(tracker);
+    for (;;) {
+        pager.show();
+        string command;
+        if (!(cin >> command)) return;
+        switch (tolower(static_cast<unsigned char>(command[0]))) {
+        case 'n': pager.next(); break;
+        case 'p': pager.previous(); break;
+        case 'f': pager.first(); break;
+        case 'l': pager.last(); break;
+        case 'g': {
+            int target;
+            if (cin >> target) pager.goTo(target - 1);
+            else {
+                cin.clear();
+                cin.ignore(1000, '\n');
+            }
+            break;
+        }
+        case 'q': cout << '\n'; return;
+        default: break;
+        }
+    }
+}
+
 int runInteractive() {
+    ScreenOutput screen;
     ClimbingTracker tracker;
 
     displayBanner();
@@ -1682,6 +9908,9 @@ int runInteractive() {
         cout << "5. Load report\n";
         cout << "6. Exit\n";
         cout << "7. Delete Activity\n";
+        cout << "8. View Grade Pyramid\n";
+        cout << "9. View Hours by Location\n";
+        cout << "10. Statistics\n";
         cout << "Choice: ";
         cin >> choice;
 
@@ -1694,7 +9923,7 @@ int runInteractive() {
             break;
 
         case 3:
-            tracker.displayActivities();
+            browseActivities(tracker);
             break;
 
 
@@ -1728,7 +9957,15 @@ int runInteractive() {
             }
             break;
         }
-
+        case 8:
+            tracker.displayPyramid();
+            break;
+        case 9:
+            tracker.displayLocations();
+            break;
+        case 10:
+            displayStatistics(tracker);
+            break;
 
         default:
             setColor(12); // Red
@@ -1740,4 +9977,418 @@ int runInteractive() {
     } while (choice != 6);
     return 0;
 }
+
+// =======================================================
+// COMMAND LINE MODES
+//   --serve <endpoint> [workers] [--share <segment>]
+//   --loadgen <endpoint> [clients] [requests per client] [pipeline depth]
+//   --batch <script file or -> [--share <segment>]
+//   --read-shared <segment> [--unlink]
+//   --io-bench <command file> [depth] [chunk KB]
+//   --report-batch <directory> [members] [sync|pool|uring]
+//   --benchmark [--json] [--max-size <n>]
+//   --generate <directory> [climbers] [activities] [seed]
+//       writes <directory>/climber-<n>.txt, add-climb / add-training
+//       lines for --batch or --io-bench, identical for a given seed
+//   --perf-gate [baseline file] [--update]
+//       compares release-build timings with perf-baseline.txt (run
+//       from the project folder) or the given file; --update records
+//       this machine's numbers instead
+// --share mirrors the tracker into a shared-memory segment (for example
+// "/climbing") that --read-shared reads from another process
+// with no arguments the interactive menu runs
+// =======================================================
+#ifdef __linux__
+static TrackerServer* activeServer = nullptr;
+
+extern "C" void stopActiveServer(int) {
+    if (activeServer != nullptr) activeServer->stop();
+}
+
+const uint32_t SHARED_RECORDS = 1u << 18;
+const uint32_t SHARED_ARENA_BYTES = 8u << 20;
+
+// the tracker's changes reach the segment while this is alive
+class SharedMirrorScope {
+private:
+    ClimbingTracker& tracker;
+    SharedActivityStore store;
+    SharedStoreMirror mirror;
+    int subscription;
+
+public:
+    SharedMirrorScope(ClimbingTracker& t, const string& segment)
+        : tracker(t), store(segment, SHARED_RECORDS, SHARED_ARENA_BYTES), mirror(store),
+        subscription(t.getEventBus().subscribe(&mirror)) {
+    }
+
+    ~SharedMirrorScope() {
+        tracker.flushEvents();
+        tracker.getEventBus().unsubscribe(subscription);
+        if (mirror.getDropped() > 0)
+            cerr << mirror.getDropped() << " changes did not fit in " << store.getName() << endl;
+    }
+};
+
+static void printIoLine(const char* label, long long bytes, double seconds, long long commands) {
+    cout << "  " << left << setw(28) << label << fixed << setprecision(3) << seconds << " s  "
+        << setprecision(1) << (seconds > 0 ? bytes / seconds / (1024.0 * 1024.0) : 0.0) << " MB/s";
+    if (commands >= 0) cout << "  " << commands << " commands";
+    cout << endl;
+}
+
+// imports the file, then exports it again, synchronously and through each executor
+static int runIoBenchmark(const string& path, int depth, size_t chunk) {
+    string exportPath = path + ".export";
+    cout << "chunk " << chunk / 1024 << " KB, depth " << depth << endl;
+
+    ClimbingTracker syncTracker;
+    ImportResult sync = importCommandsSync(path, syncTracker, chunk);
+    printIoLine("sync import", sync.bytes, sync.seconds, sync.commands);
+    auto start = chrono::steady_clock::now();
+    long long written = exportCommandsSync(exportPath, syncTracker.getActivities(), chunk);
+    printIoLine("sync export", written, chrono::duration<double>(chrono::steady_clock::now() - start).count(), -1);
+
+#ifdef TRACKER_HAS_COROUTINES
+    for (bool uring : { false, true }) {
+        IoExecutor* io = makeIoExecutor(uring, 4);
+        if (uring && string(io->name()) != "io_uring") {
+            cout << "  io_uring unavailable" << endl;
+            delete io;
+            break;
+        }
+        ClimbingTracker tracker;
+        ImportResult result = syncWait(importCommandsAsync(*io, path, tracker, depth, chunk));
+        printIoLine((string("async import (") + io->name() + ")").c_str(), result.bytes, result.seconds, result.commands);
+
+        start = chrono::steady_clock::now();
+        written = syncWait(exportCommandsAsync(*io, exportPath, tracker.getActivities(), depth, chunk));
+        printIoLine((string("async export (") + io->name() + ")").c_str(), written,
+            chrono::duration<double>(chrono::steady_clock::now() - start).count(), -1);
+        delete io;
+    }
+#else
+    cout << "  async pipeline needs a C++20 compiler" << endl;
+#endif
+    remove(exportPath.c_str());
+    return sync.failures == 0 ? 0 : 1;
+}
+
+// writes a report for each member of a synthetic registry into directory
+static int runReportBatch(const string& directory, int members, const string& writer) {
+    ClimberRegistry registry;
+    registry.reserve(members);
+    for (int i = 0; i < members; i++) {
+        TrackerSummary member;
+        member.climberName = "Climber " + to_string(i + 1);
+        member.totalHours = (i * 37) % 1200;
+        member.climbingDays = (i * 11) % 365;
+        member.climbSessions = (i * 7) % 400;
+        member.trainingSessions = (i * 3) % 150;
+        registry.add(member);
+    }
+
+    IoExecutor* io = nullptr;
+#ifdef TRACKER_HAS_COROUTINES
+    if (writer != "sync") io = makeIoExecutor(writer == "uring", 4, 256);
+#else
+    if (writer != "sync") cout << "async writes need a C++20 compiler; writing synchronously" << endl;
+#endif
+    raiseReportDescriptorLimit(static_cast<size_t>(members));
+    ReportBatchResult result = writeClimberReports(registry, directory, io);
+#ifdef TRACKER_HAS_COROUTINES
+    const char* used = io != nullptr ? io->name() : "pwrite";
+    delete io;
+#else
+    const char* used = "pwrite";
+#endif
+
+    cout << result.reports << " reports (" << result.failures << " failed, " << result.bytes << " bytes) via "
+        << used << ": render " << fixed << setprecision(3) << result.renderSeconds << " s, write "
+        << result.writeSeconds << " s" << endl;
+    return result.failures == 0 ? 0 : 1;
+}
+
+static int readShared(const string& segment, bool unlinkAfter) {
+    SharedActivityStore store(segment);
+    vector<ActivityRecord> records = store.snapshot();
+
+    double hours = 0.0;
+    int climbs = 0;
+    for (const ActivityRecord& r : records) {
+        if (r.kind != ActivityKind::CLIMB) continue;
+        climbs++;
+        hours += r.hours;
+    }
+    cout << segment << " (version " << store.getVersion() << "): " << records.size()
+        << " activities, " << climbs << " climbs, " << fixed << setprecision(1) << hours << " hours" << endl;
+    for (const ActivityRecord& r : records) {
+        cout << "  " << left << setw(20) << r.name << setw(10) << difficultyToString(r.difficulty);
+        if (r.kind == ActivityKind::CLIMB)
+            cout << r.hours << " hrs at " << r.place << (r.indoor ? " (Indoor)" : " (Outdoor)");
+        else if (r.kind == ActivityKind::TRAINING)
+            cout << r.reps << " reps";
+        cout << '\n';
+    }
+
+    if (unlinkAfter) SharedActivityStore::unlink(segment);
+    return 0;
+}
+#endif
+
+// container microbenchmarks as a table, or JSON for tracking regressions
+static int runBenchmarkMode(int argc, char** argv) {
+    bool json = false;
+    long long maxSize = 1000000;
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--json") json = true;
+        else if (arg == "--max-size" && i + 1 < argc) maxSize = atoll(argv[++i]);
+        else {
+            cerr << "Unknown benchmark option " << arg << endl;
+            return 2;
+        }
+    }
+    if (maxSize < 100 || maxSize > 10000000) {
+        cerr << "--max-size must be between 100 and 10000000" << endl;
+        return 2;
+    }
+
+    vector<BenchResult> results = runBenchmarks(static_cast<int>(maxSize));
+    if (json) {
+        cout << benchResultsJson(results);
+        return 0;
+    }
+    cout << left << setw(40) << "benchmark" << right << setw(10) << "size" << setw(12) << "ops"
+        << setw(12) << "ns/op" << setw(12) << "allocs/op" << setw(12) << "bytes/op" << endl;
+    for (const BenchResult& r : results) {
+        cout << left << setw(40) << r.name << right << setw(10) << r.size << setw(12) << r.ops
+            << fixed << setprecision(1) << setw(12) << r.nsPerOp << setprecision(3) << setw(12)
+            << r.allocationsPerOp << setprecision(1) << setw(12) << r.bytesPerOp << endl;
+    }
+    return 0;
+}
+
+// runs the perf scenarios against a baseline file (the committed one
+// by default); --update rewrites it
+static int runPerfGate(int argc, char** argv) {
+    string path = PERF_BASELINE_FILE;
+    bool update = false;
+    for (int i = 2; i < argc; i++) {
+        if (string(argv[i]) == "--update") update = true;
+        else path = argv[i];
+    }
+
+    vector<PerfBaseline> baselines;
+    if (!update) {
+        string text, error;
+        if (!readWholeFile(path, text)) {
+            cerr << "Cannot read " << path << " (run with --update to record a baseline)" << endl;
+            return 2;
+        }
+        if (!parsePerfBaseline(text, baselines, error)) {
+            cerr << path << ": " << error << endl;
+            return 2;
+        }
+    }
+
+    vector<BenchResult> results = runPerfScenarios();
+    if (update) {
+        ofstream out(path, ios::binary);
+        out << perfBaselineText(results);
+        if (!out) {
+            cerr << "Cannot write " << path << endl;
+            return 1;
+        }
+        cout << "Baseline written to " << path << ":\n" << perfBaselineText(results);
+        return 0;
+    }
+
+    int failed = 0;
+    cout << left << setw(14) << "scenario" << right << setw(10) << "size" << setw(12) << "ns/op"
+        << setw(12) << "limit" << setw(12) << "allocs/op" << setw(12) << "limit" << "  result" << endl;
+    for (const PerfCheck& c : comparePerf(results, baselines)) {
+        cout << left << setw(14) << c.measured.name << right << setw(10) << c.measured.size
+            << fixed << setprecision(1) << setw(12) << c.measured.nsPerOp << setw(12) << c.nsLimit
+            << setprecision(3) << setw(12) << c.measured.allocationsPerOp << setw(12) << c.allocationLimit << "  ";
+        if (c.baseline == nullptr) cout << "NO BASELINE";
+        else if (c.passed()) cout << "ok";
+        else cout << "REGRESSED" << (c.timeOk() ? "" : " time") << (c.allocationsOk() ? "" : " allocations");
+        cout << endl;
+        if (!c.passed()) failed++;
+    }
+    cout << failed << " of " << results.size() << " scenarios failed" << endl;
+    return failed == 0 ? 0 : 1;
+}
+
+// seeded synthetic climbers as import scripts, one file per climber
+static int runGenerateMode(int argc, char** argv) {
+    if (argc < 3) {
+        cerr << "--generate needs an output directory\n";
+        return 2;
+    }
+    WorkloadProfile profile;
+    profile.climbers = argc > 3 ? atoi(argv[3]) : 10;
+    profile.activitiesPerClimber = argc > 4 ? atoi(argv[4]) : 100000;
+    profile.seed = argc > 5 ? strtoull(argv[5], nullptr, 10) : 1;
+    if (profile.climbers < 1 || profile.activitiesPerClimber < 0) {
+        cerr << "climbers must be at least 1 and activities at least 0" << endl;
+        return 2;
+    }
+
+    WorkloadResult result = writeWorkloadFiles(argv[2], profile);
+    cout << result.records << " activities for " << profile.climbers << " climbers (" << result.failures
+        << " files failed, " << result.bytes << " bytes) in " << fixed << setprecision(3) << result.seconds
+        << " s (" << setprecision(0) << (result.seconds > 0 ? result.records / result.seconds : 0.0)
+        << " activities/s)" << endl;
+    return result.failures == 0 ? 0 : 1;
+}
+
+// removes "--share <segment>" from the arguments and returns the segment
+static string takeShareOption(int& argc, char** argv) {
+    for (int i = 2; i + 1 < argc; i++) {
+        if (string(argv[i]) != "--share") continue;
+        string segment = argv[i + 1];
+        for (int j = i; j + 2 < argc; j++) argv[j] = argv[j + 2];
+        argc -= 2;
+        return segment;
+    }
+    return "";
+}
+
+int runCommandLine(int argc, char** argv) {
+    if (argc < 2) {
+        return runInteractive();
+    }
+
+    string mode = argv[1];
+    if (mode == "--benchmark") {
+        return runBenchmarkMode(argc, argv);
+    }
+    if (mode == "--generate") {
+        return runGenerateMode(argc, argv);
+    }
+    if (mode == "--perf-gate") {
+        return runPerfGate(argc, argv);
+    }
+    string shareSegment = takeShareOption(argc, argv);
+    if (mode != "--serve" && mode != "--loadgen" && mode != "--batch" && mode != "--read-shared" && mode != "--io-bench"
+        && mode != "--report-batch") {
+        cerr << "Usage: " << argv[0] << " [--serve <unix:path|tcp:port> [workers] [--share <segment>]]\n"
+            << "       " << argv[0] << " [--loadgen <unix:path|tcp:port> [clients] [requests] [depth]]\n"
+            << "       " << argv[0] << " [--batch <script|-> [--share <segment>]]\n"
+            << "       " << argv[0] << " [--read-shared <segment> [--unlink]]\n"
+            << "       " << argv[0] << " [--io-bench <command file> [depth] [chunk KB]]\n"
+            << "       " << argv[0] << " [--report-batch <directory> [members] [sync|pool|uring]]\n"
+            << "       " << argv[0] << " [--benchmark [--json] [--max-size <n>]]\n"
+            << "       " << argv[0] << " [--generate <directory> [climbers] [activities] [seed]]\n"
+            << "       " << argv[0] << " [--perf-gate [baseline file] [--update]]\n";
+        return 2;
+    }
+    if (argc < 3) {
+        cerr << mode << (mode == "--batch" ? " needs a script file\n"
+            : mode == "--read-shared" ? " needs a segment name\n"
+            : mode == "--io-bench" ? " needs a file of add-climb / add-training lines\n"
+            : mode == "--report-batch" ? " needs an output directory\n"
+            : " needs an endpoint (unix:<path> or tcp:<port>)\n");
+        return 2;
+    }
+#ifndef __linux__
+    if (!shareSegment.empty() || mode == "--read-shared") {
+        cerr << "Shared memory is only available on Linux.\n";
+        return 1;
+    }
+    if (mode == "--report-batch") {
+        cerr << "Batch reports are only available on Linux.\n";
+        return 1;
+    }
+#endif
+
+    if (mode == "--batch") {
+        string script;
+        if (!readWholeFile(argv[2], script)) {
+            cerr << "Cannot read " << argv[2] << endl;
+            return 1;
+        }
+
+        ClimbingTracker tracker;
+        string out;
+        BatchResult result{ 0, 0, 0.0 };
+#ifdef __linux__
+        try {
+            optional<SharedMirrorScope> share;
+            if (!shareSegment.empty()) share.emplace(tracker, shareSegment);
+            result = runBatchScript(script, tracker, out);
+        }
+        catch (const std::exception& ex) {
+            cerr << ex.what() << endl;
+            return 1;
+        }
+#else
+        result = runBatchScript(script, tracker, out);
+#endif
+        fwrite(out.data(), 1, out.size(), stdout);
+        fflush(stdout);
+
+        cerr << result.commands << " commands, " << result.failures << " failed in "
+            << fixed << setprecision(3) << result.seconds << " s ("
+            << setprecision(0) << (result.seconds > 0 ? result.commands / result.seconds : 0.0)
+            << " commands/s)" << endl;
+        return result.failures == 0 ? 0 : 1;
+    }
+
+#ifdef __linux__
+    try {
+        if (mode == "--read-shared") {
+            return readShared(argv[2], argc > 3 && string(argv[3]) == "--unlink");
+        }
+
+        if (mode == "--io-bench") {
+            int depth = argc > 3 ? atoi(argv[3]) : 4;
+            size_t chunk = (argc > 4 ? static_cast<size_t>(atoi(argv[4])) : 256) * 1024;
+            return runIoBenchmark(argv[2], depth, chunk > 0 ? chunk : IO_CHUNK_BYTES);
+        }
+
+        if (mode == "--report-batch") {
+            int members = argc > 3 ? atoi(argv[3]) : 100000;
+            return runReportBatch(argv[2], members > 0 ? members : 100000, argc > 4 ? argv[4] : "uring");
+        }
+
+        if (mode == "--serve") {
+            ClimbingTracker tracker;
+            tracker.setClimberName("server");
+            optional<SharedMirrorScope> share;
+            if (!shareSegment.empty()) share.emplace(tracker, shareSegment);
+            TrackerServer server(tracker, argv[2], argc > 3 ? atoi(argv[3]) : 4);
+
+            activeServer = &server;
+            signal(SIGINT, stopActiveServer);
+            signal(SIGTERM, stopActiveServer);
+            cout << "Serving on " << argv[2] << " (Ctrl+C to stop)" << endl;
+            server.run();
+            activeServer = nullptr;
+
+            cout << "Stopped with " << tracker.getActivityCount() << " activities." << endl;
+            return 0;
+        }
+
+        int clients = argc > 3 ? atoi(argv[3]) : 8;
+        int requests = argc > 4 ? atoi(argv[4]) : 10000;
+        int depth = argc > 5 ? atoi(argv[5]) : 32;
+        LoadResult result = runLoadGenerator(argv[2], clients, requests, depth);
+
+        cout << result.requests << " requests (" << result.errors << " errors) in "
+            << fixed << setprecision(3) << result.seconds << " s = "
+            << setprecision(0) << result.requests / result.seconds << " req/s" << endl;
+        return result.errors == 0 ? 0 : 1;
+    }
+    catch (const std::exception& ex) {
+        cerr << ex.what() << endl;
+        return 1;
+    }
+#else
+    cerr << "Service mode is only available on Linux.\n";
+    return 1;
+#endif
+}
 #endif